@@ -132,6 +132,26 @@ class OpKernel {
     return Status::OK();
   }
 
+  // Override this function to return true if the pre-packed weights for the given input can be restored by
+  // RestorePrePackedWeights(). Only such weights are persisted in the on-disk pre-packed weights cache
+  // (see kOrtSessionOptionsConfigPrePackedWeightsCacheDir).
+  virtual bool CanRestorePrePackedWeights(int /*input_idx*/) const {
+    return false;
+  }
+
+  // Override this function to use pre-packed buffers that a PrePack() call with a non-null PrePackedWeights produced
+  // in an earlier session, e.g. loaded from the on-disk pre-packed weights cache.
+  // Unlike UseSharedPrePackedBuffers(), PrePack() is NOT called on this kernel instance first, so the kernel must
+  // derive any other state that PrePack() would have computed from the original constant initializer.
+  // The buffers may be backed by read-only memory and must not be written to.
+  // @param tensor: The initialized constant tensor the buffers were pre-packed from
+  // @param input_idx: The input index of the tensor in this kernel
+  // @param prepacked_buffers: The pre-packed buffers, in the order PrePack() stored them in PrePackedWeights
+  virtual Status RestorePrePackedWeights(const Tensor& /*tensor*/, int /*input_idx*/,
+                                         std::vector<BufferUniquePtr>& /*prepacked_buffers*/) {
+    ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
+  }
+
   const OrtMemoryInfo& Allocator(OrtMemType mem_type) const;
   const OpKernelInfo& Info() const {
     return *op_kernel_info_;
@@ -16,6 +16,7 @@ limitations under the License.
 /* Modifications Copyright (c) Microsoft. */
 
 #pragma once
+#include <atomic>
 #include <string>
 #include <vector>
 #include <functional>
@@ -130,6 +131,23 @@ struct TensorOpCost {
 
 namespace concurrency {
 
+// The cost model that ParallelFor uses to decide whether a loop runs in parallel and how large its blocks are.
+// The costs are in cycles of the CPU. The defaults are the constants of Eigen's TensorCostModel, which assume that
+// the data of a loop is in the L2 cache of a Haswell CPU and that scheduling a block is expensive.
+// ThreadPool::CalibrateCostModel fits the coefficients of the machine and of a pool instead.
+struct ParallelForCostModel {
+  // the cost of a byte of TensorOpCost::bytes_loaded and TensorOpCost::bytes_stored
+  double load_cycles_per_byte = 11.0 / 64;
+  double store_cycles_per_byte = 11.0 / 64;
+  // the cost of a unit of TensorOpCost::compute_cycles
+  double cycles_per_compute_cycle = 1.0;
+  // the overhead of running a loop in parallel, and of every thread it uses
+  double startup_cycles = 100000;
+  double per_thread_cycles = 100000;
+  // the cost of a block that amortizes the overhead of scheduling it
+  double task_size_cycles = 40000;
+};
+
 template <typename Environment>
 class ThreadPoolTempl;
 
@@ -214,6 +232,64 @@ class ThreadPool {
     ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelSection);
   };
 
+  // Priority classes of parallel loops.  A pool shared between sessions,
+  // e.g. the global pools of an environment created with
+  // DisablePerSessionThreads, may run loops of several classes at the same
+  // time.  In that case each loop is limited to a share of the threads
+  // proportional to the weight of its class (weighted fair sharing), and the
+  // helper threads of a loop leave it once the loop
+  // exceeds its share, e.g. because a loop of a higher class started.  They
+  // check the share every few blocks rather than after every block.  The
+  // remaining iterations are then run by the other threads of the loop,
+  // which always include the thread that started it.  Loops of a single
+  // class are scheduled as before.
+  enum class LoopPriority : int {
+    kLow = 0,
+    kNormal = 1,
+    kHigh = 2,
+  };
+  static constexpr int kNumLoopPriorities = 3;
+
+  // Sets the priority class of the parallel loops started by the current
+  // thread while the object is alive.  The priority is thread-local state,
+  // like the parallel section, so that kernels need no changes.  Work that
+  // the thread passes to Schedule() runs with the same priority class, so
+  // the nodes that an executor runs on the inter-op pool keep the priority
+  // of the run.
+  class PriorityScope {
+   public:
+    explicit PriorityScope(LoopPriority priority);
+    ~PriorityScope();
+
+   private:
+    LoopPriority previous_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PriorityScope);
+  };
+
+  // Returns the priority class of the parallel loops started by the current thread.
+  static LoopPriority CurrentLoopPriority();
+
+  // Parses "low", "normal" or "high".
+  static Status ParseLoopPriority(const std::string& str, LoopPriority& priority);
+
+  // Sets the cost model of the loops of the pool. Must not be called while loops are running.
+  void SetCostModel(const ParallelForCostModel& cost_model) { cost_model_ = cost_model; }
+
+  const ParallelForCostModel& GetCostModel() const { return cost_model_; }
+
+  // Fits a cost model with microbenchmarks: the cost of a cycle is the latency of an integer addition, the load and
+  // store costs are the throughputs of reading and writing a buffer that fits in the L2 cache, the compute cost is
+  // the throughput of a float multiply-add loop, and the overheads are the latencies of empty loops in tp.
+  // The machine coefficients are measured once per process. Takes a few tens of milliseconds.
+  static ParallelForCostModel CalibrateCostModel(ThreadPool* tp);
+
+  // Parses the coefficients of a cost model written as "name=value" pairs separated by ';', e.g.
+  // "load_cycles_per_byte=0.1;startup_cycles=20000". The coefficients that are not listed keep their values.
+  static Status ParseCostModel(const std::string& str, ParallelForCostModel& cost_model);
+
+  // Writes all the coefficients of a cost model in the format of ParseCostModel.
+  static std::string CostModelToString(const ParallelForCostModel& cost_model);
+
   // The below API allows to disable spinning
   // This is used to support real-time scenarios where
   // spinning between relatively infrequent requests
@@ -378,6 +454,11 @@ class ThreadPool {
   // thread in the pool. Returns -1 otherwise.
   int CurrentThreadId() const;
 
+  // Returns the NUMA node of the calling thread as given by ThreadOptions::numa_nodes, the main thread
+  // standing for any thread that is not in the pool. Returns -1 if the threads are not partitioned
+  // between NUMA nodes.
+  int CurrentNumaNode() const;
+
   // Run fn with up to n degree-of-parallelism enlisting the thread pool for
   // help.  The degree-of-parallelism includes the caller, and so if n==1
   // then the function will run directly in the caller.  The fork-join
@@ -429,6 +510,18 @@ class ThreadPool {
 
   // Force the thread pool to run in hybrid mode on a normal cpu.
   bool force_hybrid_ = false;
+
+  // Number of NUMA nodes the threads are partitioned between, 0 if they are not partitioned.
+  int num_numa_nodes_ = 0;
+
+  // Returns the number of threads, including the caller, that a loop of the given priority
+  // may currently use.
+  unsigned FairShare(LoopPriority priority) const;
+
+  // Number of parallel loops of each priority class currently running in the pool.
+  std::atomic<int> active_loops_[kNumLoopPriorities] = {};
+
+  ParallelForCostModel cost_model_;
 };
 
 }  // namespace concurrency
@@ -581,6 +581,37 @@ typedef struct OrtOpenVINOProviderOptions {
   unsigned char enable_dynamic_shapes;     ///< 0 = disabled, nonzero = enabled
 } OrtOpenVINOProviderOptions;
 
+/** \brief Statistics of the dynamic batcher of a session
+ *
+ * \see OrtApi::SessionGetDynamicBatchingStats
+ */
+typedef struct OrtDynamicBatchingStats {
+  int64_t num_requests;         ///< Number of Run() calls that went through the batcher
+  int64_t num_batches;          ///< Number of runs of the model they were coalesced into
+  int64_t queue_depth;          ///< Number of requests currently waiting for their batch or running
+  int64_t max_queue_depth;      ///< Largest queue depth so far
+  int64_t total_queue_time_us;  ///< Sum of the times between the arrival of a request and the start of its batch
+  int64_t max_queue_time_us;    ///< Largest time between the arrival of a request and the start of its batch
+} OrtDynamicBatchingStats;
+
+/** \brief Latency statistics of a node of a session
+ *
+ * The percentiles are read from a histogram with four buckets per power of two, so they are the upper bounds of
+ * their buckets and exceed the exact percentiles by up to 25%.
+ *
+ * \see OrtApi::SessionGetNodeLatencyStats
+ */
+typedef struct OrtNodeLatencyStats {
+  const char* node_name;  ///< Name of the node, owned by the session
+  const char* op_type;    ///< Operator type of the node, owned by the session
+  uint64_t count;         ///< Number of times the kernel of the node ran
+  uint64_t total_ns;      ///< Sum of the latencies of the kernel in nanoseconds
+  uint64_t p50_ns;        ///< Median latency in nanoseconds
+  uint64_t p90_ns;        ///< 90th percentile latency in nanoseconds
+  uint64_t p99_ns;        ///< 99th percentile latency in nanoseconds
+  uint64_t max_ns;        ///< Largest latency in nanoseconds
+} OrtNodeLatencyStats;
+
 struct OrtApi;
 typedef struct OrtApi OrtApi;
 
@@ -636,6 +667,19 @@ typedef void (*OrtCustomJoinThreadFn)(OrtCustomThreadHandle ort_custom_thread_ha
 
 typedef OrtStatus*(ORT_API_CALL* RegisterCustomOpsFn)(OrtSessionOptions* options, const OrtApiBase* api);
 
+/** \brief Callback of OrtApi::RunAsync
+ *
+ * Called on the thread that ran the model once the run completed.
+ *
+ * \param[in] user_data The user_data passed to OrtApi::RunAsync
+ * \param[in] outputs The outputs array passed to OrtApi::RunAsync, filled the same way as by OrtApi::Run
+ * \param[in] num_outputs Number of elements in the outputs array
+ * \param[in] status nullptr if the run succeeded, in which case the outputs are set. Otherwise the error, which is
+ *     owned by the callback and must be freed with OrtApi::ReleaseStatus
+ */
+typedef void(ORT_API_CALL* RunAsyncCallbackFn)(void* user_data, OrtValue** outputs, size_t num_outputs,
+                                                OrtStatus* status);
+
 /** \brief The C API
  *
  * All C API functions are defined inside this structure as pointers to functions.
@@ -2686,6 +2730,9 @@ struct OrtApi {
    *  Only relevant if arena strategy is `kNextPowerOfTwo`. Use -1 to allow ORT to choose the default.
    *  Ultimately, the allocation size is determined by the allocation memory request.
    *  Further allocation sizes are governed by the arena extend strategy.
+   * "max_thread_cache_bytes": Total size of the freed blocks of up to 1MB the arena caches per thread, so that
+   *  concurrent threads rarely contend on the arena lock. The cached blocks count as in use for the arena.
+   *  Default is 0, which disables the thread caches.
    *
    * \param[in] arena_config_keys Keys to configure the arena
    * \param[in] arena_config_values Values to configure the arena
@@ -4086,6 +4133,75 @@ struct OrtApi {
    * \since Version 1.15.
    */
   ORT_API2_STATUS(KernelInfoGetConstantInput_tensor, _In_ const OrtKernelInfo* info, size_t index, _Out_ int* is_constant, _Outptr_ const OrtValue** out); 
+
+  /** \brief Get the statistics of the dynamic batcher of a session
+   *
+   * Dynamic batching is enabled with the "session.dynamic_batching_max_batch_size" session configuration entry.
+   * The mean batch size is num_requests / num_batches and the mean queueing latency is
+   * total_queue_time_us / num_requests. All the statistics are 0 if dynamic batching is disabled.
+   *
+   * \param[in] session
+   * \param[out] out The statistics.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.15.
+   */
+  ORT_API2_STATUS(SessionGetDynamicBatchingStats, _In_ const OrtSession* session, _Out_ OrtDynamicBatchingStats* out);
+
+  /** \brief Run the model in an ::OrtSession asynchronously
+   *
+   * Schedules the run on the inter op thread pool of the session, or on its intra op thread pool if the session
+   * doesn't run in parallel mode, and returns immediately. run_async_callback is called with the outputs and the
+   * status of the run once it completed, so a few threads can have many runs in flight.
+   * The session must have a thread pool with at least one thread, i.e. an intra op thread count other than 1, or
+   * the global thread pools. Releasing the session waits for the runs in flight to complete.
+   * run_async_callback may release the session, as the run no longer uses it when the callback is called. The session
+   * must then have no other run in flight, as releasing it from the callback would wait for those runs on a thread
+   * they may need.
+   *
+   * \param[in] session
+   * \param[in] run_options If nullptr, will use a default ::OrtRunOptions. Must remain valid until the callback
+   *     is called, so that the run can be terminated with OrtApi::RunOptionsSetTerminate.
+   * \param[in] input_names Array of null terminated UTF8 encoded strings of the input names
+   * \param[in] input Array of ::OrtValue%s of the input values
+   * \param[in] input_len Number of elements in the input_names and inputs arrays
+   * \param[in] output_names Array of null terminated UTF8 encoded strings of the output names
+   * \param[in] output_names_len Number of elements in the output_names and outputs array
+   * \param[out] output Array of ::OrtValue%s that the outputs are stored in, as in OrtApi::Run. Must remain valid
+   *     until the callback is called, which receives it.
+   * \param[in] run_async_callback Called once the run completed, unless this function returns an error.
+   * \param[in] user_data Passed to run_async_callback.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.15.
+   */
+  ORT_API2_STATUS(RunAsync, _Inout_ OrtSession* session, _In_opt_ const OrtRunOptions* run_options,
+                  _In_reads_(input_len) const char* const* input_names,
+                  _In_reads_(input_len) const OrtValue* const* input, size_t input_len,
+                  _In_reads_(output_names_len) const char* const* output_names, size_t output_names_len,
+                  _Inout_updates_all_(output_names_len) OrtValue** output,
+                  _In_ RunAsyncCallbackFn run_async_callback, _In_opt_ void* user_data);
+
+  /** \brief Get the latency statistics of the nodes of the main graph of an ::OrtSession
+   *
+   * The session keeps a latency histogram of every node unless the "session.node_latency_histograms_enable" session
+   * configuration entry is "0". The histograms cover all the runs since the session was created, and reading them
+   * doesn't block the runs in progress.
+   *
+   * \param[in] session
+   * \param[in] allocator Allocates the array of statistics. Free it with the same allocator.
+   * \param[out] out Array of the statistics of the nodes that ran at least once, in topological order.
+   *     nullptr if no node ran or the histograms are disabled.
+   * \param[out] num_nodes Number of elements in the array.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.15.
+   */
+  ORT_API2_STATUS(SessionGetNodeLatencyStats, _In_ const OrtSession* session, _Inout_ OrtAllocator* allocator,
+                  _Outptr_result_buffer_maybenull_(*num_nodes) OrtNodeLatencyStats** out, _Out_ size_t* num_nodes);
 };
 
 /*
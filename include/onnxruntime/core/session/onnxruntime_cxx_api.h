@@ -733,6 +733,8 @@ struct ConstSessionImpl : Base<T> {
   AllocatedStringPtr GetOverridableInitializerNameAllocated(size_t index, OrtAllocator* allocator) const;  ///< Wraps OrtApi::SessionGetOverridableInitializerName
 
   uint64_t GetProfilingStartTimeNs() const;  ///< Wraps OrtApi::SessionGetProfilingStartTimeNs
+  OrtDynamicBatchingStats GetDynamicBatchingStats() const;  ///< Wraps OrtApi::SessionGetDynamicBatchingStats
+  std::vector<OrtNodeLatencyStats> GetNodeLatencyStats() const;  ///< Wraps OrtApi::SessionGetNodeLatencyStats
   ModelMetadata GetModelMetadata() const;    ///< Wraps OrtApi::SessionGetModelMetadata
 
   TypeInfo GetInputTypeInfo(size_t index) const;                   ///< Wraps OrtApi::SessionGetInputTypeInfo
@@ -773,6 +775,15 @@ struct SessionImpl : ConstSessionImpl<T> {
 
   void Run(const RunOptions& run_options, const IoBinding&);  ///< Wraps OrtApi::RunWithBinding
 
+  /** \brief Run the model asynchronously, see OrtApi::RunAsync
+   *
+   * The names and the inputs can be released once RunAsync returns. output_values and run_options must remain
+   * valid until callback is called, which receives the OrtValue pointers of output_values.
+   */
+  void RunAsync(const RunOptions& run_options, const char* const* input_names, const Value* input_values,
+                size_t input_count, const char* const* output_names, Value* output_values, size_t output_count,
+                RunAsyncCallbackFn callback, void* user_data);  ///< Wraps OrtApi::RunAsync
+
   /** \brief End profiling and return a copy of the profiling file name.
    *
    * \param allocator to allocate memory for the copy of the string returned
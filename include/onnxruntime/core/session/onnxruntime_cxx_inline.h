@@ -861,6 +861,26 @@ inline uint64_t ConstSessionImpl<T>::GetProfilingStartTimeNs() const {
   return out;
 }
 
+template <typename T>
+inline OrtDynamicBatchingStats ConstSessionImpl<T>::GetDynamicBatchingStats() const {
+  OrtDynamicBatchingStats out;
+  ThrowOnError(GetApi().SessionGetDynamicBatchingStats(this->p_, &out));
+  return out;
+}
+
+template <typename T>
+inline std::vector<OrtNodeLatencyStats> ConstSessionImpl<T>::GetNodeLatencyStats() const {
+  AllocatorWithDefaultOptions allocator;
+  OrtNodeLatencyStats* stats = nullptr;
+  size_t num_nodes = 0;
+  ThrowOnError(GetApi().SessionGetNodeLatencyStats(this->p_, allocator, &stats, &num_nodes));
+  std::vector<OrtNodeLatencyStats> out(stats, stats + num_nodes);
+  if (stats != nullptr) {
+    allocator.Free(stats);
+  }
+  return out;
+}
+
 template <typename T>
 inline ModelMetadata ConstSessionImpl<T>::GetModelMetadata() const {
   OrtModelMetadata* out;
@@ -909,6 +929,18 @@ inline void SessionImpl<T>::Run(const RunOptions& run_options, const char* const
   ThrowOnError(GetApi().Run(this->p_, run_options, input_names, ort_input_values, input_count, output_names, output_count, ort_output_values));
 }
 
+template <typename T>
+inline void SessionImpl<T>::RunAsync(const RunOptions& run_options, const char* const* input_names,
+                                     const Value* input_values, size_t input_count, const char* const* output_names,
+                                     Value* output_values, size_t output_count, RunAsyncCallbackFn callback,
+                                     void* user_data) {
+  static_assert(sizeof(Value) == sizeof(OrtValue*), "Value is really just an array of OrtValue* in memory, so we can reinterpret_cast safely");
+  auto ort_input_values = reinterpret_cast<const OrtValue* const*>(input_values);
+  auto ort_output_values = reinterpret_cast<OrtValue**>(output_values);
+  ThrowOnError(GetApi().RunAsync(this->p_, run_options, input_names, ort_input_values, input_count, output_names,
+                                 output_count, ort_output_values, callback, user_data));
+}
+
 template <typename T>
 inline void SessionImpl<T>::Run(const RunOptions& run_options, const IoBinding& io_binding) {
   ThrowOnError(GetApi().RunWithBinding(this->p_, run_options, io_binding));
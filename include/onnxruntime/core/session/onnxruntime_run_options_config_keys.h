@@ -30,3 +30,7 @@ static const char* const kOrtRunOptionsConfigEnableMemoryArenaShrinkage = "memor
 // Per default it will be set to '0'
 // Taking CUDA EP as an example, it omit triggering cudaStreamSynchronize on the compute stream.
 static const char* const kOrtRunOptionsConfigDisableSynchronizeExecutionProviders = "disable_synchronize_execution_providers";
+
+// Priority class of the parallel loops of this run in the intra op thread pool: "low", "normal" or "high".
+// Overrides the session option "session.thread_pool_priority" for this run.
+static const char* const kOrtRunOptionsConfigThreadPoolPriority = "run.thread_pool_priority";
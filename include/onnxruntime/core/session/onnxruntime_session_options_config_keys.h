@@ -159,6 +159,18 @@ static const char* const kOrtSessionOptionsConfigDynamicBlockBase = "session.dyn
 // Applies only to internal thread-pools
 static const char* const kOrtSessionOptionsConfigForceSpinningStop = "session.force_spinning_stop";
 
+// Priority class of the parallel loops run by the session in the intra op thread pool.
+// Matters when the pool is shared with other sessions, i.e. with the global thread pools of an environment created
+// with DisablePerSessionThreads: when loops of several classes run at the same time, each loop gets a share of the
+// threads weighted by its class (low: 1, normal: 4, high: 16), and helper threads leave a loop once it exceeds its
+// share, e.g. when a loop of a latency critical session starts while a batch scoring session is running.
+// Can be overridden for a single run with the run option "run.thread_pool_priority".
+// Option values:
+// - "low"
+// - "normal" [DEFAULT]
+// - "high"
+static const char* const kOrtSessionOptionsConfigThreadPoolPriority = "session.thread_pool_priority";
+
 // "1": all inconsistencies encountered during shape and type inference
 // will result in failures.
 // "0": in some cases warnings will be logged but processing will continue. The default.
@@ -168,6 +180,16 @@ static const char* const kOrtSessionOptionsConfigStrictShapeTypeInference = "ses
 // The file saves configuration for partitioning node among logic streams
 static const char* const kNodePartitionConfigFile = "session.node_partition_config_file";
 
+// Enables the dataflow executor when the session runs in parallel execution mode (ExecutionMode::ORT_PARALLEL).
+// The stream based executor runs the nodes of a logic stream in order, and a graph placed on a single device forms a
+// single logic stream, so parallel execution mode doesn't overlap the independent branches of a CPU only graph.
+// The dataflow executor schedules each node onto the inter-op thread pool as soon as its inputs are available.
+// It is only used for the main graph, and only if the execution plan has a single logic stream.
+// Option values:
+// - "0": run the logic streams with the stream based executor. [DEFAULT]
+// - "1": run the nodes in dataflow order.
+static const char* const kOrtSessionOptionsConfigUseDataflowExecutor = "session.use_dataflow_executor";
+
 // This Option allows setting affinities for intra op threads.
 // Affinity string follows format:
 // logical_processor_id,logical_processor_id;logical_processor_id,logical_processor_id
@@ -184,3 +206,128 @@ static const char* const kNodePartitionConfigFile = "session.node_partition_conf
 //    an id of 64 will be inferred as the last processor of the 1st group, while 65 will be interpreted as the 1st processor of the second group.
 //    Hence 64-65 is an invalid configuration, because a windows thread cannot be attached to processors across group boundary.
 static const char* const kOrtSessionOptionsConfigIntraOpThreadAffinities = "session.intra_op_thread_affinities";
+
+// Makes the intra op thread pool NUMA aware: the threads are spread evenly over the NUMA nodes the process can run on,
+// each thread is bound to the logical processors of its node, and parallel loops give the threads of a node the same
+// part of the iteration space in every loop. Memory is placed on the node of the thread that first touches it, so
+// activations written by a parallel loop stay local to the node processing them in the following loops.
+// Ignored if "session.intra_op_thread_affinities" is set, or if the process runs on a single NUMA node.
+// Currently only supported on Linux.
+// Option values:
+// - "0": disabled. [DEFAULT]
+// - "1": enabled.
+static const char* const kOrtSessionOptionsConfigIntraOpNumaAware = "session.intra_op_numa_aware";
+
+// Key for backing CPU initializers that have external data with read-only memory mapped pages.
+// By default external data for CPU initializers is mapped copy-on-write, so a kernel that writes into an initializer
+// gets a private copy of the page. If set to "1", the mapping is read-only instead: the pages are guaranteed to stay
+// backed by the OS page cache and are shared by every session and process that loads the same external data file.
+// Kernels must not write to initializers when this is enabled.
+// Initializers whose mapped data is not suitably aligned for their element type are still copied.
+// Option values:
+// - "0": copy-on-write mapping. [DEFAULT]
+// - "1": read-only mapping.
+static const char* const kOrtSessionOptionsConfigMapExternalInitializersReadOnly =
+    "session.map_external_initializers_read_only";
+
+// Specifies a directory in which pre-packed weights are persisted across sessions and process restarts.
+// When set, the pre-packed weights of CPU kernels that support it (e.g. MatMul and Gemm with a constant B) are
+// written to this directory the first time they are computed, and later sessions memory map them instead of calling
+// PrePack() again. Entries are keyed by a hash of the initializer data, the consuming node and the CPU features,
+// so a cache directory can safely be shared between models, and between machines with different CPUs.
+// The directory is created if it does not exist. Not used for initializers shared via a PrepackedWeightsContainer.
+// Default is "" (disabled).
+static const char* const kOrtSessionOptionsConfigPrePackedWeightsCacheDir = "session.prepacked_weights_cache_dir";
+
+// Shares the memory pattern between all the input shapes of a bucket, where every input dimension is rounded up to the
+// next power of two, e.g. all sequence lengths from 65 to 128 share a bucket.
+// By default a memory pattern is only reused for exactly the same input shapes, so a model fed with variable
+// sequence lengths allocates most of its activations individually. With buckets, the blocks of the pattern fit the
+// largest tensors seen so far in the bucket, and a run with larger tensors makes the next run of the bucket trace a
+// pattern that fits them as well, so a bucket quickly gets a single allocation per location and Run().
+// Requires the memory pattern optimization to be enabled.
+// Option values:
+// - "0": disabled. [DEFAULT]
+// - "1": enabled.
+static const char* const kOrtSessionOptionsConfigMemoryPatternShapeBuckets = "session.memory_pattern_shape_buckets";
+
+// The maximum number of memory patterns cached by a session, one per input shape or shape bucket.
+// When the cache is full the least recently used pattern is evicted.
+// Default is "0" (unlimited).
+static const char* const kOrtSessionOptionsConfigMemoryPatternCacheSize = "session.memory_pattern_cache_size";
+
+// Allocates the intermediate tensors of a Run() from an arena owned by the run instead of the shared CPU allocator.
+// The arena hands out memory by bumping an offset in large chunks, and returns the chunks in bulk once the run
+// completed, so concurrent Run() calls don't contend on the lock of the shared arena for every tensor. Graph outputs
+// are still allocated from the shared allocator. The chunk size adapts to the peak memory usage of previous runs.
+// As memory is mostly reclaimed at the end of the run, the peak memory usage of a run can be higher than with the
+// shared arena, which reuses the memory of a tensor as soon as it is released.
+// Option values:
+// - "0": disabled. [DEFAULT]
+// - "1": enabled.
+static const char* const kOrtSessionOptionsConfigUsePerRunArena = "session.use_per_run_arena";
+
+// Enables TunableOp for the CPU execution provider.
+// The CPU kernels that have several implementations of their computation (e.g. the float MatMul, with different
+// ways of partitioning the GEMMs over the intra op thread pool) time all of them the first time they run with a
+// given shape, and use the fastest one from then on. The results are part of the tuning results of the session,
+// so they can be saved to and loaded from the model metadata like the tuning results of the GPU providers and a
+// process that loads them starts already tuned. Tuning results are only loaded on a CPU with the same features.
+// Option values:
+// - "0": disabled. [DEFAULT]
+// - "1": enabled.
+static const char* const kOrtSessionOptionsConfigCpuTunableOpEnable = "session.cpu_tunable_op_enable";
+
+// Enables dynamic batching: concurrent Run() calls with compatible inputs are coalesced into a single run of the
+// model along the first dimension of every input, which is treated as the batch axis.
+// A request waits for up to "session.dynamic_batching_max_delay_us" microseconds for other requests to join its
+// batch, or until the batch holds this many rows. The outputs of the batched run are split back into one slice per
+// request without being copied. The run options of the first request of a batch apply to the whole batch.
+// Only the requests whose inputs are CPU tensors and whose outputs are not pre-allocated are batched, the others run
+// as usual. Only enable it for models that compute every output row from the same row of the inputs.
+// The queue depth and the queueing latency of the batcher are available with SessionGetDynamicBatchingStats().
+// Default is "0" (disabled).
+static const char* const kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize =
+    "session.dynamic_batching_max_batch_size";
+
+// The maximum time in microseconds a request waits for other requests to join its batch.
+// Default is "1000".
+static const char* const kOrtSessionOptionsConfigDynamicBatchingMaxDelayUs = "session.dynamic_batching_max_delay_us";
+
+// Enables the capture and replay of the CPU graph, for models with static input shapes whose nodes are all assigned
+// to the CPU execution provider and which have no control flow nodes.
+// The second Run() with the same input names, types and shapes captures the execution frame of the run and the
+// sequence of its kernels, and the following runs with these inputs replay them: the inputs are copied into the
+// captured input tensors and the kernels are computed in order into the tensors allocated by the capture. This skips
+// most of the per-run work of the framework, which matters for small models. Runs with other inputs, and runs
+// concurrent with a replay, run as usual.
+// The intermediate tensors of the captured graph stay allocated while the session is alive.
+// Option values:
+// - "0": disabled. [DEFAULT]
+// - "1": enabled.
+static const char* const kOrtSessionOptionsConfigCpuGraphCaptureEnable = "session.cpu_graph_capture_enable";
+
+// Maintains a latency histogram for every node of the main graph, which SessionGetNodeLatencyStats() reads.
+// Recording the latency of a kernel costs two clock reads and a few relaxed atomic increments, unlike the profiler
+// which records every event, so the histograms can stay enabled in production to detect regressing operators.
+// The counters take about 1 KB of memory per node in each of up to 4 thread shards, i.e. up to about 3.7 KB per node
+// or 37 MB for a graph of 10000 nodes. Disable the histograms to save that memory for very large graphs.
+// Option values:
+// - "0": disabled.
+// - "1": enabled. [DEFAULT]
+static const char* const kOrtSessionOptionsConfigNodeLatencyHistogramsEnable =
+    "session.node_latency_histograms_enable";
+
+// The cost model that the parallel loops of the intra op thread pool of the session use to decide whether to run in
+// parallel and how large their blocks are. It only applies to the thread pool the session creates, not to the global
+// thread pools or to an external thread pool.
+// Option values:
+// - "": the constants of Eigen's TensorCostModel. [DEFAULT]
+// - "calibrate": fits the coefficients of the machine and of the thread pool with microbenchmarks when the session is
+//   created, which takes a few tens of milliseconds. The fitted coefficients are logged with the INFO severity, so
+//   they can be given back with the format below to skip the calibration.
+// - "name=value" pairs separated by ';', e.g. "load_cycles_per_byte=0.1;startup_cycles=20000", with the names
+//   load_cycles_per_byte, store_cycles_per_byte, cycles_per_compute_cycle, startup_cycles, per_thread_cycles and
+//   task_size_cycles. The coefficients that are not listed keep their default values.
+static const char* const kOrtSessionOptionsConfigIntraOpParallelForCostModel =
+    "session.intra_op_parallel_for_cost_model";
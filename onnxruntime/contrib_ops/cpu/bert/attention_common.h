@@ -98,6 +98,15 @@ constexpr const char* kDisableMemoryEfficientAttention = "ORT_DISABLE_MEMORY_EFF
 // Minimum sequence length to enable memory efficient attention in FP32.
 constexpr int kMinSequenceLengthForMemoryEfficientAttentionFp32 = 256;
 
+// Environment variable to enable or disable the tiled (flash) attention kernel on CPU. Default is 0 (enabled).
+constexpr const char* kDisableCpuFlashAttention = "ORT_DISABLE_CPU_FLASH_ATTENTION";
+
+// Environment variable to set the minimum total sequence length to use the tiled (flash) attention kernel on CPU.
+constexpr const char* kMinSequenceLengthForCpuFlashAttention = "ORT_MIN_SEQ_LEN_CPU_FLASH_ATTENTION";
+
+// Default minimum total sequence length to use the tiled (flash) attention kernel on CPU.
+constexpr int kDefaultMinSequenceLengthForCpuFlashAttention = 1024;
+
 }  // namespace attention
 
 }  // namespace contrib
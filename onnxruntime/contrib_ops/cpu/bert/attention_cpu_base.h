@@ -6,9 +6,13 @@
 #include "attention_base.h"
 #include "attention_helper.h"
 
+#include <limits>
+#include <type_traits>
+
 #include "core/common/common.h"
 #include "core/common/safeint.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/env_var_utils.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -16,7 +20,11 @@ namespace contrib {
 class AttentionCPUBase : public AttentionBase {
  protected:
   AttentionCPUBase(const OpKernelInfo& info, bool require_same_hidden_size)
-  : AttentionBase(info, require_same_hidden_size) {}
+      : AttentionBase(info, require_same_hidden_size) {
+    disable_flash_attention_ = ParseEnvironmentVariableWithDefault<bool>(attention::kDisableCpuFlashAttention, false);
+    min_sequence_length_for_flash_attention_ = ParseEnvironmentVariableWithDefault<int>(
+        attention::kMinSequenceLengthForCpuFlashAttention, attention::kDefaultMinSequenceLengthForCpuFlashAttention);
+  }
 
   template <typename T>
   Status ApplyAttention(const T* Q,                           // Q data with shape BxNxSxH
@@ -45,13 +53,39 @@ class AttentionCPUBase : public AttentionBase {
     // Total sequence length including that of past state: T = P + L
     const int total_sequence_length = past_sequence_length + kv_sequence_length;
 
+    const T* past_data = past != nullptr ? past->Data<T>() : nullptr;
+    T* present_data = present != nullptr ? present->MutableData<T>() : nullptr;
+
+    bool has_unidirectional = (is_unidirectional_ && sequence_length > 1);
+
+    // The tiled kernel supports masks that only depend on the key position, which are applied as a bias of BxT.
+    if constexpr (std::is_same<T, float>::value) {
+      const bool is_key_mask = mask_index == nullptr ||
+                               mask_index->Shape().NumDimensions() == 1 ||
+                               mask_index->Shape().NumDimensions() == 2;
+      if (!disable_flash_attention_ && is_key_mask && relative_position_bias == nullptr &&
+          total_sequence_length >= min_sequence_length_for_flash_attention_) {
+        void* key_mask_bias = nullptr;
+        if (mask_index != nullptr) {
+          key_mask_bias = allocator->Alloc(SafeInt<size_t>(batch_size) * total_sequence_length * sizeof(T));
+          PrepareKeyMaskBias(mask_index->Data<int32_t>(), mask_index->Shape().GetDims(), static_cast<T*>(key_mask_bias),
+                             batch_size, total_sequence_length, mask_filter_value_);
+        }
+        BufferUniquePtr key_mask_bias_buffer(key_mask_bias, BufferDeleter(allocator));
+
+        ComputeFlashAttention(output->MutableData<T>(), Q, K, V, static_cast<const T*>(key_mask_bias),
+                              has_unidirectional, batch_size, sequence_length, past_sequence_length,
+                              qk_head_size == 0 ? v_head_size : qk_head_size, v_head_size, v_hidden_size,
+                              past_data, present_data, allocator, tp);
+        return Status::OK();
+      }
+    }
+
     // Compute the attention score.
     size_t bytes = SafeInt<size_t>(batch_size) * num_heads_ * sequence_length * total_sequence_length * sizeof(T);
     auto attention_probs = allocator->Alloc(bytes);
     BufferUniquePtr scratch_buffer(attention_probs, BufferDeleter(allocator));
 
-    bool has_unidirectional = (is_unidirectional_ && sequence_length > 1);
-
     void* mask_data = nullptr;
     if (mask_index != nullptr || has_unidirectional) {
       size_t mask_data_bytes = SafeInt<size_t>(batch_size) * sequence_length * total_sequence_length * sizeof(T);
@@ -64,9 +98,6 @@ class AttentionCPUBase : public AttentionBase {
     gsl::span<const int64_t> mask_index_dims = mask_index != nullptr
                                                    ? mask_index->Shape().GetDims()
                                                    : gsl::span<const int64_t>{};
-    const T* past_data = past != nullptr ? past->Data<T>() : nullptr;
-    T* present_data = present != nullptr ? present->MutableData<T>() : nullptr;
-
     const T* relative_position_bias_data = nullptr;
     if (relative_position_bias != nullptr) {
       relative_position_bias_data = relative_position_bias->Data<T>();
@@ -93,6 +124,203 @@ class AttentionCPUBase : public AttentionBase {
   }
 
  private:
+  // Number of query rows and key columns of the tiles in the tiled (flash) attention kernel.
+  static constexpr int kFlashAttentionQueryTile = 64;
+  static constexpr int kFlashAttentionKeyTile = 256;
+
+  // exp() of an argument below this value underflows to 0 in float.
+  static constexpr float kFlashAttentionMinExpArgument = -104.0f;
+
+  // Tiled attention with an online softmax (as in FlashAttention). It computes the same result as
+  // ComputeAttentionProbs followed by ComputeVxAttentionScore:
+  //  output(B, S, N, H_v) = Softmax(1/sqrt(H) x Q x K' + mask) x V
+  // For each tile of query rows, the tiles of keys are visited in order. The running maximum and sum of the
+  // softmax of each row are updated per tile, and the partial output is rescaled whenever the maximum grows.
+  // The BxNxSxT attention probabilities and BxSxT mask are never materialized: the scratch memory is the BxT
+  // mask bias plus a fixed size per task.
+  void ComputeFlashAttention(float* output,                // output with shape BxSxNxH_v
+                             const float* Q,               // Q data with shape BxNxSxH
+                             const float* K,               // K data with shape BxNxLxH
+                             const float* V,               // V data with shape BxNxLxH_v
+                             const float* key_mask_bias,   // mask bias with shape BxT. nullptr if no mask.
+                             bool has_unidirectional,      // has unidirectional mask
+                             int batch_size,               // batch size (B)
+                             int sequence_length,          // sequence length (S == L)
+                             int past_sequence_length,     // sequence length of past state (P)
+                             int qk_head_size,             // head size of Q or K (H)
+                             int v_head_size,              // head size of V (H_v)
+                             int v_hidden_size,            // hidden size of V (D_v)
+                             const float* past,            // past state
+                             float* present,               // present state
+                             AllocatorPtr allocator,       // allocator for the scratch buffers
+                             ThreadPool* tp) const {
+    const int total_sequence_length = past_sequence_length + sequence_length;  // T = P + L
+    const ptrdiff_t loop_len = SafeInt<ptrdiff_t>(batch_size) * num_heads_;
+
+    // Keys and values of one head are read by the tasks of every query tile, so the past and current states are
+    // concatenated into present first.
+    const float* k_data = K;
+    const float* v_data = V;
+    ptrdiff_t k_chunk_length = SafeInt<ptrdiff_t>(sequence_length) * qk_head_size;  // L x H
+    ptrdiff_t v_chunk_length = SafeInt<ptrdiff_t>(sequence_length) * v_head_size;   // L x H_v
+    if (nullptr != present) {
+      const size_t past_k_chunk_length = static_cast<size_t>(past_sequence_length) * qk_head_size;     // P x H
+      const size_t present_k_chunk_length = static_cast<size_t>(total_sequence_length) * qk_head_size;  // T x H
+      const size_t past_v_chunk_length = static_cast<size_t>(past_sequence_length) * v_head_size;      // P x H_v
+      const size_t present_v_chunk_length = static_cast<size_t>(total_sequence_length) * v_head_size;   // T x H_v
+      const float* past_v = past != nullptr ? past + loop_len * past_v_chunk_length : nullptr;
+      float* present_v = present + loop_len * present_k_chunk_length;
+
+      const double concat_cost = static_cast<double>(present_k_chunk_length + present_v_chunk_length);
+      ThreadPool::TryParallelFor(tp, loop_len, concat_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          ConcatStateChunk(past, K + k_chunk_length * i, present, past_k_chunk_length, present_k_chunk_length, i);
+          ConcatStateChunk(past_v, V + v_chunk_length * i, present_v, past_v_chunk_length, present_v_chunk_length, i);
+        }
+      });
+
+      k_data = present;
+      v_data = present_v;
+      k_chunk_length = static_cast<ptrdiff_t>(present_k_chunk_length);
+      v_chunk_length = static_cast<ptrdiff_t>(present_v_chunk_length);
+    }
+
+    const int query_tiles = (sequence_length + kFlashAttentionQueryTile - 1) / kFlashAttentionQueryTile;
+    const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(qk_head_size)) : scale_;
+    const float mask_filter_value = mask_filter_value_;
+
+    // The cost of the two Gemms of a query tile
+    const double cost = static_cast<double>(kFlashAttentionQueryTile) * total_sequence_length *
+                        (static_cast<double>(qk_head_size) + v_head_size);
+
+    ThreadPool::TryParallelFor(tp, loop_len * query_tiles, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      // scores: query tile x key tile, out: query tile x H_v, row max and row sum: query tile
+      const size_t scratch_length = static_cast<size_t>(kFlashAttentionQueryTile) * kFlashAttentionKeyTile +
+                                    static_cast<size_t>(kFlashAttentionQueryTile) * v_head_size +
+                                    2 * static_cast<size_t>(kFlashAttentionQueryTile);
+      auto scratch = IAllocator::MakeUniquePtr<float>(allocator, scratch_length);
+      float* scores = scratch.get();
+      float* out = scores + static_cast<size_t>(kFlashAttentionQueryTile) * kFlashAttentionKeyTile;
+      float* row_max = out + static_cast<size_t>(kFlashAttentionQueryTile) * v_head_size;
+      float* row_sum = row_max + kFlashAttentionQueryTile;
+
+      for (std::ptrdiff_t i = begin; i != end; ++i) {
+        const std::ptrdiff_t head_i = i / query_tiles;  // index in B x N
+        const int batch_index = static_cast<int>(head_i / num_heads_);
+        const int head_index = static_cast<int>(head_i % num_heads_);
+        const int q_start = static_cast<int>(i % query_tiles) * kFlashAttentionQueryTile;
+        const int q_count = std::min(kFlashAttentionQueryTile, sequence_length - q_start);
+
+        const float* q = Q + (SafeInt<ptrdiff_t>(head_i) * sequence_length + q_start) * qk_head_size;
+        const float* k = k_data + k_chunk_length * head_i;
+        const float* v = v_data + v_chunk_length * head_i;
+        const float* mask_bias = key_mask_bias != nullptr
+                                     ? key_mask_bias + SafeInt<ptrdiff_t>(batch_index) * total_sequence_length
+                                     : nullptr;
+
+        std::fill_n(row_max, q_count, std::numeric_limits<float>::lowest());
+        std::fill_n(row_sum, q_count, 0.0f);
+        std::fill_n(out, static_cast<size_t>(q_count) * v_head_size, 0.0f);
+
+        // With the unidirectional mask, row r can only attend to the keys before P + q_start + r + 1.
+        const int visible_end = has_unidirectional ? std::min(total_sequence_length, past_sequence_length + q_start + q_count)
+                                                   : total_sequence_length;
+
+        // Like ComputeAttentionProbs, the score of a key hidden by the unidirectional mask is the mask value.
+        const auto masked_score = [&](int m_i) {
+          return (mask_bias != nullptr ? mask_bias[m_i] : 0.0f) + mask_filter_value;
+        };
+
+        for (int kv_start = 0; kv_start < total_sequence_length; kv_start += kFlashAttentionKeyTile) {
+          const int kv_count = std::min(kFlashAttentionKeyTile, total_sequence_length - kv_start);
+
+          if (kv_start >= visible_end) {
+            // Every key of the tile is hidden from every row. The tile is skipped when its weights underflow.
+            float tile_max = std::numeric_limits<float>::lowest();
+            for (int c = 0; c < kv_count; c++) {
+              tile_max = std::max(tile_max, masked_score(kv_start + c));
+            }
+            bool is_negligible = true;
+            for (int r = 0; r < q_count; r++) {
+              is_negligible = is_negligible && (tile_max - row_max[r] < kFlashAttentionMinExpArgument);
+            }
+            if (is_negligible) {
+              continue;
+            }
+            for (int r = 0; r < q_count; r++) {
+              for (int c = 0; c < kv_count; c++) {
+                scores[r * kv_count + c] = masked_score(kv_start + c);
+              }
+            }
+          } else {
+            // scores = alpha x Q_tile x K_tile' + mask
+            math::Gemm<float, ThreadPool>(CblasNoTrans, CblasTrans, q_count, kv_count, qk_head_size, alpha,
+                                          q, k + static_cast<ptrdiff_t>(kv_start) * qk_head_size, 0.0f,
+                                          scores, nullptr);
+            if (mask_bias != nullptr) {
+              for (int r = 0; r < q_count; r++) {
+                for (int c = 0; c < kv_count; c++) {
+                  scores[r * kv_count + c] += mask_bias[kv_start + c];
+                }
+              }
+            }
+            if (has_unidirectional) {
+              for (int r = 0; r < q_count; r++) {
+                for (int c = std::max(0, past_sequence_length + q_start + r + 1 - kv_start); c < kv_count; c++) {
+                  scores[r * kv_count + c] = masked_score(kv_start + c);
+                }
+              }
+            }
+          }
+
+          // Online softmax: rescale the sum and output of each row to the new maximum, then accumulate the tile.
+          for (int r = 0; r < q_count; r++) {
+            float* row_scores = scores + r * kv_count;
+            float new_max = row_max[r];
+            for (int c = 0; c < kv_count; c++) {
+              new_max = std::max(new_max, row_scores[c]);
+            }
+            for (int c = 0; c < kv_count; c++) {
+              row_scores[c] -= new_max;
+            }
+            MlasComputeExp(row_scores, row_scores, static_cast<size_t>(kv_count));
+
+            float tile_sum = 0.0f;
+            for (int c = 0; c < kv_count; c++) {
+              tile_sum += row_scores[c];
+            }
+
+            const float correction = expf(row_max[r] - new_max);
+            if (correction != 1.0f) {
+              float* row_out = out + static_cast<ptrdiff_t>(r) * v_head_size;
+              for (int h = 0; h < v_head_size; h++) {
+                row_out[h] *= correction;
+              }
+            }
+            row_sum[r] = row_sum[r] * correction + tile_sum;
+            row_max[r] = new_max;
+          }
+
+          // out += exp(scores) x V_tile
+          math::Gemm<float, ThreadPool>(CblasNoTrans, CblasNoTrans, q_count, v_head_size, kv_count, 1.0f,
+                                        scores, v + static_cast<ptrdiff_t>(kv_start) * v_head_size, 1.0f,
+                                        out, nullptr);
+        }
+
+        // Normalize and transpose: out(B, N, S, H_v) -> output(B, S, N, H_v)
+        for (int r = 0; r < q_count; r++) {
+          const float inv_sum = 1.0f / row_sum[r];
+          const float* src = out + static_cast<ptrdiff_t>(r) * v_head_size;
+          float* dest = output + (SafeInt<ptrdiff_t>(batch_index) * sequence_length + q_start + r) * v_hidden_size +
+                        static_cast<ptrdiff_t>(head_index) * v_head_size;
+          for (int h = 0; h < v_head_size; h++) {
+            dest[h] = src[h] * inv_sum;
+          }
+        }
+      }
+    });
+  }
+
   // Helper function to compute the attention probs. It does 2 things:
   //  attention_probs(B, N, S, T) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, T, H -> B, N, H, T) +
   //                                1 x mask_data(B, N, S, T)
@@ -251,6 +479,9 @@ class AttentionCPUBase : public AttentionBase {
       }
     });
   }
+
+  bool disable_flash_attention_;                  // whether the tiled (flash) attention kernel is disabled
+  int min_sequence_length_for_flash_attention_;  // minimum total sequence length to use the tiled kernel
 };
 
 }  // namespace contrib
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//
+// This module defines the MatMulFpQ4 operator: a float32 MatMul whose right
+// hand side is a 2-D matrix pre-packed into blocks of int4 values by
+// MlasQ4GemmPackB.
+//
+
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas_q4.h"
+#include "core/providers/cpu/math/matmul_helper.h"
+#include "core/providers/common.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+class MatMulFpQ4 final : public OpKernel {
+ public:
+  MatMulFpQ4(const OpKernelInfo& info) : OpKernel(info) {
+    const auto t = info.GetAttrOrDefault<int64_t>("blk_quant_type", static_cast<int64_t>(BlkQ4Zp8));
+    ORT_ENFORCE(t >= BlkQ4Sym && t <= BlkQ4Sym128, "MatMulFpQ4: unsupported blk_quant_type ", t);
+    blk_quant_type_ = static_cast<MLAS_BLK_QUANT_TYPE>(t);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  MLAS_BLK_QUANT_TYPE blk_quant_type_{BlkQ4Zp8};
+};
+
+Status MatMulFpQ4::Compute(OpKernelContext* ctx) const {
+  concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
+
+  const Tensor* a = ctx->Input<Tensor>(0);
+  const Tensor* b = ctx->Input<Tensor>(1);
+  const Tensor* b_shape = ctx->Input<Tensor>(2);
+  const auto* a_data = a->Data<float>();
+  const uint8_t* b_data = b->Data<uint8_t>();
+
+  ORT_RETURN_IF_NOT(b_shape->Shape().NumDimensions() == 1 && b_shape->Shape()[0] == 2,
+                    "MatMulFpQ4: B_shape must be a 1-D tensor with 2 elements, got ", b_shape->Shape());
+  const auto* b_shape_data = b_shape->Data<int64_t>();
+  const TensorShape b_shape_value({b_shape_data[0], b_shape_data[1]});
+  ORT_RETURN_IF_NOT(b_shape_value[0] >= 0 && b_shape_value[1] >= 0,
+                    "MatMulFpQ4: invalid shape of B ", b_shape_value);
+
+  MatMulComputeHelper helper;
+  ORT_RETURN_IF_ERROR(helper.Compute(a->Shape(), b_shape_value));
+
+  const size_t max_len = helper.OutputOffsets().size();
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+  const size_t lda = static_cast<size_t>(helper.Lda(false));
+
+  const size_t packed_b_size = MlasQ4GemmPackBSize(blk_quant_type_, N, K);
+  ORT_RETURN_IF_NOT(static_cast<size_t>(b->Shape().Size()) == packed_b_size,
+                    "MatMulFpQ4: size of B ", b->Shape().Size(), " does not match the expected packed size ",
+                    packed_b_size, " for the shape ", b_shape_value);
+
+  Tensor* y = ctx->Output(0, helper.OutputShape());
+
+  // Bail out early if the output is going to be empty
+  if (y->Shape().Size() == 0)
+    return Status::OK();
+
+  auto* y_data = y->MutableData<float>();
+
+  std::vector<MLAS_Q4_GEMM_DATA_PARAMS> gemm_params(max_len);
+  for (size_t i = 0; i < max_len; i++) {
+    gemm_params[i].A = a_data + helper.LeftOffsets()[i];
+    gemm_params[i].lda = lda;
+    gemm_params[i].B = b_data;
+    gemm_params[i].Bias = nullptr;
+    gemm_params[i].C = y_data + helper.OutputOffsets()[i];
+    gemm_params[i].ldc = N;
+  }
+  MlasQ4GemmBatch(blk_quant_type_, M, N, K, max_len, gemm_params.data(), thread_pool);
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_KERNEL_EX(
+    MatMulFpQ4,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T2", DataTypeImpl::GetTensorType<uint8_t>())
+        .TypeConstraint("T3", DataTypeImpl::GetTensorType<int64_t>()),
+    MatMulFpQ4);
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -6,8 +6,13 @@
 #include "core/common/utf8_util.h"
 #include "core/framework/tensor.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/ort_mutex.h"
+#include "core/platform/threadpool.h"
 #include "re2/re2.h"
 
+#include <algorithm>
+#include <string_view>
+
 namespace onnxruntime {
 namespace contrib {
 
@@ -21,21 +26,35 @@ class Tokenizer final : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  Status CharTokenize(OpKernelContext* context, size_t N, size_t C,
-                      gsl::span<const int64_t> input_dims) const;
-
-  Status SeparatorExpressionTokenizer(OpKernelContext* context, size_t N, size_t C,
-                                      gsl::span<const int64_t> input_dims) const;
-
-  Status TokenExpression(OpKernelContext* ctx,
-                         size_t N, size_t C,
-                         gsl::span<const int64_t> input_dims) const;
+  // A separator is matched with its regex, or with std::string_view::find() if it's a plain string, which finds the
+  // same leftmost longest match.
+  struct Separator {
+    std::string literal;
+    std::unique_ptr<re2::RE2> regex;
+  };
+
+  // Tokenizes the input strings in parallel, recording the offset and length of every token, then copies the tokens
+  // into the output tensor, which is allocated for the longest row of tokens. tokenize(text, emit) calls
+  // emit(token) for every token of text in order. The tokens are views of the input strings.
+  template <typename TokenizeFn>
+  Status TokenizeStrings(OpKernelContext* ctx, size_t N, size_t C, gsl::span<const int64_t> input_dims,
+                         double cycles_per_byte, const TokenizeFn& tokenize) const;
+
+  template <typename EmitFn>
+  Status CharTokenize(std::string_view text, EmitFn& emit) const;
+
+  // Splits text by the separators from separator_index on, every separator splitting the tokens of the previous one.
+  template <typename EmitFn>
+  Status SeparatorExpressionTokenize(std::string_view text, size_t separator_index, EmitFn& emit) const;
+
+  template <typename EmitFn>
+  Status TokenExpressionTokenize(std::string_view text, EmitFn& emit) const;
 
   bool mark_{false};
   std::string pad_value_;
   int64_t mincharnum_{0};
   bool char_tokenezation_{false};
-  std::vector<std::unique_ptr<re2::RE2>> separators_;
+  std::vector<Separator> separators_;
   std::unique_ptr<re2::RE2> regex_;
 };
 
@@ -52,6 +71,21 @@ ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
 namespace tokenizer_details {
 constexpr char start_text = 0x2;
 constexpr char end_text = 0x3;
+
+// Whether the separator contains no regex syntax, i.e. it only matches itself
+bool IsLiteralSeparator(const std::string& separator) {
+  return !separator.empty() && separator.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+}
+
+Status InvalidUtf8Input() {
+  // Please do not include the input text in the error message as it could
+  // be deemed as a compliance violation by teams using this operator
+  return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Input string contains invalid utf8 chars");
+}
+
+Status InvalidUtf8Match() {
+  return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Match contains invalid utf8 chars");
+}
 }  // namespace tokenizer_details
 
 using namespace tokenizer_details;
@@ -94,11 +128,16 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
       re2::RE2::Options options;
       options.set_longest_match(true);
       for (const auto& sep : separators) {
-        std::unique_ptr<re2::RE2> regex = std::make_unique<re2::RE2>(sep, options);
-        if (!regex->ok()) {
-          ORT_THROW("Can not digest separators: ", sep, " ", regex->error());
+        Separator separator;
+        if (IsLiteralSeparator(sep)) {
+          separator.literal = sep;
+        } else {
+          separator.regex = std::make_unique<re2::RE2>(sep, options);
+          if (!separator.regex->ok()) {
+            ORT_THROW("Can not digest separators: ", sep, " ", separator.regex->error());
+          }
         }
-        separators_.push_back(std::move(regex));
+        separators_.push_back(std::move(separator));
       }
     } else {
       // Use tokenexp
@@ -114,168 +153,81 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
   }
 }
 
-Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
-                               gsl::span<const int64_t> input_dims) const {
-  // With char tokenzation we get as many tokens as the number of
-  // utf8 characters in the string. So for every string we calculate its character(utf8) length
-  // add padding and add start/end test separators if necessary
-  size_t max_tokens = 0;
+template <typename TokenizeFn>
+Status Tokenizer::TokenizeStrings(OpKernelContext* ctx, size_t N, size_t C, gsl::span<const int64_t> input_dims,
+                                  double cycles_per_byte, const TokenizeFn& tokenize) const {
   auto X = ctx->Input<Tensor>(0);
   auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-    size_t tokens = 0;  // length in utf8 chars
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       tokens)) {
-      // Please do not include the input text in the error message as it could
-      // be deemed as a compliance violation by teams using this operator
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars");
-    }
-    max_tokens = std::max(max_tokens, tokens);
-    ++curr_input;
-  }
+  const size_t num_strings = N * C;
 
-  std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to apparently empty strings input.
-  if (max_tokens == 0) {
-    output_dims.push_back(0);
-    TensorShape output_shape(output_dims);
-    ctx->Output(0, output_shape);
-    return Status::OK();
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < num_strings; ++i) {
+    total_bytes += input_data[i].size();
   }
-
-  if (mark_) {
-    max_tokens += 2;  // Start/end markers as separate tokens
+  const double bytes_per_string = static_cast<double>(total_bytes) / static_cast<double>(num_strings);
+  const TensorOpCost cost{bytes_per_string, 0, 16.0 + bytes_per_string * cycles_per_byte};
+  auto* thread_pool = ctx->GetOperatorThreadPool();
+
+  // Every token is a non-empty substring of its string, and the tokens of a string don't overlap, so a string has at
+  // most as many tokens as bytes. The tokens of a string are recorded at the offset of its first byte in the
+  // concatenation of the strings, and copied into the output once its shape is known, so every string is only
+  // matched once.
+  struct TokenSpan {
+    size_t offset;
+    size_t length;
+  };
+  std::vector<TokenSpan> token_spans(total_bytes);
+  std::vector<size_t> token_span_offsets(num_strings);
+  for (size_t i = 0, offset = 0; i < num_strings; ++i) {
+    token_span_offsets[i] = offset;
+    offset += input_data[i].size();
   }
 
-  output_dims.push_back(max_tokens);
-  TensorShape output_shape(output_dims);
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
-  size_t output_index = 0;
-  curr_input = input_data;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    size_t tokens = 0;
-    const size_t str_len = s.size();
-    for (size_t token_idx = 0; token_idx < str_len;) {
-      size_t tlen = 0;
-      bool result = utf8_bytes(static_cast<unsigned char>(s[token_idx]), tlen);
-      assert(result);
-      (void)result;
-      assert(token_idx + tlen <= str_len);
-      *(output_data + output_index) = s.substr(token_idx, tlen);
-      ++output_index;
-      token_idx += tlen;
-      ++tokens;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    // Padding strings
-    assert(tokens + (static_cast<size_t>(mark_) * 2) <= max_tokens);
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - tokens;
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
-    }
-    ++curr_input;
-  }
-  return Status::OK();
-}
-
-Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
-                                               size_t N, size_t C,
-                                               gsl::span<const int64_t> input_dims) const {
-  using namespace re2;
-  std::vector<std::vector<StringPiece>> rows;
-  rows.reserve(N * C);
-
-  // We do not constraint the search to match
-  // on the beginning or end of the string
-  const RE2::Anchor anchor = RE2::UNANCHORED;
-
-  // Scan all strings and attempt to find separators in them
-  // collect all the output tokens here
-  size_t max_tokens = 0;
-  auto X = ctx->Input<Tensor>(0);
-  auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-    size_t utf8_chars = 0;  // length in utf8 chars
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       utf8_chars)) {
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars: " + s);
-    }
-
-    std::vector<StringPiece> row{s};
-
-    for (const auto& sep : separators_) {
-      std::vector<StringPiece> tokens;
-      for (const auto& text : row) {
-        const auto end_pos = text.length();
-        size_t start_pos = 0;
-        StringPiece submatch;
-
-        bool match = true;
-        do {
-          match = sep->Match(text, start_pos, end_pos, anchor, &submatch, 1);
-          if (match) {
-            // Record  pos/len
-            assert(submatch.data() != nullptr);
-            size_t match_pos = submatch.data() - text.data();
-            assert(match_pos >= start_pos);
-            auto token_len = match_pos - start_pos;
-            utf8_chars = 0;
-            bool valid = utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
-                                  token_len, utf8_chars);
-            if (!valid) {
-              return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                            "Match contains invalid utf8 chars: " + submatch.as_string());
-            }
-            if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, token_len);
+  // The number of tokens of every string. A range of strings stops at its first error, and the error of the first
+  // string that fails is returned, as if the strings were tokenized in order.
+  std::vector<size_t> num_tokens(num_strings, 0);
+  OrtMutex error_mutex;
+  size_t error_index = num_strings;
+  Status error;
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_strings), cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i) {
+          const auto& s = input_data[i];
+          size_t utf8_chars = 0;
+          Status status = utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(), utf8_chars)
+                              ? Status::OK()
+                              : InvalidUtf8Input();
+          if (status.IsOK()) {
+            TokenSpan* const spans = token_spans.data() + token_span_offsets[i];
+            const size_t max_spans = s.size();
+            size_t tokens = 0;
+            auto record = [&](std::string_view token) {
+              if (tokens < max_spans) {
+                spans[tokens] = {static_cast<size_t>(token.data() - s.data()), token.size()};
+              }
+              ++tokens;
+            };
+            status = tokenize(std::string_view(s), record);
+            if (status.IsOK() && tokens > max_spans) {
+              status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Found ", tokens, " tokens in a string of ", max_spans,
+                                       " bytes.");
             }
-            // Update starting position
-            // Guard against empty string match
-            auto match_len = submatch.length();
-            if (match_len > 0) {
-              start_pos = match_pos + match_len;
-            } else {
-              size_t bytes = 0;
-              utf8_bytes(*submatch.data(), bytes);
-              start_pos = match_pos + bytes;
-            }
-          } else {
-            // record trailing token
-            auto trailing_len = end_pos - start_pos;
-            utf8_chars = 0;
-            utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
-                     trailing_len, utf8_chars);
-            if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, trailing_len);
+            num_tokens[i] = tokens;
+          }
+          if (!status.IsOK()) {
+            std::lock_guard<OrtMutex> lock(error_mutex);
+            if (i < error_index) {
+              error_index = i;
+              error = std::move(status);
             }
+            return;
           }
-        } while (match);
-      }  // row
-      // Replace the row with the results of this tokenezation
-      row.swap(tokens);
-    }  // separators_
-    max_tokens = std::max(max_tokens, row.size());
-    rows.push_back(std::move(row));
-    ++curr_input;
-  }
+        }
+      });
+  ORT_RETURN_IF_ERROR(error);
+
+  size_t max_tokens = *std::max_element(num_tokens.begin(), num_tokens.end());
 
   std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
   // Check if we have no output due to either empty input
@@ -293,169 +245,157 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
 
   output_dims.push_back(max_tokens);
   TensorShape output_shape(output_dims);
-
   auto output_tensor = ctx->Output(0, output_shape);
   auto const output_data = output_tensor->MutableData<std::string>();
 
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  size_t output_index = 0;
-  curr_input = input_data;
-  for (auto& row : rows) {
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.size());
-      ++output_index;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
-    }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
-    ++curr_input;
-  }
+  // Every string writes its row of the output from its recorded tokens
+  const TensorOpCost copy_cost{bytes_per_string, bytes_per_string, 4.0 * static_cast<double>(max_tokens)};
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_strings), copy_cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i) {
+          std::string* output = output_data + i * max_tokens;
+          std::string* const row_end = output + max_tokens;
+          if (mark_) {
+            (output++)->assign(&start_text, 1);
+          }
+          const std::string& s = input_data[i];
+          const TokenSpan* const spans = token_spans.data() + token_span_offsets[i];
+          for (size_t t = 0; t < num_tokens[i]; ++t) {
+            (output++)->assign(s.data() + spans[t].offset, spans[t].length);
+          }
+          if (mark_) {
+            (output++)->assign(&end_text, 1);
+          }
+          assert(output <= row_end);
+          // Padding strings
+          for (; output != row_end; ++output) {
+            *output = pad_value_;
+          }
+        }
+      });
+
   return Status::OK();
 }
 
-Status Tokenizer::TokenExpression(OpKernelContext* ctx,
-                                  size_t N, size_t C,
-                                  gsl::span<const int64_t> input_dims) const {
-  using namespace re2;
-  // Represents a token that will be output after
-  // first is the index, second is the size;
-  std::vector<std::vector<StringPiece>> tokens;
-  tokens.reserve(N * C);
+template <typename EmitFn>
+Status Tokenizer::CharTokenize(std::string_view text, EmitFn& emit) const {
+  // With char tokenzation we get as many tokens as the number of utf8 characters in the string
+  const size_t str_len = text.size();
+  for (size_t token_idx = 0; token_idx < str_len;) {
+    size_t tlen = 0;
+    bool result = utf8_bytes(static_cast<unsigned char>(text[token_idx]), tlen);
+    assert(result);
+    (void)result;
+    assert(token_idx + tlen <= str_len);
+    emit(text.substr(token_idx, tlen));
+    token_idx += tlen;
+  }
+  return Status::OK();
+}
 
-  size_t max_tokens = 0;
-  auto X = ctx->Input<Tensor>(0);
-  auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
+template <typename EmitFn>
+Status Tokenizer::SeparatorExpressionTokenize(std::string_view text, size_t separator_index, EmitFn& emit) const {
+  if (separator_index == separators_.size()) {
+    emit(text);
+    return Status::OK();
+  }
 
   // We do not constraint the search to match
   // on the beginning or end of the string
-  const RE2::Anchor anchor = RE2::UNANCHORED;
-
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-
-    size_t utf8_chars = 0;
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       utf8_chars)) {
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars: " + s);
-    }
-
-    tokens.emplace_back();
-    auto& row = tokens.back();
-
-    StringPiece text(s);
-    const auto end_pos = s.length();
-    size_t start_pos = 0;
-    StringPiece submatch;
-
-    bool match = true;
-    do {
-      match = regex_->Match(text, start_pos, end_pos, anchor, &submatch, 1);
+  const auto anchor = re2::RE2::UNANCHORED;
+  const auto& sep = separators_[separator_index];
+  const re2::StringPiece text_piece(text.data(), text.size());
+  const auto end_pos = text.length();
+  size_t start_pos = 0;
+  while (start_pos <= end_pos) {
+    size_t match_pos = 0;
+    size_t match_len = 0;
+    bool match = false;
+    if (!sep.literal.empty()) {
+      match_pos = text.find(sep.literal, start_pos);
+      match = match_pos != std::string_view::npos;
+      match_len = sep.literal.size();
+    } else {
+      re2::StringPiece submatch;
+      match = sep.regex->Match(text_piece, start_pos, end_pos, anchor, &submatch, 1);
       if (match) {
-        // Record  pos/len
         assert(submatch.data() != nullptr);
-        size_t match_pos = submatch.data() - s.data();
-        assert(match_pos >= start_pos);
-        // Guard against empty match and make
-        // sure we make progress either way
-        auto token_len = submatch.length();
-        utf8_chars = 0;
-        if (!utf8_len(reinterpret_cast<const unsigned char*>(submatch.data()), token_len, utf8_chars)) {
-          return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                        "Match contains invalid utf8 chars: " + submatch.as_string());
-        }
-        if (utf8_chars >= size_t(mincharnum_)) {
-          row.push_back(submatch);
-          start_pos = match_pos + token_len;
-        } else {
-          size_t bytes = 0;
-          utf8_bytes(*submatch.data(), bytes);
-          start_pos = match_pos + bytes;
-        }
+        match_pos = submatch.data() - text.data();
+        match_len = submatch.length();
       }
-    } while (match);
-    max_tokens = std::max(max_tokens, row.size());
-    ++curr_input;
-  }
-
-  // Check for empty output
-  std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to either empty input
-  // everything is a separator
-  if (max_tokens == 0) {
-    output_dims.push_back(0);
-    TensorShape output_shape(output_dims);
-    ctx->Output(0, output_shape);
-    return Status::OK();
-  }
-
-  if (mark_) {
-    max_tokens += 2;  // Start/end markers as separate tokens
-  }
-
-  output_dims.push_back(max_tokens);
-  TensorShape output_shape(output_dims);
-
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
+    }
 
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  curr_input = input_data;
-  size_t output_index = 0;
-  for (const auto& row : tokens) {
-    assert(curr_input != last);
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
+    if (!match) {
+      // record trailing token
+      auto trailing_len = end_pos - start_pos;
+      size_t utf8_chars = 0;
+      utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos), trailing_len, utf8_chars);
+      if (utf8_chars >= size_t(mincharnum_)) {
+        ORT_RETURN_IF_ERROR(SeparatorExpressionTokenize(text.substr(start_pos, trailing_len), separator_index + 1,
+                                                        emit));
+      }
+      break;
     }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.length());
-      ++output_index;
+
+    // Record  pos/len
+    assert(match_pos >= start_pos);
+    auto token_len = match_pos - start_pos;
+    size_t utf8_chars = 0;
+    if (!utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos), token_len, utf8_chars)) {
+      return InvalidUtf8Match();
     }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
+    if (utf8_chars >= size_t(mincharnum_)) {
+      ORT_RETURN_IF_ERROR(SeparatorExpressionTokenize(text.substr(start_pos, token_len), separator_index + 1, emit));
     }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
+    // Update starting position
+    // Guard against empty string match
+    if (match_len > 0) {
+      start_pos = match_pos + match_len;
+    } else if (match_pos < end_pos) {
+      size_t bytes = 0;
+      utf8_bytes(static_cast<unsigned char>(text[match_pos]), bytes);
+      start_pos = match_pos + bytes;
+    } else {
+      // an empty match at the end leaves no trailing token
+      break;
     }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
-    ++curr_input;
   }
+  return Status::OK();
+}
 
+template <typename EmitFn>
+Status Tokenizer::TokenExpressionTokenize(std::string_view text, EmitFn& emit) const {
+  // We do not constraint the search to match
+  // on the beginning or end of the string
+  const auto anchor = re2::RE2::UNANCHORED;
+  const re2::StringPiece text_piece(text.data(), text.size());
+  const auto end_pos = text.length();
+  size_t start_pos = 0;
+  re2::StringPiece submatch;
+  while (start_pos <= end_pos && regex_->Match(text_piece, start_pos, end_pos, anchor, &submatch, 1)) {
+    // Record  pos/len
+    assert(submatch.data() != nullptr);
+    size_t match_pos = submatch.data() - text.data();
+    assert(match_pos >= start_pos);
+    // Guard against empty match and make
+    // sure we make progress either way
+    auto token_len = submatch.length();
+    size_t utf8_chars = 0;
+    if (!utf8_len(reinterpret_cast<const unsigned char*>(submatch.data()), token_len, utf8_chars)) {
+      return InvalidUtf8Match();
+    }
+    if (utf8_chars >= size_t(mincharnum_)) {
+      emit(std::string_view(submatch.data(), token_len));
+      start_pos = match_pos + token_len;
+    } else if (match_pos < end_pos) {
+      size_t bytes = 0;
+      utf8_bytes(static_cast<unsigned char>(text[match_pos]), bytes);
+      start_pos = match_pos + bytes;
+    } else {
+      break;
+    }
+  }
   return Status::OK();
 }
 
@@ -498,13 +438,18 @@ Status Tokenizer::Compute(OpKernelContext* ctx) const {
   }
 
   if (char_tokenezation_) {
-    s = CharTokenize(ctx, N, C, input_dims);
+    s = TokenizeStrings(ctx, N, C, input_dims, 2.0,
+                        [this](std::string_view text, auto& emit) { return CharTokenize(text, emit); });
   } else {
     if (!separators_.empty()) {
-      s = SeparatorExpressionTokenizer(ctx, N, C, input_dims);
+      s = TokenizeStrings(ctx, N, C, input_dims, 16.0 * separators_.size(),
+                          [this](std::string_view text, auto& emit) {
+                            return SeparatorExpressionTokenize(text, 0, emit);
+                          });
     } else {
       assert(regex_ != nullptr);
-      s = TokenExpression(ctx, N, C, input_dims);
+      s = TokenizeStrings(ctx, N, C, input_dims, 16.0,
+                          [this](std::string_view text, auto& emit) { return TokenExpressionTokenize(text, emit); });
     }
   }
   return s;
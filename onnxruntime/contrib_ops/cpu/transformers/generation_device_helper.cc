@@ -523,47 +523,166 @@ Status DeviceCopy(gsl::span<T> target, gsl::span<const T> source, Stream* /*stre
   return Status::OK();
 }
 
-// Copy present state to past state for GPT model
+template <typename T>
+void ReorderBeamStateInPlace(gsl::span<T> state, size_t block_size, gsl::span<const int32_t> beam_indices) {
+  const size_t num_blocks = beam_indices.size();
+  ORT_ENFORCE(state.size() == num_blocks * block_size, "state size is not a multiple of the number of beams");
+
+  // A block is overwritten only after every other block reading it has been copied. Number of pending readers
+  // per block, not counting the blocks that keep their own content.
+  std::vector<int32_t> pending_readers(num_blocks, 0);
+  std::vector<bool> done(num_blocks, false);
+  for (size_t j = 0; j < num_blocks; j++) {
+    const auto src = static_cast<size_t>(beam_indices[j]);
+    ORT_ENFORCE(src < num_blocks, "beam index out of range: ", beam_indices[j]);
+    if (src == j) {
+      done[j] = true;
+    } else {
+      pending_readers[src]++;
+    }
+  }
+
+  const auto copy_block = [&](size_t src, size_t dst) {
+    gsl::copy(state.subspan(src * block_size, block_size), state.subspan(dst * block_size, block_size));
+  };
+
+  std::vector<size_t> ready;
+  for (size_t j = 0; j < num_blocks; j++) {
+    if (!done[j] && pending_readers[j] == 0) {
+      ready.push_back(j);
+    }
+  }
+  while (!ready.empty()) {
+    const size_t j = ready.back();
+    ready.pop_back();
+    const auto src = static_cast<size_t>(beam_indices[j]);
+    copy_block(src, j);
+    done[j] = true;
+    if (--pending_readers[src] == 0 && !done[src]) {
+      ready.push_back(src);
+    }
+  }
+
+  // The remaining blocks form cycles, e.g. two beams swapping their states. Each cycle is broken with one
+  // temporary block.
+  std::vector<T> temp;
+  for (size_t j = 0; j < num_blocks; j++) {
+    if (done[j]) {
+      continue;
+    }
+    auto first = state.subspan(j * block_size, block_size);
+    temp.assign(first.begin(), first.end());
+    size_t current = j;
+    while (static_cast<size_t>(beam_indices[current]) != j) {
+      const auto src = static_cast<size_t>(beam_indices[current]);
+      copy_block(src, current);
+      done[current] = true;
+      current = src;
+    }
+    gsl::copy(gsl::make_span<const T>(temp.data(), temp.size()), state.subspan(current * block_size, block_size));
+    done[current] = true;
+  }
+}
+
+// Copy present state to past state for GPT model.
+// The present state is not used after this step, so its buffer is reused for the past state, and only the beams
+// that are not continued from the same beam are copied.
 template <typename T>
 void PickGptPastState(const std::vector<OrtValue>& last_outputs,
                       std::vector<OrtValue>& next_inputs,
                       gsl::span<const int32_t>& beam_indices,
                       int gpt_subgraph_first_past_input_idx,
-                      int gpt_subgraph_first_present_output_idx,
-                      AllocatorPtr allocator) {
+                      int gpt_subgraph_first_present_output_idx) {
   int num_present_tensors = static_cast<int>(last_outputs.size()) - gpt_subgraph_first_present_output_idx;
   for (ptrdiff_t i = 0; i < num_present_tensors; ++i) {
-    const OrtValue& present = last_outputs[gpt_subgraph_first_present_output_idx + i];
+    OrtValue past = last_outputs[gpt_subgraph_first_present_output_idx + i];
 
     // shape is like (2, batch_beam_size, 12, past_seq_len, 64)
-    const TensorShape& past_shape = present.Get<Tensor>().Shape();
-    auto block_size_per_beam = past_shape[2] * past_shape[3] * past_shape[4];
-    auto past_key_size = past_shape[1] * past_shape[2] * past_shape[3] * past_shape[4];
-
-    // Create a tensor with same shape.
-    // TODO(tianleiwu): allocate one buffer for all layers
-    OrtValue past;
-    auto past_type = DataTypeImpl::GetType<T>();
-    Tensor::InitOrtValue(past_type, past_shape, allocator, past);
-
-    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    gsl::span<const T> present_span = gsl::make_span<const T>(present.Get<Tensor>().Data<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    for (size_t j = 0; j < beam_indices.size(); j++) {
-      int32_t beam_index = beam_indices[j];
-      gsl::span<const T> present_key = present_span.subspan(beam_index * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<const T> present_value = present_span.subspan(past_key_size + beam_index * SafeInt<size_t>(block_size_per_beam),
-                                                              onnxruntime::narrow<size_t>(block_size_per_beam));
-
-      gsl::span<T> past_key = past_span.subspan(j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<T> past_value = past_span.subspan(past_key_size + j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::copy(present_key, past_key);
-      gsl::copy(present_value, past_value);
-    }
+    const TensorShape& past_shape = past.Get<Tensor>().Shape();
+    auto block_size_per_beam = onnxruntime::narrow<size_t>(past_shape[2] * past_shape[3] * past_shape[4]);
+    auto past_key_size = onnxruntime::narrow<size_t>(past_shape[1]) * block_size_per_beam;
+
+    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(),
+                                               onnxruntime::narrow<size_t>(past_shape.Size()));
+    ReorderBeamStateInPlace<T>(past_span.subspan(0, past_key_size), block_size_per_beam, beam_indices);
+    ReorderBeamStateInPlace<T>(past_span.subspan(past_key_size, past_key_size), block_size_per_beam, beam_indices);
 
     next_inputs[gpt_subgraph_first_past_input_idx + i] = past;
   }
 }
 
+// Create a tensor with the given rows (indices along the axis) of the input.
+static void GatherTensorRows(const Tensor& input,
+                             size_t axis,
+                             gsl::span<const int32_t> rows,
+                             AllocatorPtr allocator,
+                             OrtValue& output) {
+  const TensorShape& input_shape = input.Shape();
+  TensorShapeVector output_dims = input_shape.AsShapeVector();
+  output_dims[axis] = static_cast<int64_t>(rows.size());
+  Tensor::InitOrtValue(input.DataType(), TensorShape(output_dims), allocator, output);
+
+  const size_t outer_size = onnxruntime::narrow<size_t>(input_shape.SizeToDimension(axis));
+  const size_t input_rows = onnxruntime::narrow<size_t>(input_shape[axis]);
+  const size_t row_bytes = SafeInt<size_t>(input_shape.SizeFromDimension(axis + 1)) * input.DataType()->Size();
+
+  const auto* input_data = static_cast<const uint8_t*>(input.DataRaw());
+  auto* output_data = static_cast<uint8_t*>(output.GetMutable<Tensor>()->MutableDataRaw());
+  for (size_t i = 0; i < outer_size; i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      memcpy(output_data + (i * rows.size() + j) * row_bytes,
+             input_data + (i * input_rows + static_cast<size_t>(rows[j])) * row_bytes,
+             row_bytes);
+    }
+  }
+}
+
+Status KeepGptBatchRows(AllocatorPtr allocator,
+                        gsl::span<const int32_t> kept_rows,
+                        std::vector<OrtValue>& last_outputs,
+                        std::vector<OrtValue>& next_inputs,
+                        int gpt_subgraph_first_present_output_idx) {
+  // next_inputs: input_ids, position_id, attention_mask, past_0, past_1
+  // Only the attention mask is kept across iterations. The other inputs are created from the next tokens and the
+  // present state.
+  const Tensor& attention_mask = next_inputs[2].Get<Tensor>();
+  ORT_RETURN_IF_NOT(attention_mask.Shape().NumDimensions() == 2, "attention_mask shall be 2 dimensions");
+  for (int32_t row : kept_rows) {
+    ORT_RETURN_IF_NOT(row >= 0 && row < attention_mask.Shape()[0], "batch row out of range: ", row);
+  }
+
+  OrtValue kept_attention_mask;
+  GatherTensorRows(attention_mask, 0, kept_rows, allocator, kept_attention_mask);
+  next_inputs[2] = kept_attention_mask;
+
+  // last_outputs: logits, present_0, present_1, ...
+  // The present state has shape like (2, batch_size, 12, past_seq_len, 64).
+  for (size_t i = static_cast<size_t>(gpt_subgraph_first_present_output_idx); i < last_outputs.size(); ++i) {
+    const Tensor& present = last_outputs[i].Get<Tensor>();
+    ORT_RETURN_IF_NOT(present.Shape().NumDimensions() == 5 && present.Shape()[1] == attention_mask.Shape()[0],
+                      "present state shall have shape (2, batch_size, num_heads, past_seq_len, head_size)");
+    OrtValue kept_present;
+    GatherTensorRows(present, 1, kept_rows, allocator, kept_present);
+    last_outputs[i] = kept_present;
+  }
+
+  return Status::OK();
+}
+
+void ScatterBatchRows(const Tensor& input, gsl::span<const int32_t> rows, Tensor& output) {
+  const size_t row_bytes = SafeInt<size_t>(input.Shape().SizeFromDimension(1)) * input.DataType()->Size();
+  ORT_ENFORCE(input.DataType() == output.DataType() &&
+              static_cast<size_t>(input.Shape()[0]) == rows.size() &&
+              SafeInt<size_t>(output.Shape().SizeFromDimension(1)) * output.DataType()->Size() == row_bytes);
+
+  const auto* input_data = static_cast<const uint8_t*>(input.DataRaw());
+  auto* output_data = static_cast<uint8_t*>(output.MutableDataRaw());
+  for (size_t j = 0; j < rows.size(); j++) {
+    ORT_ENFORCE(rows[j] >= 0 && rows[j] < output.Shape()[0], "batch row out of range: ", rows[j]);
+    memcpy(output_data + static_cast<size_t>(rows[j]) * row_bytes, input_data + j * row_bytes, row_bytes);
+  }
+}
+
 template <typename T>
 Status UpdateGptFeeds(
     AllocatorPtr allocator,
@@ -646,7 +765,7 @@ Status UpdateGptFeeds(
   } else {
     PickGptPastState<T>(last_outputs, next_inputs, beam_indices_cpu,
                         gpt_subgraph_first_past_input_idx,
-                        gpt_subgraph_first_present_output_idx, allocator);
+                        gpt_subgraph_first_present_output_idx);
   }
   return Status::OK();
 }
@@ -731,28 +850,18 @@ void PickT5PastState(const std::vector<OrtValue>& last_outputs,
                      int num_present_tensors,
                      gsl::span<const int32_t>& beam_indices,
                      int t5_decoder_first_past_input_idx,
-                     int t5_decoder_first_present_output_idx,
-                     AllocatorPtr allocator) {
+                     int t5_decoder_first_present_output_idx) {
   for (ptrdiff_t i = 0; i < num_present_tensors; ++i) {
-    const OrtValue& present = last_outputs[t5_decoder_first_present_output_idx + i];
+    // The present state is not used after this step, so its buffer is reused for the past state.
+    OrtValue past = last_outputs[t5_decoder_first_present_output_idx + i];
 
     // shape is like (batch_beam_size, 12, past_seq_len, 64)
-    const TensorShape& past_shape = present.Get<Tensor>().Shape();
-    auto block_size_per_beam = past_shape[1] * past_shape[2] * past_shape[3];
-
-    // Create a tensor with same shape.
-    // TODO(tianleiwu): allocate one buffer for all layers
-    OrtValue past;
-    Tensor::InitOrtValue(DataTypeImpl::GetType<T>(), past_shape, allocator, past);
-
-    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    gsl::span<const T> present_span = gsl::make_span<const T>(present.Get<Tensor>().Data<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    for (size_t j = 0; j < beam_indices.size(); j++) {
-      int32_t beam_index = beam_indices[j];
-      gsl::span<const T> present_beam = present_span.subspan(beam_index * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<T> past_beam = past_span.subspan(j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::copy(present_beam, past_beam);
-    }
+    const TensorShape& past_shape = past.Get<Tensor>().Shape();
+    auto block_size_per_beam = onnxruntime::narrow<size_t>(past_shape[1] * past_shape[2] * past_shape[3]);
+
+    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(),
+                                               onnxruntime::narrow<size_t>(past_shape.Size()));
+    ReorderBeamStateInPlace<T>(past_span, block_size_per_beam, beam_indices);
 
     next_inputs[t5_decoder_first_past_input_idx + i] = past;
   }
@@ -826,7 +935,7 @@ Status UpdateDecoderFeeds(
     }
   } else {
     PickT5PastState<T>(last_outputs, next_inputs, num_present_tensors, beam_indices,
-                       t5_decoder_first_past_input_idx, t5_decoder_first_present_output_idx, allocator);
+                       t5_decoder_first_past_input_idx, t5_decoder_first_present_output_idx);
   }
   return Status::OK();
 }
@@ -922,6 +1031,10 @@ template Status UpdateDecoderFeeds<float>(
     transformers::Sequences& sequences,
     const transformers::IConsoleDumper* dumper);
 
+template void ReorderBeamStateInPlace<float>(gsl::span<float> state,
+                                             size_t block_size,
+                                             gsl::span<const int32_t> beam_indices);
+
 template void ExpandInputs<int32_t>(const OrtValue& input, int num_beams, AllocatorPtr allocator, OrtValue& expanded);
 
 template Status ExpandBuffer<int32_t>(
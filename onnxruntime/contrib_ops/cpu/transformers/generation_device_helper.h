@@ -309,6 +309,27 @@ Status UpdateDecoderFeeds(
 // ---------------------------------------------------------------
 // Utility Functions
 // ---------------------------------------------------------------
+
+// Reorder the state of beams in place, so that block j of block_size elements is replaced by the block of
+// beam_indices[j]. Only the blocks of beams that do not continue from the same beam are copied.
+// This is not a paged KV cache: the past state of every beam stays a contiguous block of the dense past tensors that
+// the decoder subgraph consumes. Beams sharing a prefix each hold a copy of it, and the number of sequences that fit
+// in memory is unchanged. The reordering only saves the allocation of new past tensors at every step.
+template <typename T>
+void ReorderBeamStateInPlace(gsl::span<T> state, size_t block_size, gsl::span<const int32_t> beam_indices);
+
+// Keep only the given rows of the GPT subgraph state of greedy search or sampling, so that finished sequences are
+// not decoded again. The attention mask in next_inputs and the present state in last_outputs are replaced by
+// tensors that only have the kept rows.
+Status KeepGptBatchRows(AllocatorPtr allocator,
+                        gsl::span<const int32_t> kept_rows,
+                        std::vector<OrtValue>& last_outputs,
+                        std::vector<OrtValue>& next_inputs,
+                        int gpt_subgraph_first_present_output_idx);
+
+// Copy row j of the input, with shape (rows.size(), ...), to row rows[j] of the output with shape (batch_size, ...).
+void ScatterBatchRows(const Tensor& input, gsl::span<const int32_t> rows, Tensor& output);
+
 template <typename T>
 void ExpandInputs(const OrtValue& input, int num_beams, AllocatorPtr allocator, OrtValue& expanded);
 
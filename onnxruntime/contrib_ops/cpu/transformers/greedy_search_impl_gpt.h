@@ -3,6 +3,7 @@
 
 #pragma once
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include "core/common/span_utils.h"
@@ -259,6 +260,19 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                        this->temp_space_allocator_->Info(),
                        position_ids);
 
+  // Rows of the batch that are decoded by the subgraph. On CPU, finished sequences are removed from the subgraph
+  // inputs between iterations, so that the cost of each iteration depends on the number of unfinished sequences
+  // instead of the batch size. The logits of the remaining rows are scattered to a full batch before processing.
+  const bool compact_batch = !this->IsCuda() &&
+                             !gpt_subgraph_.past_present_share_buffer_ &&
+                             !gpt_subgraph_.has_decoder_masked_self_attention_ &&
+                             parameters->BatchBeamSize() > 1;
+  std::vector<int32_t> active_rows(static_cast<size_t>(parameters->BatchBeamSize()));
+  std::iota(active_rows.begin(), active_rows.end(), 0);
+  std::vector<int32_t> kept_rows;
+  std::vector<int32_t> active_next_tokens;
+  OrtValue full_logits;
+
   int current_length = parameters->sequence_length;
   int iteration_counter = 0;
   while (current_length < parameters->max_length) {
@@ -303,7 +317,23 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     ORT_RETURN_IF_ERROR(status);
 
-    const OrtValue& logits = fetches[0];
+    const OrtValue* logits_value = &fetches[0];
+    if (active_rows.size() < static_cast<size_t>(parameters->BatchBeamSize())) {
+      const Tensor& active_logits = fetches[0].Get<Tensor>();
+      TensorShapeVector full_logits_dims = active_logits.Shape().AsShapeVector();
+      full_logits_dims[0] = parameters->BatchBeamSize();
+      if (!full_logits.IsAllocated() || full_logits.Get<Tensor>().Shape() != TensorShape(full_logits_dims)) {
+        // Rows of finished sequences are not updated. Their next tokens are replaced by the pad token.
+        Tensor::InitOrtValue(active_logits.DataType(), TensorShape(full_logits_dims), this->temp_space_allocator_,
+                             full_logits);
+        Tensor* full_logits_tensor = full_logits.GetMutable<Tensor>();
+        memset(full_logits_tensor->MutableDataRaw(), 0, full_logits_tensor->SizeInBytes());
+      }
+      GenerationCpuDeviceHelper::ScatterBatchRows(active_logits, active_rows, *full_logits.GetMutable<Tensor>());
+      logits_value = &full_logits;
+    }
+
+    const OrtValue& logits = *logits_value;
     gsl::span<int32_t> next_tokens;
 
     ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
@@ -350,9 +380,49 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
     if (current_length < parameters->max_length) {
       bool increase_position = (iteration_counter > 1);
 
+      if (compact_batch) {
+        kept_rows.clear();
+        for (size_t i = 0; i < active_rows.size(); i++) {
+          if (!eos_meet[active_rows[i]]) {
+            kept_rows.push_back(static_cast<int32_t>(i));
+          }
+        }
+
+        if (kept_rows.size() < active_rows.size()) {
+          ORT_RETURN_IF_ERROR(GenerationCpuDeviceHelper::KeepGptBatchRows(this->temp_space_allocator_,
+                                                                          kept_rows,
+                                                                          fetches,
+                                                                          feeds,
+                                                                          gpt_subgraph_.GetFirstPresentOutputIndex()));
+
+          // Kept rows are in ascending order, so the positions and the row mapping can be updated in place.
+          for (size_t i = 0; i < kept_rows.size(); i++) {
+            greedy_state.next_positions[i] = greedy_state.next_positions[kept_rows[i]];
+            active_rows[i] = active_rows[kept_rows[i]];
+          }
+          active_rows.resize(kept_rows.size());
+
+          int64_t active_dims[] = {static_cast<int64_t>(active_rows.size()), 1};
+          Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(),
+                               TensorShape(&active_dims[0], 2),
+                               greedy_state.next_positions.data(),
+                               this->temp_space_allocator_->Info(),
+                               position_ids);
+        }
+      }
+
+      gsl::span<const int32_t> feed_tokens = ReinterpretAsSpan<const int32_t>(next_tokens);
+      if (active_rows.size() < next_tokens.size()) {
+        active_next_tokens.resize(active_rows.size());
+        for (size_t i = 0; i < active_rows.size(); i++) {
+          active_next_tokens[i] = next_tokens[active_rows[i]];
+        }
+        feed_tokens = active_next_tokens;
+      }
+
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
                                       position_ids, increase_position,
-                                      ReinterpretAsSpan<const int32_t>(next_tokens),
+                                      feed_tokens,
                                       current_length - 1));
     }
     if (gpt_subgraph_.past_present_share_buffer_) {
@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/gsl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ORT_FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace onnxruntime {
+
+// The hash of the keys of a FlatHashMap. Strings hash as std::string_view, so a std::string key can be looked up
+// with a std::string_view and the other way around, without creating a std::string.
+template <typename Key>
+struct FlatHashMapHash {
+  size_t operator()(const Key& key) const { return std::hash<Key>{}(key); }
+};
+
+template <>
+struct FlatHashMapHash<std::string> {
+  size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+template <>
+struct FlatHashMapHash<std::string_view> : FlatHashMapHash<std::string> {};
+
+// An open-addressing hash map in the style of the abseil Swiss tables, for the lookup tables which kernels build once
+// from their attributes and look up for every element of their inputs.
+//
+// The slots are stored in a single array, next to an array with a control byte per slot: kEmpty, or the 7 low bits
+// of the hash of the key in the slot. A lookup probes groups of kGroupWidth slots in a quadratic sequence. It
+// compares the 7 bits of the hash of the key to all the control bytes of a group at once, with SSE2 where it's
+// available, and only compares the keys of the matching slots. The full hash of every key is stored in its slot as
+// well, so the keys are compared only if the full hashes match, and growing the map doesn't hash the keys again.
+//
+// Keys can't be removed. A lookup accepts any key the hash and operator== of Key accept, e.g. a std::string_view for
+// std::string keys. Key and Value must be default constructible and movable.
+//
+// Unlike InlinedHashMap this doesn't depend on abseil, and it looks up batches of keys, see FindBatch().
+template <typename Key, typename Value, typename Hash = FlatHashMapHash<Key>>
+class FlatHashMap {
+ public:
+  static constexpr size_t kGroupWidth = 16;
+
+  FlatHashMap() = default;
+
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+  size_t Capacity() const { return ctrl_.size(); }
+
+  // Allocates the slots for num_keys keys.
+  void Reserve(size_t num_keys) {
+    size_t capacity = kGroupWidth;
+    while (capacity / kMaxLoadDenominator * kMaxLoadNumerator < num_keys) {
+      capacity *= 2;
+    }
+    if (capacity > Capacity()) {
+      Rehash(capacity);
+    }
+  }
+
+  // Inserts the key if it's not in the map yet. Returns the value of the key and whether the key was inserted.
+  std::pair<Value*, bool> Insert(Key key, Value value) {
+    const size_t hash = HashOf(key);
+    const size_t existing = FindIndex(key, hash);
+    if (existing != kNotFound) {
+      return {&slots_[existing].value, false};
+    }
+
+    if (Capacity() / kMaxLoadDenominator * kMaxLoadNumerator < size_ + 1) {
+      Rehash(std::max(kGroupWidth, Capacity() * 2));
+    }
+    const size_t index = FindEmptySlot(hash);
+    ctrl_[index] = H2(hash);
+    Slot& slot = slots_[index];
+    slot.hash = hash;
+    slot.key = std::move(key);
+    slot.value = std::move(value);
+    ++size_;
+    return {&slot.value, true};
+  }
+
+  // Inserts the key, or replaces its value if it's in the map already.
+  void InsertOrAssign(Key key, Value value) {
+    auto inserted = Insert(std::move(key), Value{});
+    *inserted.first = std::move(value);
+  }
+
+  // Returns the value of the key, or nullptr if the key is not in the map.
+  template <typename LookupKey>
+  const Value* Find(const LookupKey& key) const {
+    const size_t index = FindIndex(key, HashOf(key));
+    return index == kNotFound ? nullptr : &slots_[index].value;
+  }
+
+  // Looks up every key of keys and calls fn(i, value) for the i-th key, where value is nullptr if the key is not in
+  // the map. The keys are hashed a block at a time and the groups they probe first are prefetched before any of them
+  // is looked up, so that the cache misses of the lookups of a block overlap.
+  template <typename LookupKey, typename Fn>
+  void FindBatch(gsl::span<const LookupKey> keys, Fn&& fn) const {
+    constexpr size_t kBlockSize = 16;
+    size_t hashes[kBlockSize];
+    for (size_t block_begin = 0; block_begin < keys.size(); block_begin += kBlockSize) {
+      const size_t block_size = std::min(kBlockSize, keys.size() - block_begin);
+      for (size_t i = 0; i < block_size; ++i) {
+        hashes[i] = HashOf(keys[block_begin + i]);
+        if (size_ != 0) {
+          const size_t group = FirstGroup(hashes[i]);
+          Prefetch(&ctrl_[group * kGroupWidth]);
+          Prefetch(&slots_[group * kGroupWidth]);
+        }
+      }
+      for (size_t i = 0; i < block_size; ++i) {
+        const size_t index = FindIndex(keys[block_begin + i], hashes[i]);
+        fn(block_begin + i, index == kNotFound ? nullptr : &slots_[index].value);
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    size_t hash{0};
+    Key key{};
+    Value value{};
+  };
+
+  static constexpr int8_t kEmpty = static_cast<int8_t>(-128);
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+  // at most 7/8 of the slots are full, so every probe sequence ends at an empty slot
+  static constexpr size_t kMaxLoadNumerator = 7;
+  static constexpr size_t kMaxLoadDenominator = 8;
+
+  template <typename LookupKey>
+  size_t HashOf(const LookupKey& key) const {
+    // std::hash of an integer is the identity in some standard libraries. Mix the bits, as the group and the control
+    // byte are taken from the high and the low bits of the hash.
+    uint64_t hash = static_cast<uint64_t>(Hash{}(key));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+  }
+
+  static int8_t H2(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+  size_t FirstGroup(size_t hash) const { return (hash >> 7) & (Capacity() / kGroupWidth - 1); }
+
+  // The next group of the probe sequence. The steps are the triangular numbers, which visit every group as the
+  // number of groups is a power of 2.
+  size_t NextGroup(size_t group, size_t step) const { return (group + step) & (Capacity() / kGroupWidth - 1); }
+
+  static int CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+  static void Prefetch(const void* address) {
+#if defined(ORT_FLAT_HASH_MAP_SSE2)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    ORT_UNUSED_PARAMETER(address);
+#endif
+  }
+
+  // A bit per slot of the group whose control byte is h2.
+  static uint32_t MatchByte(const int8_t* ctrl, int8_t h2) {
+#if defined(ORT_FLAT_HASH_MAP_SSE2)
+    const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), group)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // A bit per empty slot of the group.
+  static uint32_t MatchEmpty(const int8_t* ctrl) {
+#if defined(ORT_FLAT_HASH_MAP_SSE2)
+    // kEmpty is the only control byte with the sign bit set
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+    return MatchByte(ctrl, kEmpty);
+#endif
+  }
+
+  template <typename LookupKey>
+  size_t FindIndex(const LookupKey& key, size_t hash) const {
+    if (size_ == 0) {
+      return kNotFound;
+    }
+    size_t group = FirstGroup(hash);
+    for (size_t step = 1;; ++step) {
+      const int8_t* ctrl = &ctrl_[group * kGroupWidth];
+      for (uint32_t match = MatchByte(ctrl, H2(hash)); match != 0; match &= match - 1) {
+        const size_t index = group * kGroupWidth + CountTrailingZeros(match);
+        const Slot& slot = slots_[index];
+        if (slot.hash == hash && slot.key == key) {
+          return index;
+        }
+      }
+      if (MatchEmpty(ctrl) != 0) {
+        return kNotFound;
+      }
+      group = NextGroup(group, step);
+    }
+  }
+
+  size_t FindEmptySlot(size_t hash) const {
+    size_t group = FirstGroup(hash);
+    for (size_t step = 1;; ++step) {
+      const uint32_t empty = MatchEmpty(&ctrl_[group * kGroupWidth]);
+      if (empty != 0) {
+        return group * kGroupWidth + CountTrailingZeros(empty);
+      }
+      group = NextGroup(group, step);
+    }
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<Slot> old_slots = std::move(slots_);
+    std::vector<int8_t> old_ctrl = std::move(ctrl_);
+    slots_ = std::vector<Slot>(capacity);
+    ctrl_.assign(capacity, kEmpty);
+    for (size_t i = 0; i < old_ctrl.size(); ++i) {
+      if (old_ctrl[i] != kEmpty) {
+        const size_t index = FindEmptySlot(old_slots[i].hash);
+        ctrl_[index] = old_ctrl[i];
+        slots_[index] = std::move(old_slots[i]);
+      }
+    }
+  }
+
+  std::vector<int8_t> ctrl_;
+  std::vector<Slot> slots_;
+  size_t size_{0};
+};
+
+}  // namespace onnxruntime
@@ -13,12 +13,20 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <locale>
 #include <memory>
 #include <optional>
+#include <sstream>
+#include <vector>
 
 #include "core/platform/threadpool.h"
 #include "core/common/common.h"
 #include "core/common/cpuid_info.h"
+#include "core/common/parse_string.h"
+#include "core/common/string_utils.h"
 #include "core/common/eigen_common_wrapper.h"
 #include "core/platform/EigenNonBlockingThreadPool.h"
 #include "core/platform/ort_mutex.h"
@@ -306,6 +314,25 @@ class alignas(CACHE_LINE_BYTES) LoopCounter {
     return idx % _num_shards;
   }
 
+  // When the threads are partitioned between NUMA nodes, the shards are
+  // split between the nodes in the same way, and a thread starts from one
+  // of the shards of its own node.  Node k hence processes the k-th part of
+  // the iteration space in each loop of the same size, and pages of an
+  // output placed on the node by the first touch are read and written by the
+  // same node in the following loops.  Threads still move on to the shards
+  // of other nodes once their own are exhausted.
+  unsigned GetHomeShard(unsigned idx, int numa_node, int num_numa_nodes) const {
+    if (numa_node < 0 || num_numa_nodes <= 1) {
+      return GetHomeShard(idx);
+    }
+    const unsigned first = static_cast<unsigned>(numa_node) * _num_shards / static_cast<unsigned>(num_numa_nodes);
+    const unsigned last = (static_cast<unsigned>(numa_node) + 1) * _num_shards / static_cast<unsigned>(num_numa_nodes);
+    if (first == last) {
+      return GetHomeShard(idx);
+    }
+    return first + idx % (last - first);
+  }
+
   // Attempt to claim iterations from the sharded counter.  The function either
   // returns true, along with a block of exactly block_size iterations, or it returns false
   // if all of the iterations have been claimed.
@@ -396,11 +423,259 @@ ThreadPool::ThreadPool(Env* env,
                                                 *env,
                                                 thread_options_);
     underlying_threadpool_ = extended_eigen_threadpool_.get();
+
+    if (thread_options_.numa_nodes.size() == static_cast<size_t>(degree_of_parallelism)) {
+      num_numa_nodes_ = *std::max_element(thread_options_.numa_nodes.begin(), thread_options_.numa_nodes.end()) + 1;
+    }
   }
 }
 
 ThreadPool::~ThreadPool() = default;
 
+namespace {
+thread_local ThreadPool::LoopPriority current_loop_priority = ThreadPool::LoopPriority::kNormal;
+
+// Relative share of the threads given to a loop of each priority class when loops of
+// several classes run at the same time.
+constexpr unsigned kLoopPriorityWeights[ThreadPool::kNumLoopPriorities] = {1, 4, 16};
+
+// Helper threads check whether their loop still has its share of the threads after this many blocks, rather than
+// reading the loop counts of every class after each block.
+constexpr unsigned kBlocksPerFairShareCheck = 4;
+
+// Counts a parallel loop as running in the pool for the lifetime of the object.
+class ActiveLoopScope {
+ public:
+  explicit ActiveLoopScope(std::atomic<int>& active_loops) : active_loops_(active_loops) {
+    active_loops_.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~ActiveLoopScope() {
+    active_loops_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int>& active_loops_;
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ActiveLoopScope);
+};
+}  // namespace
+
+ThreadPool::PriorityScope::PriorityScope(LoopPriority priority) : previous_(current_loop_priority) {
+  current_loop_priority = priority;
+}
+
+ThreadPool::PriorityScope::~PriorityScope() {
+  current_loop_priority = previous_;
+}
+
+ThreadPool::LoopPriority ThreadPool::CurrentLoopPriority() {
+  return current_loop_priority;
+}
+
+Status ThreadPool::ParseLoopPriority(const std::string& str, LoopPriority& priority) {
+  if (str == "low") {
+    priority = LoopPriority::kLow;
+  } else if (str == "normal") {
+    priority = LoopPriority::kNormal;
+  } else if (str == "high") {
+    priority = LoopPriority::kHigh;
+  } else {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Invalid thread pool priority '", str, "', expected one of 'low', 'normal' or 'high'");
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// The coefficients of ParallelForCostModel in the order of its text format.
+struct CostModelField {
+  const char* name;
+  double ParallelForCostModel::*member;
+};
+
+constexpr CostModelField kCostModelFields[] = {
+    {"load_cycles_per_byte", &ParallelForCostModel::load_cycles_per_byte},
+    {"store_cycles_per_byte", &ParallelForCostModel::store_cycles_per_byte},
+    {"cycles_per_compute_cycle", &ParallelForCostModel::cycles_per_compute_cycle},
+    {"startup_cycles", &ParallelForCostModel::startup_cycles},
+    {"per_thread_cycles", &ParallelForCostModel::per_thread_cycles},
+    {"task_size_cycles", &ParallelForCostModel::task_size_cycles},
+};
+
+// The coefficients of the cost model that only depend on the machine.
+struct MachineCosts {
+  double ns_per_cycle;
+  double load_cycles_per_byte;
+  double store_cycles_per_byte;
+  double cycles_per_compute_cycle;
+};
+
+template <typename F>
+double MedianNanoseconds(int repetitions, F&& f) {
+  std::vector<double> times;
+  times.reserve(repetitions);
+  for (int i = 0; i < repetitions; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+  // the resolution of the clock must not make a coefficient 0
+  return std::max(times[times.size() / 2], 1.0);
+}
+
+MachineCosts MeasureMachineCosts() {
+  constexpr int kRepetitions = 5;
+  // the default cost model assumes the data of a loop is in the L2 cache
+  constexpr size_t kBufferBytes = 128 * 1024;
+  constexpr int kPasses = 8;
+  volatile uint32_t sink = 1;
+  MachineCosts costs;
+
+  // a chain of dependent shifts and additions, one cycle each
+  constexpr int64_t kChainLength = int64_t{1} << 20;
+  const double chain_ns = MedianNanoseconds(kRepetitions, [&sink]() {
+    uint32_t x = sink;
+    for (int64_t i = 0; i < kChainLength; ++i) {
+      x += x >> 1;
+    }
+    sink = x;
+  });
+  costs.ns_per_cycle = chain_ns / (2 * kChainLength);
+
+  std::vector<uint32_t> buffer(kBufferBytes / sizeof(uint32_t), 1);
+  const double num_bytes = static_cast<double>(kPasses) * kBufferBytes;
+  const double load_ns = MedianNanoseconds(kRepetitions, [&buffer, &sink]() {
+    uint32_t sum = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+      for (const uint32_t value : buffer) {
+        sum += value;
+      }
+    }
+    sink = sum;
+  });
+  costs.load_cycles_per_byte = load_ns / num_bytes / costs.ns_per_cycle;
+
+  const double store_ns = MedianNanoseconds(kRepetitions, [&buffer, &sink]() {
+    for (int pass = 0; pass < kPasses; ++pass) {
+      std::fill(buffer.begin(), buffer.end(), sink + static_cast<uint32_t>(pass));
+      sink = buffer[static_cast<size_t>(pass) * 97 % buffer.size()];
+    }
+  });
+  costs.store_cycles_per_byte = store_ns / num_bytes / costs.ns_per_cycle;
+
+  // A float multiply-add per element of a buffer that fits in the L1 cache, which the kernels estimate as about one
+  // compute cycle per operation. Vector units make it cheaper than a cycle.
+  std::vector<float> values(1024, 1.0f);
+  constexpr int kComputePasses = 1024;
+  const double compute_ns = MedianNanoseconds(kRepetitions, [&values, &sink]() {
+    const float scale = 1.0f + static_cast<float>(sink & 1) * 1e-7f;
+    for (int pass = 0; pass < kComputePasses; ++pass) {
+      for (float& value : values) {
+        value = value * scale + 1e-7f;
+      }
+    }
+    sink = static_cast<uint32_t>(values[0]);
+  });
+  costs.cycles_per_compute_cycle =
+      compute_ns / (2.0 * kComputePasses * static_cast<double>(values.size())) / costs.ns_per_cycle;
+  return costs;
+}
+
+}  // namespace
+
+Status ThreadPool::ParseCostModel(const std::string& str, ParallelForCostModel& cost_model) {
+  ParallelForCostModel parsed = cost_model;
+  for (const auto entry : utils::SplitString(str, ";")) {
+    const auto separator = entry.find('=');
+    ORT_RETURN_IF(separator == std::string_view::npos, "Invalid cost model entry '", entry,
+                  "', expected 'name=value'");
+    const auto name = entry.substr(0, separator);
+    const auto* field = std::find_if(std::begin(kCostModelFields), std::end(kCostModelFields),
+                                     [&name](const CostModelField& f) { return name == f.name; });
+    ORT_RETURN_IF(field == std::end(kCostModelFields), "Unknown cost model coefficient '", name, "'");
+    double value = 0;
+    ORT_RETURN_IF(!TryParseStringWithClassicLocale(entry.substr(separator + 1), value) || !(value >= 0),
+                  "Invalid value of the cost model coefficient '", name, "'");
+    parsed.*(field->member) = value;
+  }
+  ORT_RETURN_IF(!(parsed.per_thread_cycles > 0) || !(parsed.task_size_cycles > 0),
+                "per_thread_cycles and task_size_cycles must be positive");
+  cost_model = parsed;
+  return Status::OK();
+}
+
+std::string ThreadPool::CostModelToString(const ParallelForCostModel& cost_model) {
+  std::ostringstream ss;
+  ss.imbue(std::locale::classic());
+  for (const auto& field : kCostModelFields) {
+    if (&field != std::begin(kCostModelFields)) {
+      ss << ';';
+    }
+    ss << field.name << '=' << cost_model.*(field.member);
+  }
+  return ss.str();
+}
+
+ParallelForCostModel ThreadPool::CalibrateCostModel(ThreadPool* tp) {
+  static const MachineCosts machine_costs = MeasureMachineCosts();
+
+  ParallelForCostModel cost_model;
+  cost_model.load_cycles_per_byte = machine_costs.load_cycles_per_byte;
+  cost_model.store_cycles_per_byte = machine_costs.store_cycles_per_byte;
+  cost_model.cycles_per_compute_cycle = machine_costs.cycles_per_compute_cycle;
+
+  const int d_of_p = DegreeOfParallelism(tp);
+  if (tp == nullptr || tp->NumThreads() == 0 || d_of_p < 2) {
+    // the loops of the pool never run in parallel
+    return cost_model;
+  }
+
+  // The latency of empty loops with 2 blocks and with a block per thread. The first loops wake up the threads.
+  constexpr int kRepetitions = 21;
+  const std::function<void(std::ptrdiff_t)> empty_block = [](std::ptrdiff_t) {};
+  const double two_blocks_ns = MedianNanoseconds(kRepetitions, [tp, &empty_block]() {
+    tp->SimpleParallelFor(2, empty_block);
+  });
+  const double all_blocks_ns = MedianNanoseconds(kRepetitions, [tp, d_of_p, &empty_block]() {
+    tp->SimpleParallelFor(d_of_p, empty_block);
+  });
+
+  // the threads start concurrently, so a thread costs at least its share of the latency of a loop using all of them
+  double per_thread_ns = all_blocks_ns / d_of_p;
+  if (d_of_p > 2) {
+    per_thread_ns = std::max(per_thread_ns, (all_blocks_ns - two_blocks_ns) / (d_of_p - 2));
+  }
+  const double startup_ns = std::max(two_blocks_ns - 2 * per_thread_ns, 0.0);
+
+  const ParallelForCostModel defaults;
+  cost_model.per_thread_cycles = per_thread_ns / machine_costs.ns_per_cycle;
+  cost_model.startup_cycles = startup_ns / machine_costs.ns_per_cycle;
+  // keep the ratio between the size of a block and the overhead of a thread of the default model
+  cost_model.task_size_cycles =
+      cost_model.per_thread_cycles * defaults.task_size_cycles / defaults.per_thread_cycles;
+  return cost_model;
+}
+
+// When loops of several priority classes are running, a loop gets a share of the threads
+// proportional to the weight of its class, and at least the thread that started it.
+unsigned ThreadPool::FairShare(LoopPriority priority) const {
+  const unsigned num_threads_inc_main = static_cast<unsigned>(NumThreads()) + 1;
+  unsigned total_weight = 0;
+  int num_classes = 0;
+  for (int c = 0; c < kNumLoopPriorities; c++) {
+    const int num_loops = active_loops_[c].load(std::memory_order_relaxed);
+    if (num_loops > 0) {
+      total_weight += static_cast<unsigned>(num_loops) * kLoopPriorityWeights[c];
+      num_classes++;
+    }
+  }
+  if (num_classes <= 1) {
+    return num_threads_inc_main;
+  }
+  return std::max(1u, num_threads_inc_main * kLoopPriorityWeights[static_cast<int>(priority)] / total_weight);
+}
+
 // Base case for parallel loops, running iterations 0..total, divided into blocks
 // of block_size iterations, and calling into a function that takes a start..end
 // range of indices to run.
@@ -415,23 +690,33 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     return;
   }
 
+  // Helper threads (idx != 0) leave the loop once it exceeds its share of the threads, which they check every
+  // kBlocksPerFairShareCheck blocks.
+  const LoopPriority priority = CurrentLoopPriority();
+  ActiveLoopScope active_loop(active_loops_[static_cast<int>(priority)]);
+  const unsigned fair_share = FairShare(priority);
+
   auto d_of_p = DegreeOfParallelism(this);
   if (thread_options_.dynamic_block_base_ <= 0) {
     // Split the work across threads in the pool.  Each work item will run a loop claiming iterations,
     // hence we need at most one for each thread, even if the number of blocks of iterations is larger.
     auto num_blocks = total / block_size;
-    auto num_threads_inc_main = NumThreads() + 1;
+    auto num_threads_inc_main = std::min(NumThreads() + 1, static_cast<int>(fair_share));
     int num_work_items = static_cast<int>(std::min(static_cast<std::ptrdiff_t>(num_threads_inc_main), num_blocks));
     assert(num_work_items > 0);
 
     LoopCounter lc(total, d_of_p, block_size);
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
-      unsigned my_home_shard = lc.GetHomeShard(idx);
+      unsigned my_home_shard = lc.GetHomeShard(idx, CurrentNumaNode(), num_numa_nodes_);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
+      unsigned num_blocks_run = 0;
       while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
+        if (idx != 0 && ++num_blocks_run % kBlocksPerFairShareCheck == 0 && idx >= FairShare(priority)) {
+          break;
+        }
       }
     };
     // Run the work in the thread pool (and in the current thread).  Synchronization with helping
@@ -445,9 +730,10 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     LoopCounter lc(total, d_of_p, base_block_size);
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
       std::ptrdiff_t b = base_block_size;
-      unsigned my_home_shard = lc.GetHomeShard(idx);
+      unsigned my_home_shard = lc.GetHomeShard(idx, CurrentNumaNode(), num_numa_nodes_);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
+      unsigned num_blocks_run = 0;
       while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, b)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
@@ -455,11 +741,14 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
         if (b > 1) {
           b = static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(todo) / num_of_blocks)));
         }
+        if (idx != 0 && ++num_blocks_run % kBlocksPerFairShareCheck == 0 && idx >= FairShare(priority)) {
+          break;
+        }
       }
     };
     // Distribute task among all threads in the pool, reduce number of work items if 
     // num_of_blocks is smaller than number of threads.
-    RunInParallel(run_work, std::min(NumThreads() + 1, num_of_blocks), base_block_size);
+    RunInParallel(run_work, std::min({NumThreads() + 1, num_of_blocks, static_cast<int>(fair_share)}), base_block_size);
   }
 }
 
@@ -473,7 +762,17 @@ void ThreadPool::SimpleParallelFor(std::ptrdiff_t total, const std::function<voi
 
 void ThreadPool::Schedule(std::function<void()> fn) {
   if (underlying_threadpool_) {
-    underlying_threadpool_->Schedule(std::move(fn));
+    // The work starts its loops with the priority class of the thread that scheduled it, e.g. the nodes that the
+    // executors of a run schedule on the inter-op pool.
+    const LoopPriority priority = CurrentLoopPriority();
+    if (priority == LoopPriority::kNormal) {
+      underlying_threadpool_->Schedule(std::move(fn));
+    } else {
+      underlying_threadpool_->Schedule([priority, fn = std::move(fn)]() {
+        PriorityScope priority_scope(priority);
+        fn();
+      });
+    }
   } else {
     fn();
   }
@@ -549,16 +848,29 @@ bool ThreadPool::ShouldParallelizeLoop(const std::ptrdiff_t num_iterations,
   return true;
 }
 
-using CostModel = Eigen::TensorCostModel<Eigen::ThreadPoolDevice>;
+// The total cost of n units of work in cycles, as in Eigen::TensorCostModel::totalCost.
+static double TotalCost(double n, const TensorOpCost& cost, const ParallelForCostModel& model) {
+  return n * (cost.bytes_loaded * model.load_cycles_per_byte + cost.bytes_stored * model.store_cycles_per_byte +
+              cost.compute_cycles * model.cycles_per_compute_cycle);
+}
+
+// The number of threads worth using for n units of work, as in Eigen::TensorCostModel::numThreads.
+static int NumThreadsForCost(double n, const TensorOpCost& cost, int max_threads, const ParallelForCostModel& model) {
+  double threads = (TotalCost(n, cost, model) - model.startup_cycles) / model.per_thread_cycles + 0.9;
+  // Make sure we don't invoke undefined behavior when we convert to an int.
+  threads = std::min<double>(threads, std::numeric_limits<int>::max());
+  return std::min(max_threads, std::max<int>(1, static_cast<int>(threads)));
+}
 
 // Calculates block size based on (1) the iteration cost and (2) parallel
 // efficiency. We want blocks to be not too small to mitigate parallelization
 // overheads; not too large to mitigate tail effect and potential load
 // imbalance and we also want number of blocks to be evenly dividable across
 // threads.
-static ptrdiff_t CalculateParallelForBlock(const ptrdiff_t n, const Eigen::TensorOpCost& cost,
+static ptrdiff_t CalculateParallelForBlock(const ptrdiff_t n, const TensorOpCost& cost,
+                                           const ParallelForCostModel& model,
                                            std::function<ptrdiff_t(ptrdiff_t)> block_align, int num_threads) {
-  const double block_size_f = 1.0 / CostModel::taskSize(1, cost);
+  const double block_size_f = model.task_size_cycles / TotalCost(1, cost, model);
   constexpr ptrdiff_t max_oversharding_factor = 4;
   ptrdiff_t block_size = Eigen::numext::mini(
       n,
@@ -613,16 +925,15 @@ static ptrdiff_t CalculateParallelForBlock(const ptrdiff_t n, const Eigen::Tenso
 void ThreadPool::ParallelFor(std::ptrdiff_t n, const TensorOpCost& c,
                              const std::function<void(std::ptrdiff_t first, std::ptrdiff_t)>& f) {
   ORT_ENFORCE(n >= 0);
-  Eigen::TensorOpCost cost{c.bytes_loaded, c.bytes_stored, c.compute_cycles};
   auto d_of_p = DegreeOfParallelism(this);
   // Compute small problems directly in the caller thread.
   if ((!ShouldParallelizeLoop(n)) ||
-      CostModel::numThreads(static_cast<double>(n), cost, d_of_p) == 1) {
+      NumThreadsForCost(static_cast<double>(n), c, d_of_p, cost_model_) == 1) {
     f(0, n);
     return;
   }
 
-  ptrdiff_t block = CalculateParallelForBlock(n, cost, nullptr, d_of_p);
+  ptrdiff_t block = CalculateParallelForBlock(n, c, cost_model_, nullptr, d_of_p);
   ParallelForFixedBlockSizeScheduling(n, block, f);
 }
 
@@ -684,6 +995,16 @@ int ThreadPool::NumThreads() const {
   }
 }
 
+// Return the NUMA node of the current thread.  Threads outside the current pool
+// take the node of the main thread.
+int ThreadPool::CurrentNumaNode() const {
+  if (num_numa_nodes_ == 0) {
+    return -1;
+  }
+  // entry 0 belongs to the main thread, worker i is entry i + 1
+  return thread_options_.numa_nodes[static_cast<size_t>(CurrentThreadId() + 1)];
+}
+
 // Return ID of the current thread within this pool.  Returns -1 for a thread outside the
 // current pool.
 int ThreadPool::CurrentThreadId() const {
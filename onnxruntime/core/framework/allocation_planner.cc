@@ -1701,7 +1701,9 @@ class PlannerImpl {
             break;
           }
         }
-        if (is_all_consumer_same_stream) {
+        // with the dataflow executor the nodes of a stream may run out of order (see DataflowPlan),
+        // so the last consumer in the stream is not necessarily the last one to complete.
+        if (is_all_consumer_same_stream && !context_->IsDataflowExecutionEnabled()) {
           // all the consumers are on the same stream, so the first element is the last consumer int the stream.
           process_consumer(release_action_idx, value_consumers[i][0]);
         } else {
@@ -43,6 +43,10 @@ class ISequentialPlannerContext {
   // see PlannerImpl::ComputeReusePlan
   virtual bool IsParallelExecutionEnabled() const { return false; }
 
+  // If it returns true, the nodes of a stream may run out of order (see DataflowPlan), so the planner releases the
+  // values with several consumers by ref count.
+  virtual bool IsDataflowExecutionEnabled() const { return false; }
+
   virtual ExecutionOrder GetExecutionOrder() const { return ExecutionOrder::DEFAULT; }
 
   virtual bool GetEnableMemoryReuse() const { return true; }
@@ -51,10 +55,12 @@ class ISequentialPlannerContext {
 
 class SequentialPlannerContext : public ISequentialPlannerContext {
  public:
-  SequentialPlannerContext(ExecutionMode execution_mode, ExecutionOrder execution_order, bool enable_memory_reuse)
+  SequentialPlannerContext(ExecutionMode execution_mode, ExecutionOrder execution_order, bool enable_memory_reuse,
+                           bool enable_dataflow_execution = false)
       : execution_mode_(execution_mode),
         exection_order_(execution_order),
-        enable_memory_reuse_(enable_memory_reuse) {
+        enable_memory_reuse_(enable_memory_reuse),
+        enable_dataflow_execution_(enable_dataflow_execution) {
   }
 
   const ONNX_NAMESPACE::TensorShapeProto* GetShape(const onnxruntime::NodeArg& arg) const override {
@@ -63,6 +69,8 @@ class SequentialPlannerContext : public ISequentialPlannerContext {
 
   bool IsParallelExecutionEnabled() const override { return execution_mode_ == ExecutionMode::ORT_PARALLEL; }
 
+  bool IsDataflowExecutionEnabled() const override { return enable_dataflow_execution_; }
+
   ExecutionOrder GetExecutionOrder() const override { return exection_order_; }
 
   bool GetEnableMemoryReuse() const override { return enable_memory_reuse_; }
@@ -71,6 +79,7 @@ class SequentialPlannerContext : public ISequentialPlannerContext {
   ExecutionMode execution_mode_ = ExecutionMode::ORT_SEQUENTIAL;
   ExecutionOrder exection_order_ = ExecutionOrder::DEFAULT;
   bool enable_memory_reuse_ = true;
+  bool enable_dataflow_execution_ = false;
 };
 
 #ifdef ORT_ENABLE_STREAM
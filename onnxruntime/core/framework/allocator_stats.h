@@ -23,6 +23,12 @@ struct AllocatorStats {
                                   // unknown.
   int64_t bytes_limit;
 
+  // The thread cache of an arena (Relevant only for arena based allocators with a thread cache)
+  int64_t num_thread_cache_hits;       // Number of allocations served from a thread cache.
+  int64_t num_thread_cache_misses;     // Number of cacheable allocations that went to the arena.
+  int64_t num_thread_cache_releases;   // Number of blocks returned from the thread caches to the arena.
+  int64_t bytes_in_thread_caches;      // Number of bytes held by the thread caches, included in bytes_in_use.
+
   AllocatorStats() { Clear(); }
 
   void Clear() {
@@ -35,6 +41,10 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->num_thread_cache_hits = 0;
+    this->num_thread_cache_misses = 0;
+    this->num_thread_cache_releases = 0;
+    this->bytes_in_thread_caches = 0;
   }
 
   std::string DebugString() const {
@@ -47,7 +57,11 @@ struct AllocatorStats {
        << "NumReserves:              " << this->num_reserves << "\n"
        << "NumArenaExtensions:       " << this->num_arena_extensions << "\n"
        << "NumArenaShrinkages:       " << this->num_arena_shrinkages << "\n"
-       << "MaxAllocSize:             " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:             " << this->max_alloc_size << "\n"
+       << "NumThreadCacheHits:       " << this->num_thread_cache_hits << "\n"
+       << "NumThreadCacheMisses:     " << this->num_thread_cache_misses << "\n"
+       << "NumThreadCacheReleases:   " << this->num_thread_cache_releases << "\n"
+       << "InThreadCaches:           " << this->bytes_in_thread_caches << "\n";
     return ss.str();
   }
 };
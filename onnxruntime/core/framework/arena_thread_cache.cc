@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/arena_thread_cache.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace onnxruntime {
+
+ArenaThreadCache::ArenaThreadCache(size_t max_cached_bytes, AllocBlockFn alloc_block, FreeBlocksFn free_blocks)
+    : max_cached_bytes_per_cache_(max_cached_bytes / kNumCaches),
+      alloc_block_(std::move(alloc_block)),
+      free_blocks_(std::move(free_blocks)) {
+}
+
+size_t ArenaThreadCache::SizeClassIndex(size_t size) {
+  size = std::max(size, size_t{1} << kMinBlockBits);
+  size_t shift = kMinBlockBits;
+  while ((size_t{2} << shift) <= size) {
+    ++shift;
+  }
+  // the number of quarter steps above the power of two, up to 4 which is the first class of the next power
+  const size_t quarter_bits = shift - 2;
+  const size_t steps = ((size - (size_t{1} << shift)) + (size_t{1} << quarter_bits) - 1) >> quarter_bits;
+  return (shift - kMinBlockBits) * 4 + steps;
+}
+
+size_t ArenaThreadCache::SizeClassSize(size_t index) {
+  const size_t shift = kMinBlockBits + index / 4;
+  return (size_t{1} << shift) + (index % 4) * (size_t{1} << (shift - 2));
+}
+
+ArenaThreadCache::Cache& ArenaThreadCache::CurrentThreadCache() {
+  // Threads are numbered in the order they first use a cache, which spreads them evenly over the caches.
+  // Hashing std::thread::id doesn't: libc++ hashes it as the pthread_t address, which is aligned.
+  static std::atomic<size_t> next_thread_index{0};
+  thread_local const size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return caches_[thread_index % kNumCaches];
+}
+
+ArenaThreadCache::SizeMapShard& ArenaThreadCache::SizeMapShardFor(void* p) {
+  // the blocks are at least 256 bytes apart
+  return size_map_[(reinterpret_cast<uintptr_t>(p) >> kMinBlockBits) % kNumSizeMapShards];
+}
+
+void* ArenaThreadCache::Alloc(size_t size) {
+  const size_t index = SizeClassIndex(size);
+  {
+    Cache& cache = CurrentThreadCache();
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    ++cache.num_ops;
+    Magazine& magazine = cache.magazines[index];
+    if (!magazine.blocks.empty()) {
+      void* p = magazine.blocks.back();
+      magazine.blocks.pop_back();
+      magazine.low_water = std::min(magazine.low_water, magazine.blocks.size());
+      const size_t block_size = SizeClassSize(index);
+      cache.bytes -= block_size;
+      bytes_cached_.fetch_sub(static_cast<int64_t>(block_size), std::memory_order_relaxed);
+      num_hits_.fetch_add(1, std::memory_order_relaxed);
+      return p;
+    }
+  }
+
+  num_misses_.fetch_add(1, std::memory_order_relaxed);
+  void* p = alloc_block_(SizeClassSize(index));
+  if (p != nullptr) {
+    SizeMapShard& shard = SizeMapShardFor(p);
+    std::lock_guard<OrtMutex> lock(shard.mutex);
+    shard.size_classes[p] = static_cast<uint8_t>(index);
+  }
+  return p;
+}
+
+bool ArenaThreadCache::Free(void* p) {
+  size_t index;
+  {
+    SizeMapShard& shard = SizeMapShardFor(p);
+    std::lock_guard<OrtMutex> lock(shard.mutex);
+    auto it = shard.size_classes.find(p);
+    if (it == shard.size_classes.end()) {
+      return false;
+    }
+    index = it->second;
+  }
+
+  const size_t block_size = SizeClassSize(index);
+  std::vector<void*> released;
+  {
+    Cache& cache = CurrentThreadCache();
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    cache.magazines[index].blocks.push_back(p);
+    cache.bytes += block_size;
+    bytes_cached_.fetch_add(static_cast<int64_t>(block_size), std::memory_order_relaxed);
+
+    if (cache.bytes > max_cached_bytes_per_cache_) {
+      // the cache is full, trim the magazine of the block first and then the ones of the largest classes
+      TakeBlocks(cache, index, (cache.magazines[index].blocks.size() + 1) / 2, released);
+      for (size_t i = kNumSizeClasses; i-- > 0 && cache.bytes > max_cached_bytes_per_cache_;) {
+        TakeBlocks(cache, i, cache.magazines[i].blocks.size(), released);
+      }
+    }
+
+    if (++cache.num_ops >= kRebalanceInterval) {
+      // return the blocks that no allocation of this thread needed during the whole interval
+      for (size_t i = 0; i < kNumSizeClasses; ++i) {
+        Magazine& magazine = cache.magazines[i];
+        TakeBlocks(cache, i, std::min(magazine.low_water, magazine.blocks.size()), released);
+        magazine.low_water = magazine.blocks.size();
+      }
+      cache.num_ops = 0;
+    }
+  }
+
+  if (!released.empty()) {
+    ReleaseBlocks(released);
+  }
+  return true;
+}
+
+void ArenaThreadCache::TakeBlocks(Cache& cache, size_t index, size_t n, std::vector<void*>& released) {
+  if (n == 0) {
+    return;
+  }
+  Magazine& magazine = cache.magazines[index];
+  released.insert(released.end(), magazine.blocks.begin(), magazine.blocks.begin() + n);
+  magazine.blocks.erase(magazine.blocks.begin(), magazine.blocks.begin() + n);
+  magazine.low_water = std::min(magazine.low_water, magazine.blocks.size());
+  const size_t bytes = n * SizeClassSize(index);
+  cache.bytes -= bytes;
+  bytes_cached_.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+void ArenaThreadCache::ReleaseBlocks(const std::vector<void*>& blocks) {
+  // Forget the blocks before the arena can hand them out again, possibly to the caches of other threads.
+  for (void* p : blocks) {
+    SizeMapShard& shard = SizeMapShardFor(p);
+    std::lock_guard<OrtMutex> lock(shard.mutex);
+    shard.size_classes.erase(p);
+  }
+  num_releases_.fetch_add(static_cast<int64_t>(blocks.size()), std::memory_order_relaxed);
+  free_blocks_(blocks);
+}
+
+void ArenaThreadCache::ReleaseAll() {
+  std::vector<void*> released;
+  for (Cache& cache : caches_) {
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      TakeBlocks(cache, i, cache.magazines[i].blocks.size(), released);
+    }
+  }
+  if (!released.empty()) {
+    ReleaseBlocks(released);
+  }
+}
+
+void ArenaThreadCache::UpdateStats(AllocatorStats& stats) const {
+  stats.num_thread_cache_hits = num_hits_.load(std::memory_order_relaxed);
+  stats.num_thread_cache_misses = num_misses_.load(std::memory_order_relaxed);
+  stats.num_thread_cache_releases = num_releases_.load(std::memory_order_relaxed);
+  stats.bytes_in_thread_caches = bytes_cached_.load(std::memory_order_relaxed);
+  // the arena doesn't count allocations served from the caches
+  stats.num_allocs += stats.num_thread_cache_hits;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/gsl.h"
+#include "core/common/inlined_containers.h"
+#include "core/framework/allocator_stats.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+// A front end of an arena that caches freed blocks per thread, in the style of the magazines of tcmalloc.
+//
+// Requests of up to kMaxBlockSize bytes are rounded up to a size class. A freed block is kept in the magazine of its
+// size class in the cache of the freeing thread, and handed out again by the next allocation of that class on the
+// thread, so the arena and its lock are only involved when a magazine is empty or the cache is full.
+// The caches are striped by thread: threads are numbered as they first use a cache, and only share one, and its lock,
+// if there are more threads than caches.
+//
+// Every kRebalanceInterval operations on a cache, the blocks of each magazine that stayed unused during the whole
+// interval are returned to the arena, where the other threads can allocate them.
+class ArenaThreadCache {
+ public:
+  // Allocates a block from the arena. Throws if the arena is out of memory.
+  using AllocBlockFn = std::function<void*(size_t)>;
+  // Returns blocks to the arena.
+  using FreeBlocksFn = std::function<void(gsl::span<void* const>)>;
+
+  static constexpr size_t kMinBlockBits = 8;
+  static constexpr size_t kMaxBlockBits = 20;
+  static constexpr size_t kMaxBlockSize = size_t{1} << kMaxBlockBits;
+  // four size classes per power of two, which bounds the rounding overhead to 25%
+  static constexpr size_t kNumSizeClasses = (kMaxBlockBits - kMinBlockBits) * 4 + 1;
+  static constexpr size_t kNumCaches = 64;
+  static constexpr size_t kRebalanceInterval = 4096;
+
+  // max_cached_bytes bounds the total size of the blocks held by all the caches.
+  ArenaThreadCache(size_t max_cached_bytes, AllocBlockFn alloc_block, FreeBlocksFn free_blocks);
+
+  static bool IsCacheable(size_t size) { return size != 0 && size <= kMaxBlockSize; }
+
+  // Allocates a block of at least size bytes, which must be cacheable.
+  void* Alloc(size_t size);
+
+  // Caches the block p if it was allocated by Alloc(). Returns false otherwise, in which case the caller frees it.
+  bool Free(void* p);
+
+  // Returns all the cached blocks to the arena.
+  void ReleaseAll();
+
+  // Adds the statistics of the caches to stats.
+  void UpdateStats(AllocatorStats& stats) const;
+
+  static size_t SizeClassIndex(size_t size);
+  static size_t SizeClassSize(size_t index);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ArenaThreadCache);
+
+  struct Magazine {
+    // the most recently freed block is at the back
+    std::vector<void*> blocks;
+    // the smallest number of blocks since the last rebalance, i.e. the number of blocks that stayed unused
+    size_t low_water{0};
+  };
+
+  struct Cache {
+    OrtMutex mutex;
+    std::array<Magazine, kNumSizeClasses> magazines;
+    size_t bytes{0};
+    size_t num_ops{0};
+  };
+
+  // The size classes of the blocks owned by the caches, whether they are cached or in use.
+  // Sharded by address so that concurrent frees of different blocks rarely share a lock.
+  struct SizeMapShard {
+    OrtMutex mutex;
+    InlinedHashMap<void*, uint8_t> size_classes;
+  };
+  static constexpr size_t kNumSizeMapShards = 64;
+
+  Cache& CurrentThreadCache();
+  SizeMapShard& SizeMapShardFor(void* p);
+
+  // Moves the n least recently freed blocks of magazine `index` of cache to released. cache.mutex must be held.
+  void TakeBlocks(Cache& cache, size_t index, size_t n, std::vector<void*>& released);
+  // Returns blocks taken from the caches to the arena.
+  void ReleaseBlocks(const std::vector<void*>& blocks);
+
+  const size_t max_cached_bytes_per_cache_;
+  AllocBlockFn alloc_block_;
+  FreeBlocksFn free_blocks_;
+
+  std::array<Cache, kNumCaches> caches_;
+  std::array<SizeMapShard, kNumSizeMapShards> size_map_;
+
+  std::atomic<int64_t> num_hits_{0};
+  std::atomic<int64_t> num_misses_{0};
+  std::atomic<int64_t> num_releases_{0};
+  std::atomic<int64_t> bytes_cached_{0};
+};
+
+}  // namespace onnxruntime
@@ -11,7 +11,8 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                    ArenaExtendStrategy arena_extend_strategy,
                    int initial_chunk_size_bytes,
                    int max_dead_bytes_per_chunk,
-                   int initial_growth_chunk_size_bytes)
+                   int initial_growth_chunk_size_bytes,
+                   size_t max_thread_cache_bytes)
     : IAllocator(OrtMemoryInfo(resource_allocator->Info().name,
                                OrtAllocatorType::OrtArenaAllocator,
                                resource_allocator->Info().device,
@@ -29,7 +30,15 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                      << " max_dead_bytes_per_chunk: " << max_dead_bytes_per_chunk_
                      << " initial_growth_chunk_size_bytes: " << initial_growth_chunk_size_bytes_
                      << " memory limit: " << total_memory
-                     << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy);
+                     << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy)
+                     << " max_thread_cache_bytes: " << max_thread_cache_bytes;
+
+  if (max_thread_cache_bytes != 0) {
+    thread_cache_ = std::make_unique<ArenaThreadCache>(
+        max_thread_cache_bytes,
+        [this](size_t size) { return AllocateRawInternal(size, false, nullptr, false, nullptr); },
+        [this](gsl::span<void* const> blocks) { FreeBlocks(blocks); });
+  }
 
   // static_cast<std::underlying_type_t<ArenaExtendStrategy>>(arena_extend_strategy); doesn't work on this compiler
 
@@ -261,6 +270,9 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
 }
 
 void* BFCArena::Alloc(size_t size) {
+  if (thread_cache_ && ArenaThreadCache::IsCacheable(size)) {
+    return thread_cache_->Alloc(size);
+  }
   return AllocateRawInternal(size, false, nullptr, false, nullptr);
 }
 
@@ -369,8 +381,13 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 }
 
 void BFCArena::GetStats(AllocatorStats* stats) {
-  std::lock_guard<OrtMutex> lock(lock_);
-  *stats = stats_;
+  {
+    std::lock_guard<OrtMutex> lock(lock_);
+    *stats = stats_;
+  }
+  if (thread_cache_) {
+    thread_cache_->UpdateStats(*stats);
+  }
 }
 
 BFCArena::Chunk* BFCArena::SplitFreeChunkFromBin(BFCArena::Bin::FreeChunkSet* free_chunks,
@@ -488,6 +505,9 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
+  if (thread_cache_ && thread_cache_->Free(p)) {
+    return;
+  }
   std::lock_guard<OrtMutex> lock(lock_);
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
@@ -500,7 +520,18 @@ void BFCArena::Free(void* p) {
   }
 }
 
+void BFCArena::FreeBlocks(gsl::span<void* const> blocks) {
+  std::lock_guard<OrtMutex> lock(lock_);
+  for (void* p : blocks) {
+    DeallocateRawInternal(p);
+  }
+}
+
 Status BFCArena::Shrink() {
+  if (thread_cache_) {
+    // the cached blocks would keep their regions alive
+    thread_cache_->ReleaseAll();
+  }
   std::lock_guard<OrtMutex> lock(lock_);
   auto num_regions = region_manager_.regions().size();
   std::vector<void*> region_ptrs;
@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "core/platform/ort_mutex.h"
 #include "core/framework/arena_extend_strategy.h"
+#include "core/framework/arena_thread_cache.h"
 #include "core/framework/allocator.h"
 
 #include "core/framework/stream_handles.h"
@@ -66,12 +67,15 @@ class BFCArena : public IAllocator {
     StreamAwareArena,
   };
 
+  // If max_thread_cache_bytes is not 0, freed blocks of up to ArenaThreadCache::kMaxBlockSize bytes are cached per
+  // thread up to that total size, so that the allocations and frees of concurrent threads rarely take the arena lock.
   BFCArena(std::unique_ptr<IAllocator> resource_allocator,
            size_t total_memory,
            ArenaExtendStrategy arena_extend_strategy = DEFAULT_ARENA_EXTEND_STRATEGY,
            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
-           int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES);
+           int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
+           size_t max_thread_cache_bytes = 0);
 
   ~BFCArena() override;
 
@@ -83,7 +87,7 @@ class BFCArena : public IAllocator {
   // If p is NULL, no operation is performed.
   void Free(void* p) override;
 
-  // Frees all allocation regions in which no chunk is in use.
+  // Frees all allocation regions in which no chunk is in use, after returning the blocks of the thread caches.
   // Does not free any reserved chunks.
   // Resets the size that the arena will grow by in the next allocation to
   // `initial_growth_chunk_size_bytes_` but ultimately all
@@ -122,6 +126,9 @@ class BFCArena : public IAllocator {
  private:
   void DeallocateRawInternal(void* ptr);
 
+  // Returns blocks released by the thread caches to the bins.
+  void FreeBlocks(gsl::span<void* const> blocks);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   using ChunkHandle = size_t;
@@ -503,6 +510,9 @@ class BFCArena : public IAllocator {
 
   std::unordered_map<void*, size_t> reserved_chunks_;
 
+  // The front end caching freed blocks per thread, if enabled.
+  std::unique_ptr<ArenaThreadCache> thread_cache_;
+
   const int initial_chunk_size_bytes_;
   const int max_dead_bytes_per_chunk_;
   const int initial_growth_chunk_size_bytes_;
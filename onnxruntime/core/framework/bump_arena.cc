@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/bump_arena.h"
+
+#include <algorithm>
+
+#include "core/common/safeint.h"
+
+namespace onnxruntime {
+
+namespace {
+
+// The arena reports the memory of the wrapped allocator as device memory even if that is a BFCArena, since the callers
+// that find an OrtArenaAllocator cast it to a BFCArena.
+OrtMemoryInfo BumpArenaMemoryInfo(const OrtMemoryInfo& device_info) {
+  return OrtMemoryInfo(device_info.name, OrtAllocatorType::OrtDeviceAllocator, device_info.device, device_info.id,
+                       device_info.mem_type);
+}
+
+}  // namespace
+
+BumpArena::BumpArena(AllocatorPtr device_allocator, size_t initial_chunk_size_bytes)
+    : IAllocator(BumpArenaMemoryInfo(device_allocator->Info())),
+      device_allocator_(std::move(device_allocator)),
+      next_chunk_size_(std::max<size_t>(initial_chunk_size_bytes, kAllocAlignment)) {
+}
+
+BumpArena::~BumpArena() {
+  for (const auto& chunk : chunks_) {
+    device_allocator_->Free(chunk.data);
+  }
+}
+
+void* BumpArena::Alloc(size_t size) {
+  // keep every allocation kAllocAlignment-byte aligned, like the memory patterns do
+  const size_t padded_size = SafeInt<size_t>(std::max<size_t>(size, 1)) + (kAllocAlignment - 1);
+  const size_t aligned_size = padded_size & ~(kAllocAlignment - 1);
+
+  std::lock_guard<OrtMutex> lock(lock_);
+  if (chunks_.empty() || chunks_.back().size - offset_ < aligned_size) {
+    const size_t chunk_size = std::max(next_chunk_size_, aligned_size);
+    char* data = static_cast<char*>(device_allocator_->Alloc(chunk_size));
+    ORT_ENFORCE(data != nullptr, "BumpArena failed to allocate a chunk of ", chunk_size, " bytes.");
+    chunks_.push_back({data, chunk_size});
+    prev_chunks_bytes_in_use_ += offset_;
+    offset_ = 0;
+    next_chunk_size_ = SafeInt<size_t>(chunk_size) * 2;
+    total_chunk_size_ += chunk_size;
+    peak_total_chunk_size_ = std::max(peak_total_chunk_size_, total_chunk_size_);
+
+    stats_.num_arena_extensions++;
+    stats_.total_allocated_bytes += static_cast<int64_t>(chunk_size);
+  }
+
+  last_alloc_offset_ = offset_;
+  last_alloc_ = chunks_.back().data + offset_;
+  offset_ += aligned_size;
+  num_live_allocs_++;
+
+  stats_.num_allocs++;
+  stats_.max_alloc_size = std::max<int64_t>(stats_.max_alloc_size, static_cast<int64_t>(size));
+  stats_.bytes_in_use = static_cast<int64_t>(prev_chunks_bytes_in_use_ + offset_);
+  stats_.max_bytes_in_use = std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
+  return last_alloc_;
+}
+
+void BumpArena::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+
+  std::lock_guard<OrtMutex> lock(lock_);
+  ORT_ENFORCE(num_live_allocs_ > 0, "BumpArena::Free called without a matching allocation.");
+  if (--num_live_allocs_ == 0) {
+    // Nothing is alive anymore, start over in the last chunk, which is the largest one.
+    for (size_t i = 0; i + 1 < chunks_.size(); ++i) {
+      device_allocator_->Free(chunks_[i].data);
+      total_chunk_size_ -= chunks_[i].size;
+      stats_.num_arena_shrinkages++;
+      stats_.total_allocated_bytes -= static_cast<int64_t>(chunks_[i].size);
+    }
+    chunks_.erase(chunks_.begin(), chunks_.end() - 1);
+    prev_chunks_bytes_in_use_ = 0;
+    offset_ = 0;
+    last_alloc_ = nullptr;
+  } else if (p == last_alloc_) {
+    offset_ = last_alloc_offset_;
+    last_alloc_ = nullptr;
+  }
+  stats_.bytes_in_use = static_cast<int64_t>(prev_chunks_bytes_in_use_ + offset_);
+}
+
+void BumpArena::GetStats(AllocatorStats* stats) {
+  std::lock_guard<OrtMutex> lock(lock_);
+  *stats = stats_;
+}
+
+size_t BumpArena::PeakTotalChunkSize() const {
+  std::lock_guard<OrtMutex> lock(lock_);
+  return peak_total_chunk_size_;
+}
+
+}  // namespace onnxruntime
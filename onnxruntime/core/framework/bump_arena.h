@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+// A linear allocator for the intermediate tensors of a single run.
+//
+// Allocations are carved out of large chunks obtained from the device allocator by bumping an offset, and all the
+// chunks are returned to the device allocator at once when the arena is destroyed. Tensors hold a reference to their
+// allocator, so the arena lives until the last tensor allocated from it is released.
+// Free() only reclaims memory if it releases the latest allocation, or if no allocation is alive anymore, in which
+// case the next allocations reuse the current chunk from its start.
+//
+// The arena is only used by the execution frame of a run, so its lock is not contended across concurrent runs, unlike
+// the lock of the shared BFCArena.
+// Its memory info is the one of the device allocator, with the allocator type OrtDeviceAllocator, as it isn't a
+// BFCArena.
+class BumpArena : public IAllocator {
+ public:
+  static constexpr size_t DEFAULT_INITIAL_CHUNK_SIZE_BYTES = 1024 * 1024;
+
+  BumpArena(AllocatorPtr device_allocator, size_t initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES);
+
+  ~BumpArena() override;
+
+  void* Alloc(size_t size) override;
+  void Free(void* p) override;
+
+  void GetStats(AllocatorStats* stats) override;
+
+  // The largest total size of the chunks held at once. A single chunk of this size fits all the allocations of a
+  // similar run.
+  size_t PeakTotalChunkSize() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(BumpArena);
+
+  struct Chunk {
+    char* data;
+    size_t size;
+  };
+
+  AllocatorPtr device_allocator_;
+  size_t next_chunk_size_;
+
+  mutable OrtMutex lock_;
+  std::vector<Chunk> chunks_;
+  // the offset of the next allocation in the last chunk
+  size_t offset_{0};
+  // the bytes allocated from the chunks before the last one, which are only reclaimed once no allocation is alive
+  size_t prev_chunks_bytes_in_use_{0};
+  // the offset of the latest allocation in the last chunk, which Free() can roll back
+  size_t last_alloc_offset_{0};
+  void* last_alloc_{nullptr};
+  size_t num_live_allocs_{0};
+  size_t total_chunk_size_{0};
+  size_t peak_total_chunk_size_{0};
+  AllocatorStats stats_;
+};
+
+}  // namespace onnxruntime
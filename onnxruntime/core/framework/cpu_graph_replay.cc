@@ -0,0 +1,302 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/cpu_graph_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "core/framework/execution_frame.h"
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/sequential_execution_plan.h"
+#include "core/framework/session_state.h"
+#include "core/framework/tensor.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+
+namespace {
+
+void CopyTensorData(const Tensor& src, Tensor& dst) {
+  if (src.IsDataTypeString()) {
+    const auto src_span = src.DataAsSpan<std::string>();
+    std::copy(src_span.begin(), src_span.end(), dst.MutableData<std::string>());
+  } else if (src.SizeInBytes() > 0 && src.DataRaw() != dst.DataRaw()) {
+    memcpy(dst.MutableDataRaw(), src.DataRaw(), src.SizeInBytes());
+  }
+}
+
+bool IsCpuTensor(const OrtValue& value) {
+  return value.IsTensor() && value.Get<Tensor>().Location().device.Type() == OrtDevice::CPU;
+}
+
+bool IsStaticTensor(const NodeArg& node_arg) {
+  const auto* type = node_arg.TypeAsProto();
+  const auto* shape = node_arg.Shape();
+  return type != nullptr && type->has_tensor_type() && shape != nullptr &&
+         std::all_of(shape->dim().begin(), shape->dim().end(),
+                     [](const ONNX_NAMESPACE::TensorShapeProto_Dimension& dim) { return dim.has_dim_value(); });
+}
+
+}  // namespace
+
+CpuGraphReplay::CpuGraphReplay(const SessionState& session_state) : session_state_(session_state) {
+}
+
+// the frame holds values allocated by the allocators of the session state, which outlives this
+CpuGraphReplay::~CpuGraphReplay() = default;
+
+bool CpuGraphReplay::IsCaptured() const {
+  return captured_.load(std::memory_order_acquire);
+}
+
+void CpuGraphReplay::OnRegularRun(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                  gsl::span<const std::string> output_names) {
+  // Nothing to record once the graph is captured or can't be. Otherwise a concurrent run may hold the mutex for a
+  // whole capture or replay, skip the recording rather than waiting for it.
+  if (captured_.load(std::memory_order_acquire) || capture_disabled_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::unique_lock<OrtMutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || frame_ != nullptr || capture_disabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  has_signature_ = false;
+  if (!std::all_of(feeds.begin(), feeds.end(), IsCpuTensor)) {
+    return;
+  }
+
+  feed_names_.assign(feed_names.begin(), feed_names.end());
+  output_names_.assign(output_names.begin(), output_names.end());
+  feed_infos_.clear();
+  for (const auto& feed : feeds) {
+    const auto& tensor = feed.Get<Tensor>();
+    feed_infos_.push_back({tensor.DataType(), tensor.Shape()});
+  }
+  has_signature_ = true;
+}
+
+bool CpuGraphReplay::MatchesSignature(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                      gsl::span<const std::string> output_names) const {
+  if (!has_signature_ || feed_names.size() != feed_names_.size() || feeds.size() != feed_infos_.size() ||
+      !std::equal(feed_names.begin(), feed_names.end(), feed_names_.begin()) ||
+      !std::equal(output_names.begin(), output_names.end(), output_names_.begin(), output_names_.end())) {
+    return false;
+  }
+
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    if (!IsCpuTensor(feeds[i])) {
+      return false;
+    }
+    const auto& tensor = feeds[i].Get<Tensor>();
+    if (tensor.DataType() != feed_infos_[i].data_type || tensor.Shape() != feed_infos_[i].shape) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status CpuGraphReplay::Capture(gsl::span<const OrtValue> feeds, gsl::span<const std::string> feed_names,
+                               gsl::span<const std::string> output_names, const logging::Logger& logger,
+                               bool& captured) {
+  captured = false;
+
+  // The kernels of a plan with a single stream run in the order of its steps, which are all kernel launches.
+  const auto& plan = *session_state_.GetExecutionPlan();
+  const SequentialExecutionPlan::LogicStream* stream = nullptr;
+  for (const auto& logic_stream : plan.execution_plan) {
+    if (logic_stream && !logic_stream->steps_.empty()) {
+      if (stream != nullptr) {
+        LOGS(logger, INFO) << "The CPU graph can't be captured as the execution plan has several streams.";
+        return Status::OK();
+      }
+      stream = logic_stream.get();
+    }
+  }
+  const auto& graph_viewer = session_state_.GetGraphViewer();
+  if (stream == nullptr || stream->steps_.size() != static_cast<size_t>(graph_viewer.NumberOfNodes())) {
+    LOGS(logger, INFO) << "The CPU graph can't be captured as the execution plan has synchronization steps.";
+    return Status::OK();
+  }
+
+  for (const auto& name : output_names) {
+    const auto* node_arg = graph_viewer.GetNodeArg(name);
+    if (node_arg == nullptr || !IsStaticTensor(*node_arg)) {
+      LOGS(logger, INFO) << "The CPU graph can't be captured as the output " << name
+                         << " is not a tensor with a static shape.";
+      return Status::OK();
+    }
+  }
+
+  // A replay finds the values of the previous one allocated: a kernel can't allocate an output of another shape, and
+  // a sequence would keep its previous content. So every value the kernels produce must be a tensor whose shape
+  // inference found to be the same for every run.
+  for (const auto& node : graph_viewer.Nodes()) {
+    for (const auto* output : node.OutputDefs()) {
+      if (output->Exists() && !IsStaticTensor(*output)) {
+        LOGS(logger, INFO) << "The CPU graph can't be captured as the value " << output->Name() << " of node "
+                           << node.Name() << " is not a tensor with a static shape.";
+        return Status::OK();
+      }
+    }
+  }
+
+  std::vector<const OpKernel*> kernels;
+  kernels.reserve(stream->steps_.size());
+  for (const auto& step : stream->steps_) {
+    const auto* kernel = session_state_.GetKernel(step->GetNodeIndex());
+    ORT_RETURN_IF(kernel == nullptr, "No kernel for node ", step->GetNodeIndex());
+    kernels.push_back(kernel);
+  }
+
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager;
+  ORT_RETURN_IF_ERROR(FeedsFetchesManager::Create(feed_names, output_names, session_state_.GetOrtValueNameIdxMap(),
+                                                  feeds_fetches_manager));
+  const auto& info = feeds_fetches_manager->GetFeedsFetchesInfo();
+
+  // the frame reads the inputs from tensors of its own, so the caller can release or reuse the buffers of its inputs
+  captured_feeds_.clear();
+  captured_feeds_.resize(feeds.size());
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    const auto& tensor = feeds[i].Get<Tensor>();
+    auto allocator = session_state_.GetAllocator(tensor.Location().device);
+    ORT_RETURN_IF(allocator == nullptr, "No allocator for the input ", feed_names[i]);
+    Tensor::InitOrtValue(tensor.DataType(), tensor.Shape(), std::move(allocator), captured_feeds_[i]);
+  }
+
+  // The frame allocates the outputs as well. It allocates from the memory pattern of the inputs if the previous run
+  // traced it.
+  frame_ = std::make_unique<ExecutionFrame>(info.feeds_mlvalue_idxs, captured_feeds_, info.fetches_mlvalue_idxs,
+                                            gsl::span<const OrtValue>(), fetch_allocators_, session_state_,
+                                            gsl::span<Stream*>());
+  kernels_ = std::move(kernels);
+  captured_.store(true, std::memory_order_release);
+  captured = true;
+  LOGS(logger, INFO) << "Captured the CPU graph with " << kernels_.size() << " kernels.";
+  return Status::OK();
+}
+
+Status CpuGraphReplay::ExecuteKernels(const bool& terminate_flag, const logging::Logger& logger) {
+  NodeLatencyHistograms* histograms = session_state_.GetNodeLatencyHistograms();
+  for (const OpKernel* kernel : kernels_) {
+    if (terminate_flag) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+    }
+
+    // the outputs of the kernel are still allocated from the previous replay, Output() returns them
+    OpKernelContextInternal kernel_ctx(session_state_, *frame_, *kernel, logger, terminate_flag, nullptr);
+    Status status;
+    const TimePoint begin_time = histograms != nullptr ? std::chrono::high_resolution_clock::now() : TimePoint();
+    ORT_TRY {
+      status = kernel->Compute(&kernel_ctx);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+    if (histograms != nullptr) {
+      const auto latency = std::chrono::high_resolution_clock::now() - begin_time;
+      histograms->Record(kernel->Node().Index(),
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+    if (!status.IsOK()) {
+      const auto& node = kernel->Node();
+      return ORT_MAKE_STATUS(ONNXRUNTIME, status.Code(), "Non-zero status code returned while replaying ",
+                             node.OpType(), " node. Name:'", node.Name(), "' Status Message: ", status.ErrorMessage());
+    }
+  }
+  return Status::OK();
+}
+
+Status CpuGraphReplay::CopyOutputs(std::vector<OrtValue>& fetches) const {
+  std::vector<OrtValue> frame_fetches;
+  ORT_RETURN_IF_ERROR(frame_->GetOutputs(frame_fetches));
+
+  if (fetches.empty()) {
+    fetches.resize(frame_fetches.size());
+  }
+  ORT_RETURN_IF(fetches.size() != frame_fetches.size(), "Expected ", frame_fetches.size(), " outputs but got ",
+                fetches.size());
+
+  for (size_t i = 0; i < frame_fetches.size(); ++i) {
+    const auto& src = frame_fetches[i].Get<Tensor>();
+    if (!fetches[i].IsAllocated()) {
+      auto allocator = session_state_.GetAllocator(src.Location().device);
+      ORT_RETURN_IF(allocator == nullptr, "No allocator for the output ", output_names_[i]);
+      Tensor::InitOrtValue(src.DataType(), src.Shape(), std::move(allocator), fetches[i]);
+    }
+
+    ORT_RETURN_IF(!IsCpuTensor(fetches[i]), "The pre-allocated output ", output_names_[i],
+                  " must be a CPU tensor to replay the CPU graph.");
+    auto& dst = *fetches[i].GetMutable<Tensor>();
+    ORT_RETURN_IF(dst.DataType() != src.DataType() || dst.Shape() != src.Shape(),
+                  "The pre-allocated output ", output_names_[i], " has shape ", dst.Shape(), " instead of ",
+                  src.Shape());
+    CopyTensorData(src, dst);
+  }
+  return Status::OK();
+}
+
+void CpuGraphReplay::Reset() {
+  captured_.store(false, std::memory_order_release);
+  frame_.reset();
+  kernels_.clear();
+  captured_feeds_.clear();
+}
+
+Status CpuGraphReplay::Run(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                           gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches,
+                           const bool& terminate_flag, const logging::Logger& logger, bool& executed) {
+  executed = false;
+
+  // a concurrent run is replaying the graph, run as usual rather than waiting for it
+  std::unique_lock<OrtMutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || capture_disabled_.load(std::memory_order_relaxed) ||
+      !MatchesSignature(feed_names, feeds, output_names)) {
+    return Status::OK();
+  }
+
+  if (frame_ == nullptr) {
+    bool captured = false;
+    Status status = Capture(feeds, feed_names, output_names, logger, captured);
+    if (!status.IsOK() || !captured) {
+      LOGS(logger, WARNING) << "Disabling the CPU graph capture. " << status.ErrorMessage();
+      Reset();
+      capture_disabled_.store(true, std::memory_order_release);
+      return Status::OK();
+    }
+  }
+
+  executed = true;
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    CopyTensorData(feeds[i].Get<Tensor>(), *captured_feeds_[i].GetMutable<Tensor>());
+  }
+
+  Status status = ExecuteKernels(terminate_flag, logger);
+  std::vector<OrtValue> replay_fetches = fetches;
+  if (status.IsOK()) {
+    status = CopyOutputs(replay_fetches);
+  }
+  if (!status.IsOK()) {
+    // the frame may be partially updated
+    Reset();
+    if (terminate_flag) {
+      return status;
+    }
+
+    // E.g. a kernel found its output allocated with the shape of the previous replay. Run the model as usual, which
+    // reports the error if there is one, and don't capture the graph again as the next replay could fail the same way.
+    LOGS(logger, WARNING) << "Disabling the CPU graph capture as the replay failed. " << status.ErrorMessage();
+    capture_disabled_.store(true, std::memory_order_release);
+    executed = false;
+    return Status::OK();
+  }
+  fetches = std::move(replay_fetches);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/gsl.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/iexecutor.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/tensor_shape.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+class ExecutionFrame;
+class OpKernel;
+class SessionState;
+
+// Captures a run of a model whose nodes are all assigned to the CPU execution provider and replays it.
+//
+// The capture keeps the execution frame of a run alive, with every intermediate value still allocated, and records
+// the kernels of the execution plan as a flat list. A replay copies the inputs into the captured input tensors and
+// calls Compute() on every kernel in order, which finds its outputs already allocated. It skips the construction of
+// the frame, the allocation and release of the intermediate values, and the interpretation of the execution plan.
+// The outputs are copied out of the frame, so they are not overwritten by the next replay.
+//
+// A graph is captured for the input names, types and shapes of a previous regular run, which traced the memory
+// pattern that the frame of the capture allocates from. Runs with other inputs, and concurrent runs while a replay is
+// in progress, fall back to regular runs. Neither they nor OnRegularRun() wait for the replay.
+//
+// Only graphs whose values are all tensors with static inferred shapes are captured, as the kernels can't reallocate
+// their outputs on a replay. If a replay fails anyway, e.g. a kernel whose output shape depends on the data finds its
+// output allocated with another shape, the run falls back to a regular run and the capture is disabled.
+class CpuGraphReplay {
+ public:
+  explicit CpuGraphReplay(const SessionState& session_state);
+  ~CpuGraphReplay();
+
+  // Records the inputs of a successful regular run, which the next run with the same inputs captures.
+  void OnRegularRun(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                    gsl::span<const std::string> output_names);
+
+  // Runs the model by replaying the captured graph, or by capturing it. executed is false if the caller must run
+  // the model as usual instead.
+  Status Run(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+             gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches,
+             const bool& terminate_flag, const logging::Logger& logger, bool& executed);
+
+  bool IsCaptured() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(CpuGraphReplay);
+
+  struct FeedInfo {
+    MLDataType data_type;
+    TensorShape shape;
+  };
+
+  // Whether feeds and outputs are the ones of the signature. mutex_ must be held.
+  bool MatchesSignature(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                        gsl::span<const std::string> output_names) const;
+
+  Status Capture(gsl::span<const OrtValue> feeds, gsl::span<const std::string> feed_names,
+                 gsl::span<const std::string> output_names, const logging::Logger& logger, bool& captured);
+  Status ExecuteKernels(const bool& terminate_flag, const logging::Logger& logger);
+  Status CopyOutputs(std::vector<OrtValue>& fetches) const;
+  void Reset();
+
+  const SessionState& session_state_;
+
+  mutable OrtMutex mutex_;
+  // the inputs and outputs of the last regular run, or of the captured graph
+  std::vector<std::string> feed_names_;
+  std::vector<FeedInfo> feed_infos_;
+  std::vector<std::string> output_names_;
+  bool has_signature_{false};
+  // Written with mutex_ held, and read without it so OnRegularRun() and IsCaptured() don't wait for a replay.
+  // frame_ holds a captured graph
+  std::atomic<bool> captured_{false};
+  // the capture failed or the plan can't be replayed, don't try again
+  std::atomic<bool> capture_disabled_{false};
+
+  // the tensors the frame reads the inputs from
+  std::vector<OrtValue> captured_feeds_;
+  std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators_;
+  std::unique_ptr<ExecutionFrame> frame_;
+  std::vector<const OpKernel*> kernels_;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/dataflow_executor.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/sequential_execution_plan.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/stream_execution_context.h"
+#include "core/graph/graph_viewer.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+Status DataflowPlan::Create(const SequentialExecutionPlan& plan, const GraphViewer& graph_viewer,
+                            std::unique_ptr<DataflowPlan>& dataflow_plan) {
+  dataflow_plan.reset();
+  const size_t num_streams = plan.NumberOfValidStreams();
+  ORT_RETURN_IF(num_streams != 1, "The execution plan has ", num_streams, " logic streams.");
+  ORT_RETURN_IF(!plan.notification_owners.empty() || plan.num_barriers != 0,
+                "The execution plan has synchronization steps.");
+
+  size_t stream_idx = 0;
+  while (plan.execution_plan[stream_idx]->steps_.empty()) {
+    ++stream_idx;
+  }
+
+  // Without notifications and barriers the only steps of a single stream are kernel launches, one per node.
+  const auto& steps = plan.execution_plan[stream_idx]->steps_;
+  ORT_RETURN_IF(steps.size() != static_cast<size_t>(graph_viewer.NumberOfNodes()), "The execution plan has ",
+                steps.size(), " steps for ", graph_viewer.NumberOfNodes(), " nodes.");
+
+  auto new_plan = std::make_unique<DataflowPlan>();
+  new_plan->stream_idx = stream_idx;
+
+  const size_t num_tasks = steps.size();
+  constexpr size_t kNoTask = std::numeric_limits<size_t>::max();
+  std::vector<size_t> node_to_task(graph_viewer.MaxNodeIndex(), kNoTask);
+  new_plan->nodes.reserve(num_tasks);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    const NodeIndex node_index = steps[i]->GetNodeIndex();
+    ORT_RETURN_IF(node_index >= node_to_task.size() || node_to_task[node_index] != kNoTask,
+                  "The execution plan doesn't launch the node ", node_index, " exactly once.");
+    node_to_task[node_index] = i;
+    new_plan->nodes.push_back(node_index);
+  }
+
+  // The input edges of a node cover its explicit and implicit inputs as well as its control dependencies.
+  // A producer connected through several edges is counted once.
+  std::vector<std::vector<size_t>> task_consumers(num_tasks);
+  new_plan->num_producers.assign(num_tasks, 0);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    const Node* node = graph_viewer.GetNode(new_plan->nodes[i]);
+    ORT_RETURN_IF(node == nullptr, "The execution plan launches the missing node ", new_plan->nodes[i], ".");
+    for (auto it = node->InputNodesBegin(), end = node->InputNodesEnd(); it != end; ++it) {
+      const NodeIndex producer_node = it->Index();
+      if (producer_node >= node_to_task.size() || node_to_task[producer_node] == kNoTask) {
+        // produced outside of this graph
+        continue;
+      }
+      auto& consumers_of_producer = task_consumers[node_to_task[producer_node]];
+      if (consumers_of_producer.empty() || consumers_of_producer.back() != i) {
+        consumers_of_producer.push_back(i);
+        ++new_plan->num_producers[i];
+      }
+    }
+  }
+
+  new_plan->consumer_offsets.reserve(num_tasks + 1);
+  new_plan->consumer_offsets.push_back(0);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    new_plan->consumers.insert(new_plan->consumers.end(), task_consumers[i].begin(), task_consumers[i].end());
+    new_plan->consumer_offsets.push_back(new_plan->consumers.size());
+    if (new_plan->num_producers[i] == 0) {
+      new_plan->entry_tasks.push_back(i);
+    }
+  }
+
+  dataflow_plan = std::move(new_plan);
+  return Status::OK();
+}
+
+namespace {
+
+// The state of an execution, shared by the tasks that are scheduled. ExecuteDataflowPlan returns before the tasks
+// complete, the caller waits for them through the execution context.
+struct DataflowExecution : std::enable_shared_from_this<DataflowExecution> {
+  DataflowExecution(const DataflowPlan& plan_in, StreamExecutionContext& ctx_in, SessionScope& session_scope_in,
+                    const bool& terminate_flag_in, concurrency::ThreadPool* tp_in)
+      : plan(plan_in),
+        ctx(ctx_in),
+        session_scope(session_scope_in),
+        terminate_flag(terminate_flag_in),
+        tp(tp_in),
+        pending_producers(std::make_unique<std::atomic_int[]>(plan_in.nodes.size())) {
+    for (size_t i = 0; i < plan.nodes.size(); ++i) {
+      pending_producers[i].store(plan.num_producers[i], std::memory_order_relaxed);
+    }
+  }
+
+  const DataflowPlan& plan;
+  StreamExecutionContext& ctx;
+  SessionScope& session_scope;
+  const bool& terminate_flag;
+  concurrency::ThreadPool* tp;
+  // the number of producers of each task that didn't complete yet
+  std::unique_ptr<std::atomic_int[]> pending_producers;
+
+  void Schedule(size_t task) {
+    ctx.AddTask();
+    concurrency::ThreadPool::Schedule(tp, [execution = shared_from_this(), task]() { execution->Run(task); });
+  }
+
+  // Executes the task and then, as long as one of its consumers became ready, the first such consumer.
+  // Balances the AddTask() call made when the task was scheduled.
+  void Run(size_t task) {
+    for (;;) {
+      if (!ctx.TaskStatus().IsOK()) {
+        // already in bad status, terminate it
+        break;
+      }
+      if (terminate_flag) {
+        Status status_made = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+        ctx.SetStatus(status_made);
+        break;
+      }
+
+      Status status;
+      ORT_TRY {
+        status = ExecuteKernel(ctx, plan.nodes[task], plan.stream_idx, terminate_flag, session_scope);
+      }
+      ORT_CATCH(const std::exception& ex) {
+        ORT_HANDLE_EXCEPTION([&]() {
+          status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+        });
+      }
+      if (!status.IsOK()) {
+        ctx.SetStatus(status);
+        break;
+      }
+
+      // The acquire-release decrement orders the outputs of all the producers before the execution of the consumer.
+      size_t next_task = plan.nodes.size();
+      for (size_t i = plan.consumer_offsets[task], end = plan.consumer_offsets[task + 1]; i < end; ++i) {
+        const size_t consumer = plan.consumers[i];
+        if (pending_producers[consumer].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          if (next_task == plan.nodes.size()) {
+            next_task = consumer;
+          } else {
+            Schedule(consumer);
+          }
+        }
+      }
+      if (next_task == plan.nodes.size()) {
+        break;
+      }
+      task = next_task;
+    }
+    ctx.CompleteTask();
+  }
+};
+
+}  // namespace
+
+void ExecuteDataflowPlan(const DataflowPlan& plan, StreamExecutionContext& ctx, SessionScope& session_scope,
+                         const bool& terminate_flag, concurrency::ThreadPool* tp) {
+  auto execution = std::make_shared<DataflowExecution>(plan, ctx, session_scope, terminate_flag, tp);
+
+  // The execution context counts the logic stream as one task, which the first entry task takes over.
+  for (size_t i = 1; i < plan.entry_tasks.size(); ++i) {
+    execution->Schedule(plan.entry_tasks[i]);
+  }
+  if (!plan.entry_tasks.empty()) {
+    execution->Run(plan.entry_tasks[0]);
+  } else {
+    ctx.CompleteTask();
+  }
+}
+
+}  // namespace onnxruntime
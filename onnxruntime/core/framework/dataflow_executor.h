@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "core/common/inlined_containers.h"
+#include "core/common/status.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+
+namespace concurrency {
+class ThreadPool;
+}
+
+class GraphViewer;
+class SessionScope;
+class StreamExecutionContext;
+struct SequentialExecutionPlan;
+
+// The dependencies between the nodes of an execution plan with a single logic stream.
+// The stream based executor runs the nodes of a logic stream one after the other in topological order, so
+// independent branches of a CPU only graph never overlap. With a DataflowPlan every node is scheduled onto the
+// inter-op thread pool as soon as all of its producers completed instead.
+struct DataflowPlan {
+  // Creates the dataflow plan of an execution plan.
+  // Returns an error saying why if the plan can't be executed in dataflow order, e.g. if it has more than one logic
+  // stream or contains synchronization steps between streams.
+  static Status Create(const SequentialExecutionPlan& plan, const GraphViewer& graph_viewer,
+                       std::unique_ptr<DataflowPlan>& dataflow_plan);
+
+  // The index of the logic stream holding all the nodes.
+  size_t stream_idx{0};
+
+  // The node executed by each task. Tasks are numbered in the topological order of the logic stream.
+  std::vector<NodeIndex> nodes;
+
+  // The number of distinct producers of each task.
+  std::vector<int> num_producers;
+
+  // The tasks consuming an output of each task, in CSR format:
+  // the consumers of task i are consumers[consumer_offsets[i]] ... consumers[consumer_offsets[i + 1] - 1].
+  std::vector<size_t> consumer_offsets;
+  std::vector<size_t> consumers;
+
+  // The tasks without producers, which start the execution.
+  InlinedVector<size_t> entry_tasks;
+};
+
+// Executes the nodes of the dataflow plan with the inter-op thread pool.
+// A worker that completes a node runs one of the consumers that became ready itself and schedules the others,
+// so chains of nodes stay on the same thread while the remaining ready nodes are spread out to idle workers by the
+// work stealing of the thread pool.
+// The caller thread executes the first entry task. Returns once that task is done, possibly before the scheduled
+// tasks complete, so the caller must wait for them with ctx.WaitAll(). The status is reported through the execution
+// context.
+void ExecuteDataflowPlan(const DataflowPlan& plan, StreamExecutionContext& ctx, SessionScope& session_scope,
+                         const bool& terminate_flag, concurrency::ThreadPool* tp);
+
+}  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #include "core/framework/execution_frame.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/framework/mem_pattern_planner.h"
@@ -393,11 +394,14 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
 
     // if there are some traditional ml value type in inputs disable the memory pattern optimization.
     if (all_tensors) {
-      mem_patterns_ = session_state.GetMemoryPatternGroup(feeds, feed_mlvalue_idxs, inferred_shapes_);
-      // if no existing patterns, generate one in this execution frame
-      if (!mem_patterns_) {
+      bool is_outdated = false;
+      mem_patterns_ = session_state.GetMemoryPatternGroup(feeds, feed_mlvalue_idxs, inferred_shapes_, is_outdated,
+                                                          mem_pattern_min_block_sizes_);
+      // if no existing patterns, or the pattern of the shape bucket is too small, generate one in this execution frame
+      if (!mem_patterns_ || is_outdated) {
         planner_.emplace(*session_state.GetExecutionPlan());
-      } else {
+      }
+      if (mem_patterns_) {
         // pre-allocate the big chunk requested in memory pattern.
         // all the internal kernel's input/output tensors will be allocated on these buffer.
         buffers_.reserve(mem_patterns_->locations.size());
@@ -467,7 +471,12 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
   }
 }
 
-ExecutionFrame::~ExecutionFrame() = default;
+ExecutionFrame::~ExecutionFrame() {
+  // size the first chunk of the arenas of the next runs to fit all the allocations of this one
+  for (const auto& [location, arena] : per_run_arenas_) {
+    session_state_.UpdatePerRunArenaSizeHint(arena->PeakTotalChunkSize());
+  }
+}
 
 Status ExecutionFrame::CopyTensor(const Tensor& src, Tensor& dest) const {
   return session_state_.GetDataTransferMgr().CopyTensor(src, dest);
@@ -492,6 +501,22 @@ Stream* ExecutionFrame::GetValueStream(int ort_value_idx) const {
   return nullptr;
 }
 
+AllocatorPtr ExecutionFrame::GetPerRunArena(const OrtMemoryInfo& location) {
+  std::lock_guard<OrtMutex> lock(per_run_arenas_lock_);
+  auto& arena = per_run_arenas_[location];
+  if (!arena) {
+    auto device_allocator = GetAllocator(location);
+    if (!device_allocator) {
+      per_run_arenas_.erase(location);
+      return nullptr;
+    }
+    arena = std::make_shared<BumpArena>(
+        std::move(device_allocator),
+        std::max<size_t>(session_state_.GetPerRunArenaSizeHint(), BumpArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES));
+  }
+  return arena;
+}
+
 Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_value, int ort_value_index,
                                                                 MLDataType element_type,
                                                                 const OrtMemoryInfo& location,
@@ -521,19 +546,27 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
 
   if (mem_patterns_ && per_alloc_plan.alloc_kind != AllocKind::kAllocateOutput &&
       per_alloc_plan.alloc_kind != AllocKind::kAllocatedExternally) {
+    // the blocks of a shape bucket fit the largest tensors seen so far with input shapes of the bucket
+    const bool use_shape_buckets = session_state_.GetUseMemoryPatternShapeBuckets();
     auto pattern = mem_patterns_->GetPatterns(location);
+    const MemoryBlock* block = pattern ? pattern->GetBlock(ort_value_index) : nullptr;
+    if (use_shape_buckets && !utils::IsDataTypeString(element_type) &&
+        (block == nullptr || block->size_ < size)) {
+      mem_pattern_misses_[ort_value_index] = size;
+    }
     if (pattern) {
-      auto block = pattern->GetBlock(ort_value_index);
       // if block not found, fall back to default behavior
       if (block) {
         auto it = buffers_.find(location);
         if (it != buffers_.end()) {
           // if the block is not correct, log message then fall back to default behavior
-          if (block->size_ == size) {
+          if (block->size_ == size || (use_shape_buckets && block->size_ > size)) {
             void* buffer = it->second.get();
             auto status = AllocateTensorWithPreAllocateBufferHelper(
                 ort_value, static_cast<void*>(static_cast<char*>(buffer) + block->offset_), element_type, location,
                 shape);
+            // an outdated pattern of a shape bucket is traced again
+            TraceAllocate(ort_value_index, size);
             return status;
           } else {
             // the block size may vary especially if the model has NonZero ops, or different sequence lengths are
@@ -551,9 +584,18 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
     }
   }
 
+  Stream* current_stream = GetValueStream(ort_value_index);
+
+  // intermediate CPU tensors can be allocated from the arena of this run, outputs outlive it.
+  if (session_state_.GetUsePerRunArena() && current_stream == nullptr &&
+      location.device.Type() == OrtDevice::CPU &&
+      per_alloc_plan.alloc_kind != AllocKind::kAllocateOutput &&
+      per_alloc_plan.alloc_kind != AllocKind::kAllocatedExternally) {
+    alloc = GetPerRunArena(location);
+  }
+
   // no memory pattern, or the pattern is not correct.
   if (!alloc) alloc = GetAllocator(location);
-  Stream* current_stream = GetValueStream(ort_value_index);
   if (current_stream) {
 #ifdef ORT_ENABLE_STREAM
     auto stream_aware_alloc = AsStreamBasedAllocator(alloc);
@@ -857,6 +899,18 @@ void ExecutionFrame::TraceAllocate(int ort_value_idx, size_t size) {
         allocation_plan.alloc_kind == AllocKind::kAllocatedExternally) {
       return;
     }
+    if (mem_patterns_) {
+      // retracing the outdated pattern of a shape bucket, the new blocks must fit the tensors of the previous runs too
+      if (auto pattern = mem_patterns_->GetPatterns(allocation_plan.location)) {
+        if (auto block = pattern->GetBlock(ort_value_idx)) {
+          size = std::max(size, block->size_);
+        }
+      }
+      auto min_size = mem_pattern_min_block_sizes_.find(ort_value_idx);
+      if (min_size != mem_pattern_min_block_sizes_.end()) {
+        size = std::max(size, min_size->second);
+      }
+    }
     auto status = planner_->TraceAllocation(ort_value_idx, size);
     if (!status.IsOK()) {
       LOGS(session_state_.Logger(), WARNING) << "TraceAllocation for ort_value_idx=" << ort_value_idx
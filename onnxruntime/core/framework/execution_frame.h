@@ -9,6 +9,7 @@
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 #include "core/common/status.h"
+#include "core/framework/bump_arena.h"
 #include "core/framework/iexecutor.h"
 #include "core/framework/ort_value.h"
 #include "core/framework/node_index_info.h"
@@ -160,6 +161,11 @@ class ExecutionFrame final : public IExecutionFrame {
     return planner_.has_value();
   }
 
+  // The tensors of this execution the memory pattern of the input shape bucket was too small for, with their sizes.
+  const InlinedHashMap<int, size_t>& GetMemoryPatternMisses() const {
+    return mem_pattern_misses_;
+  }
+
   // This function try retrieve the inferred shapes for the given NodeArg index.
   // If the retrival is sucessful, this function returns true and false otherwise.
   bool TryGetInferredShape(int index, TensorShape& shape) const override;
@@ -213,6 +219,9 @@ class ExecutionFrame final : public IExecutionFrame {
 
   Stream* GetValueStream(int ort_value_idx) const;
 
+  // Get the per-run arena of a location, creating it on first use.
+  AllocatorPtr GetPerRunArena(const OrtMemoryInfo& location);
+
   const SessionState& session_state_;
 
   // map of index to custom allocator
@@ -221,21 +230,34 @@ class ExecutionFrame final : public IExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
 
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
+  // With shape buckets, it also traces a new pattern if the cached one is outdated.
   std::optional<OrtValuePatternPlanner> planner_;
 
+  // The sizes of the tensors that didn't fit in their block of the memory pattern of a shape bucket.
+  InlinedHashMap<int, size_t> mem_pattern_misses_;
+
+  // When retracing the memory pattern of a shape bucket, the sizes the new blocks must have at least as the tensors
+  // of previous runs didn't fit in the old ones.
+  InlinedHashMap<int, size_t> mem_pattern_min_block_sizes_;
+
   // Big chunks on different locations that will be used by mem_pattern.
   InlinedHashMap<OrtMemoryInfo, BufferUniquePtr> buffers_;
 
+  // The arenas the intermediate tensors of this run are allocated from if the per-run arena is enabled.
+  // The tensors keep their arena alive, which releases all its memory at once when the last of them is gone.
+  OrtMutex per_run_arenas_lock_;
+  InlinedHashMap<OrtMemoryInfo, std::shared_ptr<BumpArena>> per_run_arenas_;
+
   // Given the input shapes of the executed graph, ExecutionFrame tries inferring
   // all symbolic shapes. inferred_shapes_[i] is the shape of OrtValue indexed
   // by i, if the key i exists.
   // inferred_shapes_ is generated together with mem_patterns_.
-  // It is never updated after creation
-  const InlinedHashMap<int, TensorShape>* inferred_shapes_{nullptr};
+  // It is never updated after creation, and stays valid if the session evicts it from its cache.
+  std::shared_ptr<const InlinedHashMap<int, TensorShape>> inferred_shapes_;
 
   gsl::span<Stream*> device_streams_;
 
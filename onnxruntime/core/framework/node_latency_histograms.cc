@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/node_latency_histograms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace onnxruntime {
+
+NodeLatencyHistograms::NodeLatencyHistograms(size_t num_nodes) : num_nodes_(num_nodes) {
+}
+
+NodeLatencyHistograms::~NodeLatencyHistograms() {
+  for (auto& shard : shards_) {
+    delete[] shard.load(std::memory_order_acquire);
+  }
+}
+
+size_t NodeLatencyHistograms::BucketIndex(uint64_t latency_ns) {
+  if (latency_ns < (uint64_t{1} << kMinBits)) {
+    return 0;
+  }
+  if (latency_ns >= (uint64_t{1} << kMaxBits)) {
+    return kNumBuckets - 1;
+  }
+  size_t shift = kMinBits;
+  while ((uint64_t{2} << shift) <= latency_ns) {
+    ++shift;
+  }
+  const size_t sub_bucket = static_cast<size_t>(latency_ns >> (shift - kSubBucketBits)) & (kSubBuckets - 1);
+  return 1 + (shift - kMinBits) * kSubBuckets + sub_bucket;
+}
+
+uint64_t NodeLatencyHistograms::BucketUpperBound(size_t index) {
+  if (index == 0) {
+    return uint64_t{1} << kMinBits;
+  }
+  if (index >= kNumBuckets - 1) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  const size_t shift = kMinBits + (index - 1) / kSubBuckets;
+  const uint64_t step = uint64_t{1} << (shift - kSubBucketBits);
+  return (uint64_t{1} << shift) + ((index - 1) % kSubBuckets + 1) * step;
+}
+
+uint64_t NodeLatencyHistograms::Snapshot::Percentile(double fraction) const {
+  if (count == 0) {
+    return 0;
+  }
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += bucket_counts[i];
+    if (seen >= rank) {
+      // no call took longer than the maximum, which also bounds the last bucket
+      return std::min(BucketUpperBound(i), max_ns);
+    }
+  }
+  return max_ns;
+}
+
+std::atomic<uint64_t>* NodeLatencyHistograms::CurrentThreadShard() {
+  // Threads are numbered in the order they first record a latency, which spreads them evenly over the shards.
+  // Hashing std::thread::id doesn't: libc++ hashes it as the pthread_t address, which is aligned.
+  static std::atomic<size_t> next_thread_index{0};
+  thread_local const size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = shards_[thread_index % kNumShards];
+  std::atomic<uint64_t>* shard = slot.load(std::memory_order_acquire);
+  if (shard == nullptr) {
+    // value-initialized, i.e. all the counters are 0. If another thread installed the shard first, use that one.
+    auto new_shard = std::make_unique<std::atomic<uint64_t>[]>(num_nodes_ * kNumCounters);
+    if (slot.compare_exchange_strong(shard, new_shard.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+      shard = new_shard.release();
+    }
+  }
+  return shard;
+}
+
+void NodeLatencyHistograms::Record(NodeIndex node_index, int64_t latency_ns) {
+  if (node_index >= num_nodes_) {
+    return;
+  }
+  const uint64_t latency = static_cast<uint64_t>(std::max<int64_t>(latency_ns, 0));
+  std::atomic<uint64_t>* counters = CurrentThreadShard() + node_index * kNumCounters;
+  counters[BucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+  counters[kNumBuckets].fetch_add(latency, std::memory_order_relaxed);
+
+  auto& max_counter = counters[kNumBuckets + 1];
+  uint64_t max = max_counter.load(std::memory_order_relaxed);
+  while (latency > max && !max_counter.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {
+  }
+}
+
+NodeLatencyHistograms::Snapshot NodeLatencyHistograms::Get(NodeIndex node_index) const {
+  Snapshot snapshot;
+  if (node_index >= num_nodes_) {
+    return snapshot;
+  }
+  for (const auto& slot : shards_) {
+    const std::atomic<uint64_t>* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+      continue;
+    }
+    const std::atomic<uint64_t>* counters = shard + node_index * kNumCounters;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      const uint64_t n = counters[i].load(std::memory_order_relaxed);
+      snapshot.bucket_counts[i] += n;
+      snapshot.count += n;
+    }
+    snapshot.total_ns += counters[kNumBuckets].load(std::memory_order_relaxed);
+    snapshot.max_ns = std::max(snapshot.max_ns, counters[kNumBuckets + 1].load(std::memory_order_relaxed));
+  }
+  return snapshot;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "core/common/common.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+
+// Latency histograms of the kernels of a graph, indexed by node index, cheap enough to stay enabled in production.
+//
+// The buckets are log-linear like the ones of HdrHistogram: four buckets per power of two nanoseconds, which bounds
+// the error of a percentile to 25%, from 2^kMinBits ns up to 2^kMaxBits ns. Latencies below the range fall into the
+// first bucket and latencies above it into the last one.
+//
+// Recording a latency is a couple of relaxed atomic increments and never blocks. The counters are striped by thread
+// over kNumShards shards, which are allocated on first use, so concurrent runs rarely write to the same cache
+// lines. The shards are merged when the histogram of a node is read.
+class NodeLatencyHistograms {
+ public:
+  static constexpr size_t kMinBits = 8;
+  static constexpr size_t kMaxBits = 36;
+  static constexpr size_t kSubBucketBits = 2;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (kMaxBits - kMinBits) * kSubBuckets + 2;
+  static constexpr size_t kNumShards = 4;
+
+  // The merged histogram of a node.
+  struct Snapshot {
+    uint64_t count{0};
+    uint64_t total_ns{0};
+    uint64_t max_ns{0};
+    std::array<uint64_t, kNumBuckets> bucket_counts{};
+
+    // The latency that the given fraction of the calls didn't exceed, i.e. the upper bound of its bucket.
+    // 0 if the node never ran.
+    uint64_t Percentile(double fraction) const;
+  };
+
+  // num_nodes is the number of node indices of the graph, i.e. GraphViewer::MaxNodeIndex().
+  explicit NodeLatencyHistograms(size_t num_nodes);
+  ~NodeLatencyHistograms();
+
+  void Record(NodeIndex node_index, int64_t latency_ns);
+
+  Snapshot Get(NodeIndex node_index) const;
+
+  size_t NumNodes() const { return num_nodes_; }
+
+  static size_t BucketIndex(uint64_t latency_ns);
+  // The exclusive upper bound of a bucket, the maximum value of uint64_t for the last one.
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(NodeLatencyHistograms);
+
+  // the counters of a node in a shard: the buckets, then the total and the maximum latency
+  static constexpr size_t kNumCounters = kNumBuckets + 2;
+
+  std::atomic<uint64_t>* CurrentThreadShard();
+
+  const size_t num_nodes_;
+  std::array<std::atomic<std::atomic<uint64_t>*>, kNumShards> shards_{};
+};
+
+}  // namespace onnxruntime
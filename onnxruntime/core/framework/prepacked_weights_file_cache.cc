@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#if !defined(ORT_MINIMAL_BUILD)
+
+#include "core/framework/prepacked_weights_file_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "core/common/cpuid_info.h"
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/framework/murmurhash3.h"
+#include "core/framework/tensor.h"
+#include "core/graph/graph.h"
+#include "core/graph/onnx_protobuf.h"
+#include "core/platform/env.h"
+#include "core/platform/path_lib.h"
+#include "onnxruntime_config.h"
+
+namespace onnxruntime {
+
+namespace {
+
+// Entry file layout (all integers are native endian, entries are not portable between machines anyway):
+//   EntryHeader
+//   BufferInfo[num_buffers]
+//   buffer data, each buffer starting at an offset that is a multiple of kBufferAlignment
+constexpr char kEntryMagic[8] = {'O', 'R', 'T', 'P', 'P', 'W', '0', '1'};
+constexpr size_t kBufferAlignment = 64;
+
+struct EntryHeader {
+  char magic[8];
+  uint64_t num_buffers;
+};
+
+struct BufferInfo {
+  uint64_t is_present;  // some pre-packed buffers are null place-holders occupying an index
+  uint64_t size;
+};
+
+size_t AlignOffset(size_t offset) {
+  return (SafeInt<size_t>(offset) + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+// Owns the read-only mapping of a loaded entry.
+// Every buffer pointing into the mapping holds a reference to this allocator in its BufferDeleter, so the file stays
+// mapped until the last of those buffers is released. It never allocates and freeing a buffer is a no-op.
+class MappedEntryAllocator final : public IAllocator {
+ public:
+  explicit MappedEntryAllocator(Env::MappedMemoryPtr mapped_memory)
+      : IAllocator(OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator)),
+        mapped_memory_(std::move(mapped_memory)) {}
+
+  void* Alloc(size_t /*size*/) override {
+    ORT_THROW("MappedEntryAllocator does not support allocation.");
+  }
+
+  void Free(void* /*p*/) override {}
+
+ private:
+  Env::MappedMemoryPtr mapped_memory_;
+};
+
+// Hashes in chunks as MurmurHash3 takes an int length and initializers can be larger than 2GB.
+void HashBytes(const void* data, size_t len, uint32_t (&hash)[4]) {
+  constexpr size_t kMaxChunkSize = 1 << 30;
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  do {
+    const size_t chunk_size = std::min(len, kMaxChunkSize);
+    MurmurHash3::x86_128(bytes, static_cast<int>(chunk_size), hash[0], &hash);
+    bytes += chunk_size;
+    len -= chunk_size;
+  } while (len > 0);
+}
+
+// The CPU features that select the MLAS kernels, and therefore the packed layout.
+std::string GetCpuFeatures() {
+  const auto& cpu_info = CPUIDInfo::GetCPUIDInfo();
+  std::ostringstream ss;
+  ss << cpu_info.HasSSE3() << cpu_info.HasSSE4_1() << cpu_info.HasAVX() << cpu_info.HasAVX2()
+     << cpu_info.HasF16C() << cpu_info.HasAVX512f() << cpu_info.HasAVX512Skylake() << cpu_info.HasAVX512_BF16()
+     << cpu_info.HasAMX_BF16() << cpu_info.HasArmNeonDot() << cpu_info.HasFp16VectorAcceleration();
+  return ss.str();
+}
+
+}  // namespace
+
+PrepackedWeightsFileCache::PrepackedWeightsFileCache(const Env& env, const PathString& cache_dir)
+    : env_(env), cache_dir_(cache_dir) {
+}
+
+Status PrepackedWeightsFileCache::GetKey(const Node& node, int input_idx, const Tensor& tensor, std::string& key) {
+  ORT_RETURN_IF(tensor.IsDataTypeString(), "Pre-packed weights of string tensors can not be cached.");
+
+  std::ostringstream meta;
+  meta << ORT_VERSION << '|' << GetCpuFeatures() << '|'
+       << node.Domain() << '|' << node.OpType() << '|' << node.SinceVersion() << '|'
+       << node.GetExecutionProviderType() << '|' << input_idx << '|'
+       << tensor.GetElementType() << '|' << tensor.Shape().ToString() << '|';
+
+  // attributes affect the packed layout (e.g. transB), so serialize them in a deterministic order
+  const auto& attributes = node.GetAttributes();
+  std::vector<const std::string*> attribute_names;
+  attribute_names.reserve(attributes.size());
+  for (const auto& attribute : attributes) {
+    attribute_names.push_back(&attribute.first);
+  }
+  std::sort(attribute_names.begin(), attribute_names.end(),
+            [](const std::string* lhs, const std::string* rhs) { return *lhs < *rhs; });
+  for (const auto* name : attribute_names) {
+    meta << *name << '=' << attributes.at(*name).SerializeAsString() << '|';
+  }
+
+  uint32_t hash[4] = {0, 0, 0, 0};
+  const std::string meta_str = meta.str();
+  HashBytes(meta_str.data(), meta_str.size(), hash);
+  if (tensor.SizeInBytes() > 0) {
+    HashBytes(tensor.DataRaw(), tensor.SizeInBytes(), hash);
+  }
+
+  std::ostringstream key_ss;
+  key_ss << std::hex;
+  for (uint32_t part : hash) {
+    key_ss.width(8);
+    key_ss.fill('0');
+    key_ss << part;
+  }
+
+  key = key_ss.str();
+  return Status::OK();
+}
+
+PathString PrepackedWeightsFileCache::GetEntryPath(const std::string& key) const {
+  return ConcatPathComponent(cache_dir_, ToPathString(key) + ORT_TSTR(".bin"));
+}
+
+Status PrepackedWeightsFileCache::Load(const std::string& key, PrePackedWeights& weights, bool& found) const {
+  found = false;
+
+  const PathString entry_path = GetEntryPath(key);
+  if (!env_.FileExists(entry_path)) {
+    return Status::OK();
+  }
+
+  size_t file_length = 0;
+  ORT_RETURN_IF_ERROR(env_.GetFileLength(entry_path.c_str(), file_length));
+  ORT_RETURN_IF(file_length < sizeof(EntryHeader), "Pre-packed weights cache entry ", key, " is truncated.");
+
+  Env::MappedMemoryPtr mapped_memory;
+  ORT_RETURN_IF_ERROR(env_.MapFileIntoMemoryReadOnly(entry_path.c_str(), 0, file_length, mapped_memory));
+  const char* base = mapped_memory.get();
+
+  EntryHeader header;
+  memcpy(&header, base, sizeof(header));
+  ORT_RETURN_IF(memcmp(header.magic, kEntryMagic, sizeof(kEntryMagic)) != 0,
+                "Pre-packed weights cache entry ", key, " has an unexpected format.");
+
+  const size_t num_buffers = narrow<size_t>(header.num_buffers);
+  size_t offset = SafeInt<size_t>(sizeof(EntryHeader)) + SafeInt<size_t>(num_buffers) * sizeof(BufferInfo);
+  ORT_RETURN_IF(offset > file_length, "Pre-packed weights cache entry ", key, " is truncated.");
+
+  std::vector<BufferInfo> buffer_infos(num_buffers);
+  if (num_buffers > 0) {
+    memcpy(buffer_infos.data(), base + sizeof(EntryHeader), num_buffers * sizeof(BufferInfo));
+  }
+
+  // validate the complete entry before handing out any buffer
+  std::vector<size_t> buffer_offsets(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    offset = AlignOffset(offset);
+    buffer_offsets[i] = offset;
+    offset = SafeInt<size_t>(offset) + narrow<size_t>(buffer_infos[i].size);
+    ORT_RETURN_IF(offset > file_length, "Pre-packed weights cache entry ", key, " is truncated.");
+  }
+
+  auto entry_allocator = std::make_shared<MappedEntryAllocator>(std::move(mapped_memory));
+  weights.buffers_.reserve(num_buffers);
+  weights.buffer_sizes_.reserve(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    void* buffer = buffer_infos[i].is_present ? const_cast<char*>(base) + buffer_offsets[i] : nullptr;
+    weights.buffers_.emplace_back(buffer, BufferDeleter(entry_allocator));
+    weights.buffer_sizes_.push_back(narrow<size_t>(buffer_infos[i].size));
+  }
+
+  found = true;
+  return Status::OK();
+}
+
+Status PrepackedWeightsFileCache::Save(const std::string& key, const PrePackedWeights& weights) const {
+  ORT_RETURN_IF_NOT(weights.buffers_.size() == weights.buffer_sizes_.size(),
+                    "Mismatched number of pre-packed buffers and sizes.");
+
+  if (!env_.FolderExists(cache_dir_)) {
+    // another process may have created it concurrently
+    const Status status = env_.CreateFolder(cache_dir_);
+    ORT_RETURN_IF(!status.IsOK() && !env_.FolderExists(cache_dir_),
+                  "Failed to create the pre-packed weights cache directory ", PathToUTF8String(cache_dir_), ": ",
+                  status.ErrorMessage());
+  }
+
+  const PathString entry_path = GetEntryPath(key);
+  const PathString temp_path = entry_path + ORT_TSTR(".") + ToPathString(std::to_string(env_.GetSelfPid())) +
+                               ORT_TSTR(".tmp");
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    ORT_RETURN_IF(!out, "Failed to create pre-packed weights cache entry ", PathToUTF8String(temp_path));
+
+    EntryHeader header;
+    memcpy(header.magic, kEntryMagic, sizeof(kEntryMagic));
+    header.num_buffers = weights.buffers_.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (size_t i = 0; i < weights.buffers_.size(); ++i) {
+      const bool is_present = weights.buffers_[i] != nullptr;
+      BufferInfo info{is_present ? 1u : 0u, is_present ? weights.buffer_sizes_[i] : 0};
+      out.write(reinterpret_cast<const char*>(&info), sizeof(info));
+    }
+
+    size_t offset = sizeof(EntryHeader) + weights.buffers_.size() * sizeof(BufferInfo);
+    const char padding[kBufferAlignment] = {};
+    for (size_t i = 0; i < weights.buffers_.size(); ++i) {
+      const size_t aligned_offset = AlignOffset(offset);
+      out.write(padding, static_cast<std::streamsize>(aligned_offset - offset));
+      offset = aligned_offset;
+
+      if (weights.buffers_[i] != nullptr) {
+        out.write(static_cast<const char*>(weights.buffers_[i].get()),
+                  static_cast<std::streamsize>(weights.buffer_sizes_[i]));
+        offset += weights.buffer_sizes_[i];
+      }
+    }
+
+    out.close();
+    if (!out) {
+      ORT_IGNORE_RETURN_VALUE(env_.RemoveFile(temp_path));
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to write pre-packed weights cache entry ",
+                             PathToUTF8String(temp_path));
+    }
+  }
+
+  const Status rename_status = env_.RenameFile(temp_path, entry_path);
+  if (!rename_status.IsOK()) {
+    ORT_IGNORE_RETURN_VALUE(env_.RemoveFile(temp_path));
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to commit pre-packed weights cache entry ",
+                           PathToUTF8String(entry_path), ": ", rename_status.ErrorMessage());
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
+
+#endif  // !defined(ORT_MINIMAL_BUILD)
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#if !defined(ORT_MINIMAL_BUILD)
+
+#include <string>
+
+#include "core/common/common.h"
+#include "core/common/path_string.h"
+#include "core/framework/prepacked_weights.h"
+
+namespace onnxruntime {
+
+class Env;
+class Node;
+class Tensor;
+
+// On-disk cache of pre-packed weights that persists across process restarts.
+//
+// Each entry is a file in the cache directory that holds the buffers produced by a kernel's PrePack() for one
+// constant initializer. The entry's name is a hash of everything that determines the packed layout: the initializer
+// data, type and shape, the consuming node's op identity and attributes, the input index, the ORT version and the CPU
+// features MLAS dispatches on. Loaded entries are memory mapped read-only, so the packed weights are shared through
+// the OS page cache by all processes serving the same model.
+class PrepackedWeightsFileCache final {
+ public:
+  PrepackedWeightsFileCache(const Env& env, const PathString& cache_dir);
+
+  // Computes the key of the entry holding the pre-packed weights for `tensor` when it is consumed as input
+  // `input_idx` of `node`.
+  static Status GetKey(const Node& node, int input_idx, const Tensor& tensor, std::string& key);
+
+  // Loads the entry for `key` into `weights` if it exists.
+  // The loaded buffers point into a read-only mapping of the entry file that stays alive until the last of them
+  // is released. They must not be written to.
+  Status Load(const std::string& key, PrePackedWeights& weights, bool& found) const;
+
+  // Writes `weights` as the entry for `key`.
+  // The entry is written to a temporary file which is then renamed, so a concurrently loading process never
+  // observes a partially written entry.
+  Status Save(const std::string& key, const PrePackedWeights& weights) const;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PrepackedWeightsFileCache);
+
+ private:
+  PathString GetEntryPath(const std::string& key) const;
+
+  const Env& env_;
+  const PathString cache_dir_;
+};
+
+}  // namespace onnxruntime
+
+#endif  // !defined(ORT_MINIMAL_BUILD)
@@ -10,6 +10,7 @@
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 #include "core/framework/allocation_planner.h"
+#include "core/framework/dataflow_executor.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/stream_execution_context.h"
 #include "core/framework/session_state.h"
@@ -336,6 +337,10 @@ class KernelScope {
     node_compute_range_.Begin();
 #endif
 
+    if (session_state_.GetNodeLatencyHistograms() != nullptr) {
+      histogram_begin_time_ = std::chrono::high_resolution_clock::now();
+    }
+
     if (session_state_.Profiler().IsEnabled()) {
       auto& node = kernel.Node();
       node_name_ = node.Name().empty() ? MakeString(node.OpType(), "_", node.Index()) : node.Name();
@@ -361,6 +366,12 @@ class KernelScope {
     node_compute_range_.End();
 #endif
 
+    if (auto* histograms = session_state_.GetNodeLatencyHistograms(); histograms != nullptr) {
+      const auto latency = std::chrono::high_resolution_clock::now() - histogram_begin_time_;
+      histograms->Record(kernel_.Node().Index(),
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+
     if (session_state_.Profiler().IsEnabled()) {
       auto& profiler = session_state_.Profiler();
       std::string output_type_shape_;
@@ -409,6 +420,7 @@ class KernelScope {
 
  private:
   TimePoint kernel_begin_time_;
+  TimePoint histogram_begin_time_;
   SessionScope& session_scope_;
   const SessionState& session_state_;
   std::string node_name_;
@@ -578,16 +590,21 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 
   auto* tp = single_thread_mode ? nullptr : session_state.GetInterOpThreadPool();
 
-  for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
-    if (execution_plan->execution_plan[i]->steps_.empty()) {
-      // execution context is initialized with number of valid streams
-      // for invalid stream (0 steps), it doesn't count in number of tasks
-      // so don't need to invoke CompleteTask here
-      // ctx.CompleteTask();
-    } else {
-      concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
-        RunSince(i, ctx, session_scope, terminate_flag, 0);
-      });
+  const auto* dataflow_plan = session_state.GetDataflowPlan();
+  if (tp != nullptr && dataflow_plan != nullptr && !only_execute_path_to_fetches) {
+    ExecuteDataflowPlan(*dataflow_plan, ctx, session_scope, terminate_flag, tp);
+  } else {
+    for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
+      if (execution_plan->execution_plan[i]->steps_.empty()) {
+        // execution context is initialized with number of valid streams
+        // for invalid stream (0 steps), it doesn't count in number of tasks
+        // so don't need to invoke CompleteTask here
+        // ctx.CompleteTask();
+      } else {
+        concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
+          RunSince(i, ctx, session_scope, terminate_flag, 0);
+        });
+      }
     }
   }
 
@@ -608,6 +625,9 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
       ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GeneratePatterns(mem_patterns));
       ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(feeds, std::move(mem_patterns)));
     }
+  } else if (!ctx.GetExecutionFrame().GetMemoryPatternMisses().empty()) {
+    // the next run with input shapes of the same bucket traces a pattern that fits this one too
+    session_state.MarkMemoryPatternGroupOutdated(feeds, ctx.GetExecutionFrame().GetMemoryPatternMisses());
   }
 
   return Status::OK();
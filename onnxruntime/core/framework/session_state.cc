@@ -3,16 +3,20 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/platform/ort_mutex.h"
+#include "core/common/hash_combine.h"
 #include "core/common/logging/logging.h"
+#include "core/common/parse_string.h"
 #include "core/common/safeint.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_pattern_planner.h"
+#include "core/framework/prepacked_weights_file_cache.h"
 #include "core/framework/session_state_utils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
@@ -86,6 +90,12 @@ SessionState::SessionState(Graph& graph,
 {
   enable_mem_pattern_ = sess_options_.enable_mem_pattern &&
                         sess_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL;
+  mem_pattern_shape_buckets_ =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternShapeBuckets, "0") == "1";
+  mem_pattern_cache_size_ = ParseStringWithClassicLocale<size_t>(
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternCacheSize, "0"));
+  use_per_run_arena_ =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigUsePerRunArena, "0") == "1";
   SetupAllocators();
 }
 
@@ -391,6 +401,52 @@ static Status KernelUseSharedPrePackedBuffers(OpKernel& kernel, int input_idx,
   return Status::OK();
 }
 
+#if !defined(ORT_MINIMAL_BUILD)
+// Pre-packs the constant initializer `tensor` for `kernel` through the on-disk pre-packed weights cache.
+// On a cache hit the kernel restores the persisted buffers and PrePack() is skipped entirely. On a miss the weights
+// are pre-packed and written to the cache for subsequent sessions. Cache failures are not fatal.
+static Status PrePackUsingFileCache(const PrepackedWeightsFileCache& file_cache, const Node& node, OpKernel& kernel,
+                                    int input_idx, const Tensor& tensor, const AllocatorPtr& alloc,
+                                    /*out*/ bool& is_packed, const logging::Logger& logger) {
+  is_packed = false;
+
+  std::string key;
+  ORT_RETURN_IF_ERROR(PrepackedWeightsFileCache::GetKey(node, input_idx, tensor, key));
+
+  PrePackedWeights cached_weights;
+  bool found = false;
+  Status status = file_cache.Load(key, cached_weights, found);
+  if (!status.IsOK()) {
+    LOGS(logger, WARNING) << "Ignoring pre-packed weights cache entry for node " << node.Name() << ": "
+                          << status.ErrorMessage();
+    found = false;
+  }
+
+  if (found) {
+    LOGS(logger, INFO) << "Using pre-packed weights cache entry " << key << " for input " << input_idx
+                       << " of node " << node.Name();
+    ORT_RETURN_IF_ERROR(kernel.RestorePrePackedWeights(tensor, input_idx, cached_weights.buffers_));
+    is_packed = true;
+    return Status::OK();
+  }
+
+  PrePackedWeights weights;
+  ORT_RETURN_IF_ERROR(kernel.PrePack(tensor, input_idx, alloc, is_packed, &weights));
+  if (is_packed) {
+    status = file_cache.Save(key, weights);
+    if (!status.IsOK()) {
+      LOGS(logger, WARNING) << "Failed to write pre-packed weights cache entry for node " << node.Name() << ": "
+                            << status.ErrorMessage();
+    }
+
+    // hand the buffers back to the kernel which owns them from here on
+    ORT_RETURN_IF_ERROR(kernel.RestorePrePackedWeights(tensor, input_idx, weights.buffers_));
+  }
+
+  return Status::OK();
+}
+#endif
+
 static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
                                                      const PrePackedWeights& pre_packed_weights) {
   std::ostringstream ss_1;
@@ -403,8 +459,17 @@ static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
 
 Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
                                                        const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map) {
-  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map](
-                                        bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
+#if !defined(ORT_MINIMAL_BUILD)
+  std::unique_ptr<PrepackedWeightsFileCache> prepacked_weights_file_cache;
+  const std::string prepacked_weights_cache_dir =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigPrePackedWeightsCacheDir, "");
+  if (!prepacked_weights_cache_dir.empty()) {
+    prepacked_weights_file_cache = std::make_unique<PrepackedWeightsFileCache>(
+        Env::Default(), ToPathString(prepacked_weights_cache_dir));
+  }
+#endif
+
+  auto prepacked_constant_weights = [&](bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
     for (auto& node : GetGraphViewer().Nodes()) {
       auto kernel = GetMutableKernel(node.Index());
       int input_idx = 0;
@@ -485,11 +550,23 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
 
                 } else {  // caching of pre-packed weights' turned OFF
                   AllocatorPtr session_cpu_alloc = kernel->Info().GetAllocator(OrtMemType::OrtMemTypeDefault);
-                  ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx,
-                                                      session_cpu_alloc,  // use allocator tied to this session
-                                                      is_packed,
-                                                      nullptr  // no caching required
-                                                      ));
+#if !defined(ORT_MINIMAL_BUILD)
+                  // persisting pre-packed weights on disk is limited to the CPU EP as the packed layout is only
+                  // known to be determined by the CPU features in the cache key for MLAS
+                  if (prepacked_weights_file_cache && node.GetExecutionProviderType() == kCpuExecutionProvider &&
+                      kernel->CanRestorePrePackedWeights(input_idx)) {
+                    ORT_RETURN_IF_ERROR(PrePackUsingFileCache(*prepacked_weights_file_cache, node, *kernel, input_idx,
+                                                              const_initialized_tensor, session_cpu_alloc,
+                                                              is_packed, logger_));
+                  } else
+#endif
+                  {
+                    ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx,
+                                                        session_cpu_alloc,  // use allocator tied to this session
+                                                        is_packed,
+                                                        nullptr  // no caching required
+                                                        ));
+                  }
                 }
                 if (is_packed) {
                   ++number_of_prepacks_counter_;
@@ -530,12 +607,26 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
   }
 }
 
-static int64_t CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
-  int64_t key = 0;
+// Rounds a dimension up to the next power of two, so that e.g. all sequence lengths from 65 to 128 share a bucket.
+static int64_t GetShapeBucketDim(int64_t dim) {
+  int64_t bucket_dim = 1;
+  while (bucket_dim < dim) {
+    bucket_dim <<= 1;
+  }
+  return bucket_dim;
+}
+
+static int64_t CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs, bool use_shape_buckets) {
+  // combine the ranks and dims in order, inputs with equal dims must not cancel out each other
+  size_t key = 0;
   for (const auto& input : tensor_inputs) {
-    for (auto dim : input.Get<Tensor>().Shape().GetDims()) key ^= dim;
+    const auto dims = input.Get<Tensor>().Shape().GetDims();
+    HashCombine(dims.size(), key);
+    for (auto dim : dims) {
+      HashCombine(use_shape_buckets ? GetShapeBucketDim(dim) : dim, key);
+    }
   }
-  return key;
+  return static_cast<int64_t>(key);
 }
 
 #ifdef ENABLE_TRAINING
@@ -773,25 +864,32 @@ Status SessionState::GeneratePatternGroupCache(gsl::span<const OrtValue> tensor_
 #endif
 
 // MemoryPatternGroup pointer is cached. It only inserted upon creation
-// and is not updated if already present.
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
+// and is not updated if already present, unless it was marked outdated.
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
     gsl::span<const OrtValue> tensor_inputs,
     gsl::span<const int> feed_mlvalue_idxs,
-    const InlinedHashMap<int, TensorShape>*& out_inferred_shapes) const {
+    std::shared_ptr<const InlinedHashMap<int, TensorShape>>& out_inferred_shapes,
+    bool& is_outdated,
+    InlinedHashMap<int, size_t>& min_block_sizes) const {
   out_inferred_shapes = nullptr;
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  is_outdated = false;
+  int64_t key = CalculateMemoryPatternsKey(tensor_inputs, mem_pattern_shape_buckets_);
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
   auto it = mem_patterns_.find(key);
   if (it == mem_patterns_.end()) {
 #ifdef ENABLE_TRAINING
-    MemoryPatternGroup mem_patterns;
-    InlinedHashMap<int, TensorShape> inferred_shapes;
-    if (GeneratePatternGroupCache(tensor_inputs, feed_mlvalue_idxs, mem_patterns, inferred_shapes).IsOK()) {
-      auto patt_insert = mem_patterns_.insert_or_assign(key, std::move(mem_patterns));
-      auto ptr = &patt_insert.first->second;
-      auto shape_insert = shape_patterns_.insert_or_assign(key, std::move(inferred_shapes));
-      out_inferred_shapes = &shape_insert.first->second;
-      return ptr;
+    // the statically computed patterns are exact, a shape bucket is traced at runtime instead
+    if (!mem_pattern_shape_buckets_) {
+      MemoryPatternGroup mem_patterns;
+      InlinedHashMap<int, TensorShape> inferred_shapes;
+      if (GeneratePatternGroupCache(tensor_inputs, feed_mlvalue_idxs, mem_patterns, inferred_shapes).IsOK()) {
+        auto ptr = InsertMemoryPatternGroup(key, std::move(mem_patterns));
+        // the shapes of a key never change, keep the ones a running execution frame may use
+        auto shape_insert = shape_patterns_.try_emplace(
+            key, std::make_shared<const InlinedHashMap<int, TensorShape>>(std::move(inferred_shapes)));
+        out_inferred_shapes = shape_insert.first->second;
+        return ptr;
+      }
     }
 #else
     ORT_UNUSED_PARAMETER(feed_mlvalue_idxs);
@@ -799,11 +897,45 @@ const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
     return nullptr;
   }
 
+  mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, it->second.lru_it);
+  if (it->second.is_outdated) {
+    // a single run traces the new pattern
+    is_outdated = true;
+    min_block_sizes = std::move(it->second.min_block_sizes);
+    it->second.is_outdated = false;
+    it->second.min_block_sizes.clear();
+  }
+
   auto patt_hit = shape_patterns_.find(key);
   if (patt_hit != shape_patterns_.cend()) {
-    out_inferred_shapes = &patt_hit->second;
+    out_inferred_shapes = patt_hit->second;
+  }
+  return it->second.patterns;
+}
+
+std::shared_ptr<const MemoryPatternGroup> SessionState::InsertMemoryPatternGroup(
+    int64_t key, MemoryPatternGroup mem_patterns) const {
+  auto patterns = std::make_shared<const MemoryPatternGroup>(std::move(mem_patterns));
+  auto it = mem_patterns_.find(key);
+  if (it != mem_patterns_.end()) {
+    // execution frames still using the replaced pattern keep it alive
+    it->second.patterns = patterns;
+    mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, it->second.lru_it);
+    return patterns;
   }
-  return &it->second;
+
+  if (mem_pattern_cache_size_ != 0 && mem_patterns_.size() >= mem_pattern_cache_size_) {
+    const int64_t evicted_key = mem_patterns_lru_.back();
+    mem_patterns_.erase(evicted_key);
+#ifdef ENABLE_TRAINING
+    // the shapes were inferred together with the pattern
+    shape_patterns_.erase(evicted_key);
+#endif
+    mem_patterns_lru_.pop_back();
+  }
+  mem_patterns_lru_.push_front(key);
+  mem_patterns_.emplace(key, CachedMemoryPatternGroup{patterns, false, {}, mem_patterns_lru_.begin()});
+  return patterns;
 }
 
 void SessionState::ResolveMemoryPatternFlag() {
@@ -854,14 +986,38 @@ void SessionState::ResolveMemoryPatternFlag() {
 
 Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                                    MemoryPatternGroup mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  int64_t key = CalculateMemoryPatternsKey(tensor_inputs, mem_pattern_shape_buckets_);
 
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  // Do not update if present, as the pointer to the existing one is cached
-  mem_patterns_.emplace(key, std::move(mem_patterns));
+  // Only a pattern traced for a bucket replaces the existing one, an exact pattern doesn't change.
+  if (mem_pattern_shape_buckets_ || mem_patterns_.find(key) == mem_patterns_.end()) {
+    InsertMemoryPatternGroup(key, std::move(mem_patterns));
+  }
   return Status::OK();
 }
 
+void SessionState::MarkMemoryPatternGroupOutdated(gsl::span<const OrtValue> tensor_inputs,
+                                                  const InlinedHashMap<int, size_t>& missed_sizes) const {
+  int64_t key = CalculateMemoryPatternsKey(tensor_inputs, mem_pattern_shape_buckets_);
+
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  auto it = mem_patterns_.find(key);
+  if (it != mem_patterns_.end()) {
+    it->second.is_outdated = true;
+    for (const auto& [ort_value_idx, size] : missed_sizes) {
+      auto& min_block_size = it->second.min_block_sizes[ort_value_idx];
+      min_block_size = std::max(min_block_size, size);
+    }
+  }
+}
+
+void SessionState::UpdatePerRunArenaSizeHint(size_t peak_size) const {
+  size_t hint = per_run_arena_size_hint_.load(std::memory_order_relaxed);
+  while (hint < peak_size &&
+         !per_run_arena_size_hint_.compare_exchange_weak(hint, peak_size, std::memory_order_relaxed)) {
+  }
+}
+
 bool SessionState::GetEnableMemoryPattern() const { return enable_mem_pattern_; }
 
 bool SessionState::GetEnableMemoryReuse() const { return sess_options_.enable_mem_reuse; }
@@ -1330,6 +1486,13 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
     CreateGraphInfo();
   }
 
+  // the nodes of subgraphs are timed as part of their parent node
+  if (parent_node == nullptr &&
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNodeLatencyHistogramsEnable, "1") ==
+          "1") {
+    node_latency_histograms_ = std::make_unique<NodeLatencyHistograms>(graph_viewer_->MaxNodeIndex());
+  }
+
 #if defined(ORT_EXTENDED_MINIMAL_BUILD)
   // Remove any unused initializers.
   // Not needed in a full build because unused initializers should have been removed earlier by Graph::Resolve().
@@ -1379,9 +1542,13 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
   SubgraphsKernelCreateInfoMaps subgraphs_kernel_create_info_maps;
   AccumulateAllNestedSubgraphsInfo(*this, "", 0, subgraphs_kernel_create_info_maps);
 
+  const bool use_dataflow_executor =
+      session_options.execution_mode == ExecutionMode::ORT_PARALLEL &&
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigUseDataflowExecutor, "0") == "1";
   SequentialPlannerContext context(session_options.execution_mode,
                                    session_options.execution_order,
-                                   session_options.enable_mem_reuse);
+                                   session_options.enable_mem_reuse,
+                                   use_dataflow_executor);
 
 #ifdef _WIN32
 
@@ -1410,6 +1577,13 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                                               p_seq_exec_plan_);
   ORT_RETURN_IF_ERROR(status);
 
+  if (use_dataflow_executor) {
+    const auto dataflow_status = DataflowPlan::Create(*p_seq_exec_plan_, *graph_viewer_, dataflow_plan_);
+    if (!dataflow_status.IsOK()) {
+      LOGS(logger_, INFO) << dataflow_status.ErrorMessage() << " Using the stream based executor.";
+    }
+  }
+
   // Record the allocation plan
 
   // Uncomment the below to dump the allocation plan to std::cout
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <list>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -17,6 +19,7 @@
 #include "core/framework/allocation_planner.h"
 #include "core/framework/callback.h"
 #include "core/framework/data_transfer_manager.h"
+#include "core/framework/dataflow_executor.h"
 #include "core/framework/execution_providers.h"
 #include "core/framework/stream_execution_context.h"
 #include "core/framework/feeds_fetches_manager.h"
@@ -25,6 +28,7 @@
 #include "core/framework/fuse_nodes_funcs.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
+#include "core/framework/node_latency_histograms.h"
 #include "core/framework/ort_value.h"
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
@@ -185,6 +189,10 @@ class SessionState {
   // execution plan. nullptr until FinalizeSessionState is called
   const SequentialExecutionPlan* GetExecutionPlan() const;
 
+  // dependencies between the nodes of the execution plan, to execute them in dataflow order.
+  // nullptr unless the dataflow executor is enabled and applicable to the execution plan.
+  const DataflowPlan* GetDataflowPlan() const { return dataflow_plan_.get(); }
+
   const std::vector<AllocPlanPerValue>& GetPerValueAllocPlan() const;
 
   /**
@@ -215,11 +223,16 @@ class SessionState {
   made under mutex being held. In inference scenarios,
   it is not mutable, we do not obtain a lock and simply get a pointer
   w/o copying a hashtable
+  The returned pattern stays valid while it is referenced, even if it is evicted from the cache meanwhile.
+  is_outdated is set if a previous run in the same input shape bucket didn't fit in the pattern, in which case
+  the caller should trace a new pattern with blocks of at least min_block_sizes for the tensors that didn't fit.
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(
       gsl::span<const OrtValue> tensor_inputs,
       gsl::span<const int> feed_mlvalue_idxs,
-      const InlinedHashMap<int, TensorShape>*& inferred_shapes) const;
+      std::shared_ptr<const InlinedHashMap<int, TensorShape>>& inferred_shapes,
+      bool& is_outdated,
+      InlinedHashMap<int, size_t>& min_block_sizes) const;
 
   /**
   Set generated memory pattern with a given input shapes.
@@ -229,6 +242,38 @@ class SessionState {
   Status UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                        MemoryPatternGroup mem_patterns) const;
 
+  /**
+  Mark the memory pattern of the input shape bucket of tensor_inputs as outdated as a run didn't fit in it.
+  missed_sizes holds the sizes of the tensors of that run that didn't fit in their blocks.
+  All inputs must represent Tensors
+  */
+  void MarkMemoryPatternGroupOutdated(gsl::span<const OrtValue> tensor_inputs,
+                                      const InlinedHashMap<int, size_t>& missed_sizes) const;
+
+  /**
+  Whether the memory patterns are shared by all the input shapes of a bucket.
+  See kOrtSessionOptionsConfigMemoryPatternShapeBuckets.
+  */
+  bool GetUseMemoryPatternShapeBuckets() const { return mem_pattern_shape_buckets_; }
+
+  /**
+  Whether the intermediate tensors of a run are allocated from a BumpArena owned by the run.
+  See kOrtSessionOptionsConfigUsePerRunArena.
+  */
+  bool GetUsePerRunArena() const { return use_per_run_arena_; }
+
+  /**
+  The latency histograms of the nodes, nullptr if they are disabled or for the session state of a subgraph.
+  See kOrtSessionOptionsConfigNodeLatencyHistogramsEnable.
+  */
+  NodeLatencyHistograms* GetNodeLatencyHistograms() const noexcept { return node_latency_histograms_.get(); }
+
+  /**
+  The initial chunk size of the per-run arenas, which grows to the peak size of the arenas of previous runs.
+  */
+  size_t GetPerRunArenaSizeHint() const { return per_run_arena_size_hint_.load(std::memory_order_relaxed); }
+  void UpdatePerRunArenaSizeHint(size_t peak_size) const;
+
   bool GetUseDeterministicCompute() const { return sess_options_.use_deterministic_compute; }
 
   /**
@@ -399,6 +444,11 @@ class SessionState {
       InlinedHashMap<int, TensorShape>& inferred_shapes) const;
 #endif
 
+  // Caches the memory pattern of key, replacing the existing one, and evicts the least recently used pattern if the
+  // cache is full. mem_patterns_lock_ must be held.
+  std::shared_ptr<const MemoryPatternGroup> InsertMemoryPatternGroup(int64_t key,
+                                                                     MemoryPatternGroup mem_patterns) const;
+
   // KernelCreateInfo for each node so we do kernel lookup once
   KernelCreateInfoMap kernel_create_info_map_;
 
@@ -475,6 +525,7 @@ class SessionState {
   InlinedHashMap<int, OrtCallback> deleter_for_initialized_tensors_;
   InlinedVector<BufferUniquePtr> weights_buffers_;
   std::optional<SequentialExecutionPlan> p_seq_exec_plan_;
+  std::unique_ptr<DataflowPlan> dataflow_plan_;
 
   const logging::Logger& logger_;
   profiling::Profiler& profiler_;
@@ -486,17 +537,37 @@ class SessionState {
   // switch for enable memory pattern optimization or not.
   bool enable_mem_pattern_;
 
+  // share the memory patterns between the input shapes of a bucket, with block sizes that fit all of them.
+  bool mem_pattern_shape_buckets_{false};
+  // the maximum number of cached memory patterns, 0 if unlimited.
+  size_t mem_pattern_cache_size_{0};
+
+  // allocate the intermediate tensors of a run from a per-run BumpArena instead of the shared allocators.
+  bool use_per_run_arena_{false};
+  mutable std::atomic<size_t> per_run_arena_size_hint_{0};
+
+  std::unique_ptr<NodeLatencyHistograms> node_latency_histograms_;
+
+  struct CachedMemoryPatternGroup {
+    std::shared_ptr<const MemoryPatternGroup> patterns;
+    // set when a run didn't fit in the pattern, with the sizes of the tensors that didn't fit
+    bool is_outdated{false};
+    InlinedHashMap<int, size_t> min_block_sizes;
+    std::list<int64_t>::iterator lru_it;
+  };
+
   // lock for the mem_patterns_
   mutable OrtMutex mem_patterns_lock_;
   // cache for the generated mem_patterns. key is calculated based on input shapes.
-  // must be a node based container as a pointer is cached.
-  mutable NodeHashMap<int64_t, MemoryPatternGroup> mem_patterns_;
-  // This is mutable under mutex in training scenarios so execution frame would make a copy
-  // of the value when created.
+  mutable InlinedHashMap<int64_t, CachedMemoryPatternGroup> mem_patterns_;
+  // keys of mem_patterns_, the most recently used first
+  mutable std::list<int64_t> mem_patterns_lru_;
+  // This is mutable under mutex in training scenarios. Its entries are evicted together with the ones of
+  // mem_patterns_, execution frames keep the shapes they use alive.
 #ifdef ENABLE_TRAINING
-  mutable NodeHashMap<int64_t, InlinedHashMap<int, TensorShape>> shape_patterns_;
+  mutable NodeHashMap<int64_t, std::shared_ptr<const InlinedHashMap<int, TensorShape>>> shape_patterns_;
 #else
-  NodeHashMap<int64_t, InlinedHashMap<int, TensorShape>> shape_patterns_;
+  NodeHashMap<int64_t, std::shared_ptr<const InlinedHashMap<int, TensorShape>>> shape_patterns_;
 #endif
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
@@ -75,13 +75,15 @@ struct ExtDataValueDeleter {
 static inline common::Status ExtDataTensorProtoToTensor(const Env& env,
                                                         const std::basic_string<PATH_CHAR_TYPE>& proto_path,
                                                         const ONNX_NAMESPACE::TensorProto& tensor_proto,
-                                                        Tensor& tensor, OrtCallback& ext_data_deleter) {
+                                                        Tensor& tensor, OrtCallback& ext_data_deleter,
+                                                        bool map_read_only = false) {
   ORT_ENFORCE(utils::HasExternalData(tensor_proto));
 
   void* ext_data_buf = nullptr;
   SafeInt<size_t> ext_data_len = 0;
   ORT_RETURN_IF_ERROR(utils::GetExtDataFromTensorProto(env, proto_path.c_str(), tensor_proto,
-                                                       ext_data_buf, ext_data_len, ext_data_deleter));
+                                                       ext_data_buf, ext_data_len, ext_data_deleter,
+                                                       map_read_only));
 
   // NB: creating a do-nothing allocator per tensor is wasteful; can perhaps be
   // avoided if the Tensor class implements the do-nothing behavior when given a
@@ -97,15 +99,44 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
                                              const ONNX_NAMESPACE::TensorProto& tensor_proto, const MemBuffer* m,
                                              const AllocatorPtr& alloc, const AllocatorPtr& default_cpu_alloc,
                                              OrtValue& ort_value, const DataTransferManager& data_transfer_mgr,
-                                             bool use_device_allocator_for_initializers = false) {
+                                             bool use_device_allocator_for_initializers = false,
+                                             bool map_external_data_read_only = false) {
   if (bool(alloc) == (m != nullptr)) {
     return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
                   "DeserializeTensorProto() takes either pre-allocated buffer or an allocator!");
   }
 
-  // Get shape and type of the tensor, and allocate the empty tensor
+  // Get shape and type of the tensor
   TensorShape tensor_shape = utils::GetTensorShapeFromTensorProto(tensor_proto);
   const DataTypeImpl* const type = DataTypeImpl::TensorTypeFromONNXEnum(tensor_proto.data_type())->GetElementType();
+
+  const OrtMemoryInfo& location = m != nullptr ? m->GetAllocInfo() : alloc->Info();
+  if (location.device.Type() == OrtDevice::CPU && utils::HasExternalData(tensor_proto) &&
+      tensor_proto.data_type() != ONNX_NAMESPACE::TensorProto_DataType_STRING) {
+    // NB: The file containing external data for the tensor is mmap'd. If the tensor will be used on CPU we can
+    // utilize the mmap'd buffer directly by calling ExtDataTensorProtoToTensor. If we called
+    // TensorProtoToTensor it would copy the data, causing unnecessary overhead.
+    // This is done before allocating the tensor so no buffer is allocated only to be replaced by the mapping.
+    auto p_tensor = std::make_unique<Tensor>();
+    OrtCallback ext_data_deleter;
+    ORT_RETURN_IF_ERROR(ExtDataTensorProtoToTensor(env, proto_path, tensor_proto, *p_tensor, ext_data_deleter,
+                                                   map_external_data_read_only));
+
+    // The external data offset is arbitrary, so the data may not be aligned for the element type.
+    // Kernels require natural alignment, so fall back to copying it into an allocated buffer in that case.
+    if (reinterpret_cast<uintptr_t>(p_tensor->DataRaw()) % type->Size() == 0) {
+      ExtDataValueDeleter deleter{ext_data_deleter, p_tensor.get()};
+
+      MLDataType ml_tensor_type = DataTypeImpl::GetType<Tensor>();
+      ort_value.Init(p_tensor.release(), ml_tensor_type, deleter);
+      return common::Status::OK();
+    }
+
+    // unmap the data now. it is read again and copied by TensorProtoToTensor below.
+    ScopedOrtCallbackInvoker release_ext_data(ext_data_deleter);
+  }
+
+  // allocate the empty tensor
   std::unique_ptr<Tensor> p_tensor;
   if (m != nullptr) {
     p_tensor = std::make_unique<Tensor>(type, tensor_shape, m->GetBuffer(), m->GetAllocInfo());
@@ -128,19 +159,6 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
 
   if (p_tensor->Location().device.Type() == OrtDevice::CPU) {
     // deserialize directly to CPU tensor
-    if (utils::HasExternalData(tensor_proto)) {
-      // NB: The file containing external data for the tensor is mmap'd. If the tensor will be used on CPU we can
-      // utilize the mmap'd buffer directly by calling ExtDataTensorProtoToTensor. If we called
-      // TensorProtoToTensor it would copy the data, causing unnecessary overhead
-      OrtCallback ext_data_deleter;
-      ORT_RETURN_IF_ERROR(ExtDataTensorProtoToTensor(env, proto_path, tensor_proto, *p_tensor, ext_data_deleter));
-
-      ExtDataValueDeleter deleter{ext_data_deleter, p_tensor.get()};
-
-      MLDataType ml_tensor_type = DataTypeImpl::GetType<Tensor>();
-      ort_value.Init(p_tensor.release(), ml_tensor_type, deleter);
-      return common::Status::OK();
-    }
     ORT_RETURN_IF_ERROR(utils::TensorProtoToTensor(env, proto_path.c_str(), tensor_proto, *p_tensor));
   } else {  // non-cpu tensor
     if (tensor_proto.data_type() == ONNX_NAMESPACE::TensorProto_DataType_STRING) {
@@ -272,6 +290,11 @@ common::Status SaveInitializedTensors(
       // do not trace string tensor
       continue;
     }
+    if (utils::HasExternalData(*entry.second) && exec_plan.GetLocation(entry.first).device.Type() == OrtDevice::CPU) {
+      // do not trace external data on CPU. it is backed by the mmap'd file, and in the rare case it needs to be
+      // copied DeserializeTensorProto allocates it separately.
+      continue;
+    }
     ORT_RETURN_IF_ERROR(planner.Trace(entry.first, entry.second));
   }
   // 2. allocate weight buffer on different locations
@@ -291,6 +314,10 @@ common::Status SaveInitializedTensors(
 
   OrtCallback deleter{nullptr, nullptr};
 
+  const bool map_external_data_read_only =
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMapExternalInitializersReadOnly,
+                                                        "0") == "1";
+
   // 3. create weight tensors based on weights buffer
   for (const auto& entry : id_to_initialized_tensor) {
     int ort_value_index = entry.first;
@@ -318,7 +345,7 @@ common::Status SaveInitializedTensors(
 
       Status st = DeserializeTensorProto(env, graph_loc, tensor_proto, (m.has_value()) ? &*m : nullptr, alloc,
                                          default_cpu_alloc, ort_value, data_transfer_mgr,
-                                         use_device_allocator_for_initializers);
+                                         use_device_allocator_for_initializers, map_external_data_read_only);
       if (!st.IsOK()) {
         std::ostringstream oss;
         oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
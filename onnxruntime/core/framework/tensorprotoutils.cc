@@ -563,7 +563,7 @@ static void DeleteCharArray(void* param) noexcept {
 
 static Status GetFileContent(
     const Env& env, const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
-    void*& raw_buffer, OrtCallback& deleter) {
+    void*& raw_buffer, OrtCallback& deleter, bool map_read_only) {
   // query length if it is 0
   if (length == 0) {
     ORT_RETURN_IF_ERROR(env.GetFileLength(file_path, length));
@@ -572,7 +572,8 @@ static Status GetFileContent(
   // first, try to map into memory
   {
     Env::MappedMemoryPtr mapped_memory{};
-    auto status = env.MapFileIntoMemory(file_path, offset, length, mapped_memory);
+    auto status = map_read_only ? env.MapFileIntoMemoryReadOnly(file_path, offset, length, mapped_memory)
+                                : env.MapFileIntoMemory(file_path, offset, length, mapped_memory);
     if (status.IsOK()) {
       deleter = mapped_memory.get_deleter().callback;
       raw_buffer = mapped_memory.release();
@@ -592,7 +593,8 @@ static Status GetFileContent(
 
 Status GetExtDataFromTensorProto(const Env& env, const ORTCHAR_T* model_path,
                                  const ONNX_NAMESPACE::TensorProto& tensor_proto,
-                                 void*& ext_data_buf, SafeInt<size_t>& ext_data_len, OrtCallback& ext_data_deleter) {
+                                 void*& ext_data_buf, SafeInt<size_t>& ext_data_len, OrtCallback& ext_data_deleter,
+                                 bool map_read_only) {
   ORT_ENFORCE(utils::HasExternalData(tensor_proto));
   std::basic_string<ORTCHAR_T> tensor_proto_dir;
   if (model_path != nullptr) {
@@ -626,7 +628,7 @@ Status GetExtDataFromTensorProto(const Env& env, const ORTCHAR_T* model_path,
                   " offset: ", file_offset, " size to read: ", static_cast<size_t>(raw_data_safe_len),
                   " given file_length: ", file_length, " are out of bounds or can not be read in full.");
     ORT_RETURN_IF_ERROR(GetFileContent(env, external_data_file_path.c_str(), file_offset, raw_data_safe_len,
-                                       ext_data_buf, ext_data_deleter));
+                                       ext_data_buf, ext_data_deleter, map_read_only));
     ext_data_len = raw_data_safe_len;
   }
 
@@ -10,6 +10,7 @@
 #include "core/graph/contrib_ops/contrib_defs.h"
 #include "core/graph/contrib_ops/shape_inference_functions.h"
 #include "onnx/onnx-ml.pb.h" // ?
+#include "onnx/defs/tensor_proto_util.h"
 
 // Suppress a warning: global initializer calls a non-constexpr function 'symbol' which is from
 // ONNX_OPERATOR_SET_SCHEMA_EX macro and only happens in debug build
@@ -441,6 +442,56 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
           ONNX_NAMESPACE::matmulShapeInference(ctx, 0, 1);
         }));
 
+constexpr const char* MatMulFpQ4_ver1_doc = R"DOC(
+Matrix product with right hand matrix being pre-packed and quantized int4 data blob.
+During quantization, the matrix is divided into blocks, where each block is a
+contiguous subset inside each column. Each block is quantized into a
+sequence of 4b integers with a scaling factor and an optional offset.
+Currently 4 quantization types are supported:
+(0): block size 32, no offset, (1): block size 32, with offset, (2): block size 64,
+no offset, (3): block size 128, no offset.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    MatMulFpQ4, 1,
+    OpSchema()
+        .SetDoc(MatMulFpQ4_ver1_doc)
+        .Attr("blk_quant_type", "Quantization type", AttributeProto::INT, static_cast<int64_t>(1))
+        .Input(0, "A", "N-dimensional matrix A", "T1")
+        .Input(1, "B", "1-dimensional data blob", "T2")
+        .Input(2, "B_shape", "Shape information of B", "T3")
+        .Output(0, "Y", "Matrix multiply results from A * B", "T1")
+        .TypeConstraint("T1", {"tensor(float)"}, "Constrain input matrix data types as single precision float tensor")
+        .TypeConstraint("T2", {"tensor(uint8)"}, "Constrain input B data types as data blob")
+        .TypeConstraint("T3", {"tensor(int64)"}, "Constrain shape of B must be int64 tensor.")
+        .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+          propagateElemTypeFromInputToOutput(ctx, 0, 0);
+          if (!hasInputShape(ctx, 0)) {
+            return;
+          }
+
+          // the output shape can only be inferred when the shape of B is a constant
+          const auto* b_shape_initializer = ctx.getInputData(2);
+          if (b_shape_initializer == nullptr) {
+            return;
+          }
+          const auto b_shape = ParseData<int64_t>(b_shape_initializer);
+          if (b_shape.size() != 2) {
+            fail_shape_inference("B_shape must contain the two dimensions K and N of B.");
+          }
+
+          const auto& a_shape = getInputShape(ctx, 0);
+          if (a_shape.dim_size() == 0) {
+            fail_shape_inference("Input A must not be a scalar.");
+          }
+          ONNX_NAMESPACE::TensorShapeProto resultShape;
+          for (int i = 0; i < a_shape.dim_size() - 1; ++i) {
+            *resultShape.add_dim() = a_shape.dim(i);
+          }
+          resultShape.add_dim()->set_dim_value(b_shape[1]);
+          updateOutputShape(ctx, 0, resultShape);
+        }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(
     QLinearAdd, 1,
     OpSchema().FillUsing(QLinearMathDocGenerator(
@@ -0,0 +1,180 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4gemm_avx2.cpp
+
+Abstract:
+
+    This module implements the Q4GEMM kernel with AVX2 and FMA3
+    instructions. The int4 values of B are expanded to fp32 in registers, so
+    B is only read from memory in its compressed form.
+
+--*/
+
+#include "q4gemm.h"
+
+//
+// Number of columns of B computed together, sharing the loads of A.
+//
+
+constexpr size_t MLAS_Q4GEMM_AVX2_COLUMNS = 4;
+
+MLAS_FORCEINLINE
+float
+MlasQ4ReduceAddFloat32x8Avx2(
+    __m256 Vector
+    )
+{
+    __m128 Sum = _mm_add_ps(_mm256_castps256_ps128(Vector), _mm256_extractf128_ps(Vector, 1));
+    Sum = _mm_add_ps(Sum, _mm_movehl_ps(Sum, Sum));
+    Sum = _mm_add_ss(Sum, _mm_movehdup_ps(Sum));
+    return _mm_cvtss_f32(Sum);
+}
+
+template<typename Q4Type, size_t NCols>
+MLAS_FORCEINLINE
+void
+MlasQ4GemmRowAvx2(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountK,
+    size_t ldb,
+    const float* Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine computes NCols values of one row of C.
+
+    For each block, the products of A with the quantized values of B and the
+    sum of A are accumulated separately, the block result then being
+    (SumQ - ZeroPoint * SumA) * Scale. The lanes are only reduced at the end.
+
+--*/
+{
+    const __m128i LowMask = _mm_set1_epi8(0x0F);
+
+    __m256 Acc[NCols];
+    for (size_t j = 0; j < NCols; j++) {
+        Acc[j] = _mm256_setzero_ps();
+    }
+
+    const uint8_t* Blob = PackedB;
+
+    for (size_t k = 0; k < CountK; k += Q4Type::BlkLen) {
+        const size_t CountBlk = std::min(CountK - k, Q4Type::BlkLen);
+
+        __m256 SumQ[NCols];
+        for (size_t j = 0; j < NCols; j++) {
+            SumQ[j] = _mm256_setzero_ps();
+        }
+        __m256 SumA = _mm256_setzero_ps();
+
+        for (size_t kk = 0; kk < CountBlk; kk += MLAS_Q4_BLK_CHUNK) {
+            const size_t CountChunk = std::min(CountBlk - kk, MLAS_Q4_BLK_CHUNK);
+
+            //
+            // Copy a partial chunk of A to a zero padded buffer, so the
+            // padding values of the B block do not contribute.
+            //
+
+            MLAS_DECLSPEC_ALIGN(float PaddedA[MLAS_Q4_BLK_CHUNK], 32);
+            const float* a = A + k + kk;
+            if (CountChunk < MLAS_Q4_BLK_CHUNK) {
+                std::fill_n(PaddedA, MLAS_Q4_BLK_CHUNK, 0.0f);
+                std::copy_n(a, CountChunk, PaddedA);
+                a = PaddedA;
+            }
+
+            const __m256 a0 = _mm256_loadu_ps(a);
+            const __m256 a1 = _mm256_loadu_ps(a + 8);
+            const __m256 a2 = _mm256_loadu_ps(a + 16);
+            const __m256 a3 = _mm256_loadu_ps(a + 24);
+            SumA = _mm256_add_ps(SumA, _mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+
+            for (size_t j = 0; j < NCols; j++) {
+                const uint8_t* Data = MlasQ4BlkData<Q4Type>(Blob + j * ldb) + kk / 2;
+                const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data));
+                const __m128i Lo = _mm_and_si128(Bytes, LowMask);
+                const __m128i Hi = _mm_and_si128(_mm_srli_epi16(Bytes, 4), LowMask);
+
+                const __m256 b0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(Lo));
+                const __m256 b1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(Lo, 8)));
+                const __m256 b2 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(Hi));
+                const __m256 b3 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(Hi, 8)));
+
+                SumQ[j] = _mm256_fmadd_ps(a0, b0, SumQ[j]);
+                SumQ[j] = _mm256_fmadd_ps(a1, b1, SumQ[j]);
+                SumQ[j] = _mm256_fmadd_ps(a2, b2, SumQ[j]);
+                SumQ[j] = _mm256_fmadd_ps(a3, b3, SumQ[j]);
+            }
+        }
+
+        for (size_t j = 0; j < NCols; j++) {
+            const float Scale = MlasQ4BlkScale<Q4Type>(Blob + j * ldb);
+            const float ZeroPoint = float(MlasQ4BlkZeroPoint<Q4Type>(Blob + j * ldb));
+            Acc[j] = _mm256_fmadd_ps(SumQ[j], _mm256_set1_ps(Scale), Acc[j]);
+            Acc[j] = _mm256_fmadd_ps(SumA, _mm256_set1_ps(-ZeroPoint * Scale), Acc[j]);
+        }
+
+        Blob += Q4Type::BlobSize;
+    }
+
+    for (size_t j = 0; j < NCols; j++) {
+        C[j] = MlasQ4ReduceAddFloat32x8Avx2(Acc[j]) + ((Bias == nullptr) ? 0.0f : Bias[j]);
+    }
+}
+
+template<typename Q4Type>
+void
+MLASCALL
+MlasQ4GemmKernelAvx2(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    size_t lda,
+    size_t ldb,
+    size_t ldc,
+    const float* Bias
+    )
+{
+    //
+    // Step through the columns of B, so that the packed columns being
+    // processed stay in the cache while computing every row of A.
+    //
+
+    size_t n = 0;
+
+    for (; n + MLAS_Q4GEMM_AVX2_COLUMNS <= CountN; n += MLAS_Q4GEMM_AVX2_COLUMNS) {
+        for (size_t m = 0; m < CountM; m++) {
+            MlasQ4GemmRowAvx2<Q4Type, MLAS_Q4GEMM_AVX2_COLUMNS>(
+                A + m * lda, PackedB + n * ldb, C + m * ldc + n, CountK, ldb,
+                (Bias == nullptr) ? nullptr : Bias + n);
+        }
+    }
+
+    for (; n < CountN; n++) {
+        for (size_t m = 0; m < CountM; m++) {
+            MlasQ4GemmRowAvx2<Q4Type, 1>(
+                A + m * lda, PackedB + n * ldb, C + m * ldc + n, CountK, ldb,
+                (Bias == nullptr) ? nullptr : Bias + n);
+        }
+    }
+}
+
+const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchAvx2 = {{
+    MlasQ4GemmKernelAvx2<MLAS_Q4TYPE_BLK0>,
+    MlasQ4GemmKernelAvx2<MLAS_Q4TYPE_BLK1>,
+    MlasQ4GemmKernelAvx2<MLAS_Q4TYPE_BLK2>,
+    MlasQ4GemmKernelAvx2<MLAS_Q4TYPE_BLK3>,
+}};
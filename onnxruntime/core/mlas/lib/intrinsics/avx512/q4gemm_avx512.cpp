@@ -0,0 +1,158 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4gemm_avx512.cpp
+
+Abstract:
+
+    This module implements the Q4GEMM kernel with AVX512F instructions. The
+    int4 values of B are expanded to fp32 in registers, so B is only read
+    from memory in its compressed form.
+
+--*/
+
+#include "q4gemm.h"
+
+//
+// Number of columns of B computed together, sharing the loads of A.
+//
+
+constexpr size_t MLAS_Q4GEMM_AVX512_COLUMNS = 4;
+
+template<typename Q4Type, size_t NCols>
+MLAS_FORCEINLINE
+void
+MlasQ4GemmRowAvx512(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountK,
+    size_t ldb,
+    const float* Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine computes NCols values of one row of C.
+
+    For each block, the products of A with the quantized values of B and the
+    sum of A are accumulated separately, the block result then being
+    (SumQ - ZeroPoint * SumA) * Scale. The lanes are only reduced at the end.
+
+--*/
+{
+    const __m128i LowMask = _mm_set1_epi8(0x0F);
+
+    __m512 Acc[NCols];
+    for (size_t j = 0; j < NCols; j++) {
+        Acc[j] = _mm512_setzero_ps();
+    }
+
+    const uint8_t* Blob = PackedB;
+
+    for (size_t k = 0; k < CountK; k += Q4Type::BlkLen) {
+        const size_t CountBlk = std::min(CountK - k, Q4Type::BlkLen);
+
+        __m512 SumQ[NCols];
+        for (size_t j = 0; j < NCols; j++) {
+            SumQ[j] = _mm512_setzero_ps();
+        }
+        __m512 SumA = _mm512_setzero_ps();
+
+        for (size_t kk = 0; kk < CountBlk; kk += MLAS_Q4_BLK_CHUNK) {
+            const size_t CountChunk = std::min(CountBlk - kk, MLAS_Q4_BLK_CHUNK);
+
+            __m512 a0;
+            __m512 a1;
+            if (CountChunk == MLAS_Q4_BLK_CHUNK) {
+                a0 = _mm512_loadu_ps(A + k + kk);
+                a1 = _mm512_loadu_ps(A + k + kk + 16);
+            } else {
+                const __mmask16 Mask0 = __mmask16((CountChunk >= 16) ? 0xFFFF : (1u << CountChunk) - 1);
+                const __mmask16 Mask1 = __mmask16((CountChunk > 16) ? (1u << (CountChunk - 16)) - 1 : 0);
+                a0 = _mm512_maskz_loadu_ps(Mask0, A + k + kk);
+                a1 = _mm512_maskz_loadu_ps(Mask1, A + k + kk + 16);
+            }
+            SumA = _mm512_add_ps(SumA, _mm512_add_ps(a0, a1));
+
+            for (size_t j = 0; j < NCols; j++) {
+                const uint8_t* Data = MlasQ4BlkData<Q4Type>(Blob + j * ldb) + kk / 2;
+                const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data));
+                const __m128i Lo = _mm_and_si128(Bytes, LowMask);
+                const __m128i Hi = _mm_and_si128(_mm_srli_epi16(Bytes, 4), LowMask);
+
+                const __m512 b0 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(Lo));
+                const __m512 b1 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(Hi));
+
+                SumQ[j] = _mm512_fmadd_ps(a0, b0, SumQ[j]);
+                SumQ[j] = _mm512_fmadd_ps(a1, b1, SumQ[j]);
+            }
+        }
+
+        for (size_t j = 0; j < NCols; j++) {
+            const float Scale = MlasQ4BlkScale<Q4Type>(Blob + j * ldb);
+            const float ZeroPoint = float(MlasQ4BlkZeroPoint<Q4Type>(Blob + j * ldb));
+            Acc[j] = _mm512_fmadd_ps(SumQ[j], _mm512_set1_ps(Scale), Acc[j]);
+            Acc[j] = _mm512_fmadd_ps(SumA, _mm512_set1_ps(-ZeroPoint * Scale), Acc[j]);
+        }
+
+        Blob += Q4Type::BlobSize;
+    }
+
+    for (size_t j = 0; j < NCols; j++) {
+        C[j] = _mm512_reduce_add_ps(Acc[j]) + ((Bias == nullptr) ? 0.0f : Bias[j]);
+    }
+}
+
+template<typename Q4Type>
+void
+MLASCALL
+MlasQ4GemmKernelAvx512(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    size_t lda,
+    size_t ldb,
+    size_t ldc,
+    const float* Bias
+    )
+{
+    //
+    // Step through the columns of B, so that the packed columns being
+    // processed stay in the cache while computing every row of A.
+    //
+
+    size_t n = 0;
+
+    for (; n + MLAS_Q4GEMM_AVX512_COLUMNS <= CountN; n += MLAS_Q4GEMM_AVX512_COLUMNS) {
+        for (size_t m = 0; m < CountM; m++) {
+            MlasQ4GemmRowAvx512<Q4Type, MLAS_Q4GEMM_AVX512_COLUMNS>(
+                A + m * lda, PackedB + n * ldb, C + m * ldc + n, CountK, ldb,
+                (Bias == nullptr) ? nullptr : Bias + n);
+        }
+    }
+
+    for (; n < CountN; n++) {
+        for (size_t m = 0; m < CountM; m++) {
+            MlasQ4GemmRowAvx512<Q4Type, 1>(
+                A + m * lda, PackedB + n * ldb, C + m * ldc + n, CountK, ldb,
+                (Bias == nullptr) ? nullptr : Bias + n);
+        }
+    }
+}
+
+const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchAvx512 = {{
+    MlasQ4GemmKernelAvx512<MLAS_Q4TYPE_BLK0>,
+    MlasQ4GemmKernelAvx512<MLAS_Q4TYPE_BLK1>,
+    MlasQ4GemmKernelAvx512<MLAS_Q4TYPE_BLK2>,
+    MlasQ4GemmKernelAvx512<MLAS_Q4TYPE_BLK3>,
+}};
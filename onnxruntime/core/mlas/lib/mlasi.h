@@ -842,6 +842,16 @@ struct MLAS_SYMM_QGEMM_DISPATCH;
 extern const MLAS_SYMM_QGEMM_DISPATCH MlasSymmQgemmS8DispatchNeon;
 extern const MLAS_SYMM_QGEMM_DISPATCH MlasSymmQgemmS8DispatchSdot;
 
+//
+// Blockwise int4 quantized weights gemm dispatch structure.
+//
+
+struct MLAS_Q4GEMM_DISPATCH;
+
+extern const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchDefault;
+extern const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchAvx2;
+extern const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchAvx512;
+
 //
 // Symmetric quantized integer convolution dispatch structure.
 //
@@ -930,6 +940,7 @@ struct MLAS_PLATFORM {
     const MLAS_GEMM_QUANT_DISPATCH* GemmU8X8Dispatch;
 #endif
     const MLAS_SYMM_QGEMM_DISPATCH* SymmQgemmDispatch{nullptr};
+    const MLAS_Q4GEMM_DISPATCH* Q4GemmDispatch{&MlasQ4GemmDispatchDefault};
 
     const MLAS_CONV_SYM_DISPATCH* ConvSymU8S8Dispatch{nullptr};
     const MLAS_CONV_SYM_DISPATCH* ConvSymS8S8Dispatch{nullptr};
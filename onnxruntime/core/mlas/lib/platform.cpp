@@ -329,6 +329,7 @@ Return Value:
                 this->ConvDepthwiseS8S8Kernel = MlasConvDepthwiseKernelAvx2<int8_t, int8_t>;
                 this->ConvDepthwiseS8U8Kernel = MlasConvDepthwiseKernelAvx2<int8_t, uint8_t>;
                 this->ComputeSumExpF32Kernel = MlasComputeSumExpF32KernelFma3;
+                this->Q4GemmDispatch = &MlasQ4GemmDispatchAvx2;
 
                 //
                 // Check if the processor supports Hybrid core architecture.
@@ -379,6 +380,7 @@ Return Value:
                     this->ComputeSumExpF32Kernel = MlasComputeSumExpF32KernelAvx512F;
                     this->QuantizeLinearS8Kernel = MlasQuantizeLinearS8KernelAvx512F;
                     this->QuantizeLinearU8Kernel = MlasQuantizeLinearU8KernelAvx512F;
+                    this->Q4GemmDispatch = &MlasQ4GemmDispatchAvx512;
                     this->NchwcBlockSize = 16;
                     this->PreferredBufferAlignment = 64;
 
@@ -0,0 +1,142 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4_dq.cpp
+
+Abstract:
+
+    This module contains the data structures and implementations
+    for blocked int4 quantization and dequantization.
+
+    Int4 block quantization is used to compress weight tensors of large
+    language models.
+
+--*/
+
+#include "q4common.h"
+
+template<typename Q4Type>
+size_t
+MlasQ4GemmPackBSizeImpl(size_t N, size_t K)
+{
+    return N * MlasQ4BlobStride<Q4Type>(K);
+}
+
+size_t
+MLASCALL
+MlasQ4GemmPackBSize(
+    MLAS_BLK_QUANT_TYPE QType,
+    size_t N,
+    size_t K
+    )
+{
+    switch (QType) {
+        case BlkQ4Sym:
+            return MlasQ4GemmPackBSizeImpl<MLAS_Q4TYPE_BLK0>(N, K);
+        case BlkQ4Zp8:
+            return MlasQ4GemmPackBSizeImpl<MLAS_Q4TYPE_BLK1>(N, K);
+        case BlkQ4Sym64:
+            return MlasQ4GemmPackBSizeImpl<MLAS_Q4TYPE_BLK2>(N, K);
+        case BlkQ4Sym128:
+            return MlasQ4GemmPackBSizeImpl<MLAS_Q4TYPE_BLK3>(N, K);
+        default:
+            return 0;
+    }
+}
+
+template<typename Q4Type>
+void
+MlasQ4GemmPackBImpl(
+    void* PackedBuf,
+    const float* FpData,
+    size_t N,
+    size_t K,
+    size_t ldb
+    )
+{
+    auto* Blob = static_cast<uint8_t*>(PackedBuf);
+
+    for (size_t n = 0; n < N; n++) {
+        for (size_t k = 0; k < K; k += Q4Type::BlkLen) {
+            const size_t CountK = std::min(K - k, Q4Type::BlkLen);
+            MlasQ4QuantizeBlock<Q4Type>(Blob, FpData + k * ldb + n, ldb, CountK);
+            Blob += Q4Type::BlobSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasQ4GemmPackB(
+    MLAS_BLK_QUANT_TYPE QType,
+    void* PackedBuf,
+    const float* FpData,
+    size_t N,
+    size_t K,
+    size_t ldb
+    )
+{
+    switch (QType) {
+        case BlkQ4Sym:
+            return MlasQ4GemmPackBImpl<MLAS_Q4TYPE_BLK0>(PackedBuf, FpData, N, K, ldb);
+        case BlkQ4Zp8:
+            return MlasQ4GemmPackBImpl<MLAS_Q4TYPE_BLK1>(PackedBuf, FpData, N, K, ldb);
+        case BlkQ4Sym64:
+            return MlasQ4GemmPackBImpl<MLAS_Q4TYPE_BLK2>(PackedBuf, FpData, N, K, ldb);
+        case BlkQ4Sym128:
+            return MlasQ4GemmPackBImpl<MLAS_Q4TYPE_BLK3>(PackedBuf, FpData, N, K, ldb);
+        default:
+            MLAS_THROW_EX(std::runtime_error, "unsupported quantization type for MlasQ4GemmPackB");
+    }
+}
+
+template<typename Q4Type>
+void
+MlasQ4GemmUnPackBImpl(
+    float* FpData,
+    const void* PackedBuf,
+    size_t N,
+    size_t K,
+    size_t ldb
+    )
+{
+    const auto* Blob = static_cast<const uint8_t*>(PackedBuf);
+
+    for (size_t n = 0; n < N; n++) {
+        for (size_t k = 0; k < K; k += Q4Type::BlkLen) {
+            const size_t CountK = std::min(K - k, Q4Type::BlkLen);
+            MlasQ4DequantizeBlock<Q4Type>(FpData + k * ldb + n, Blob, ldb, CountK);
+            Blob += Q4Type::BlobSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasQ4GemmUnPackB(
+    MLAS_BLK_QUANT_TYPE QType,
+    float* FpData,
+    const void* PackedBuf,
+    size_t N,
+    size_t K,
+    size_t ldb
+    )
+{
+    switch (QType) {
+        case BlkQ4Sym:
+            return MlasQ4GemmUnPackBImpl<MLAS_Q4TYPE_BLK0>(FpData, PackedBuf, N, K, ldb);
+        case BlkQ4Zp8:
+            return MlasQ4GemmUnPackBImpl<MLAS_Q4TYPE_BLK1>(FpData, PackedBuf, N, K, ldb);
+        case BlkQ4Sym64:
+            return MlasQ4GemmUnPackBImpl<MLAS_Q4TYPE_BLK2>(FpData, PackedBuf, N, K, ldb);
+        case BlkQ4Sym128:
+            return MlasQ4GemmUnPackBImpl<MLAS_Q4TYPE_BLK3>(FpData, PackedBuf, N, K, ldb);
+        default:
+            MLAS_THROW_EX(std::runtime_error, "unsupported quantization type for MlasQ4GemmUnPackB");
+    }
+}
@@ -0,0 +1,212 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4common.h
+
+Abstract:
+
+    Define int4 block quantization types.
+
+    Each column of the weight matrix B is split along the K dimension into
+    blocks of BlkLen values. A block is stored as a blob:
+
+        float    scale
+        uint8_t  zero point      (only present for types with a zero point)
+        uint8_t  data[BlkLen/2]  (two int4 values per byte)
+
+    The blobs of one column are stored contiguously, followed by the blobs
+    of the next column. Within every run of 32 values of a block, byte j
+    holds value j in its low nibble and value j + 16 in its high nibble, so
+    that a vector kernel can expand 16 bytes into 32 consecutive values with
+    a mask and a shift.
+
+    A value is dequantized as (q - zero_point) * scale. Symmetric types use
+    a fixed zero point of 8.
+
+--*/
+
+#pragma once
+
+#include "mlasi.h"
+#include "mlas_q4.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+/**
+ * @brief Blob layout of int4 symmetric quantization, 32 values per block.
+ */
+struct MLAS_Q4TYPE_BLK0 {
+    static constexpr size_t BlkLen = 32;
+    static constexpr bool HasZeroPoint = false;
+    static constexpr size_t BlobSize = sizeof(float) + BlkLen / 2;
+};
+
+/**
+ * @brief Blob layout of int4 quantization with zero point, 32 values per block.
+ */
+struct MLAS_Q4TYPE_BLK1 {
+    static constexpr size_t BlkLen = 32;
+    static constexpr bool HasZeroPoint = true;
+    static constexpr size_t BlobSize = sizeof(float) + sizeof(uint8_t) + BlkLen / 2;
+};
+
+/**
+ * @brief Blob layout of int4 symmetric quantization, 64 values per block.
+ */
+struct MLAS_Q4TYPE_BLK2 {
+    static constexpr size_t BlkLen = 64;
+    static constexpr bool HasZeroPoint = false;
+    static constexpr size_t BlobSize = sizeof(float) + BlkLen / 2;
+};
+
+/**
+ * @brief Blob layout of int4 symmetric quantization, 128 values per block.
+ */
+struct MLAS_Q4TYPE_BLK3 {
+    static constexpr size_t BlkLen = 128;
+    static constexpr bool HasZeroPoint = false;
+    static constexpr size_t BlobSize = sizeof(float) + BlkLen / 2;
+};
+
+/**
+ * @brief Number of values covered by one 16 byte load of block data.
+ */
+constexpr size_t MLAS_Q4_BLK_CHUNK = 32;
+
+template<typename Q4Type>
+MLAS_FORCEINLINE
+float
+MlasQ4BlkScale(const uint8_t* Blob)
+{
+    float Scale;
+    memcpy(&Scale, Blob, sizeof(float));
+    return Scale;
+}
+
+template<typename Q4Type>
+MLAS_FORCEINLINE
+uint8_t
+MlasQ4BlkZeroPoint(const uint8_t* Blob)
+{
+    return Q4Type::HasZeroPoint ? Blob[sizeof(float)] : uint8_t(8);
+}
+
+template<typename Q4Type>
+MLAS_FORCEINLINE
+const uint8_t*
+MlasQ4BlkData(const uint8_t* Blob)
+{
+    return Blob + sizeof(float) + (Q4Type::HasZeroPoint ? sizeof(uint8_t) : 0);
+}
+
+/**
+ * @brief Returns the number of bytes of one packed column of B.
+ */
+template<typename Q4Type>
+MLAS_FORCEINLINE
+size_t
+MlasQ4BlobStride(size_t K)
+{
+    return MlasDivRoundup(K, Q4Type::BlkLen) * Q4Type::BlobSize;
+}
+
+/**
+ * @brief Quantizes one block of a column of B.
+ *
+ * @param Blob      destination blob
+ * @param Src       address of the first value of the block
+ * @param ldb       distance between two consecutive values of the column
+ * @param Count     number of valid values, the rest of the block is padded
+ *                  with values that dequantize to zero
+ */
+template<typename Q4Type>
+MLAS_FORCEINLINE
+void
+MlasQ4QuantizeBlock(
+    uint8_t* Blob,
+    const float* Src,
+    size_t ldb,
+    size_t Count
+    )
+{
+    float Scale;
+    int32_t ZeroPoint;
+
+    if (Q4Type::HasZeroPoint) {
+        float Min = 0.0f;
+        float Max = 0.0f;
+        for (size_t k = 0; k < Count; k++) {
+            const float v = Src[k * ldb];
+            Min = std::min(Min, v);
+            Max = std::max(Max, v);
+        }
+        Scale = (Max - Min) / 15.0f;
+        const float ZeroPointFp = (Scale != 0.0f) ? -Min / Scale : 0.0f;
+        ZeroPoint = std::clamp(int32_t(nearbyintf(ZeroPointFp)), 0, 15);
+        Blob[sizeof(float)] = uint8_t(ZeroPoint);
+    } else {
+        // Map the value with the largest magnitude to -8, so the full
+        // [-8, 7] range is used.
+        float AbsMax = 0.0f;
+        float Max = 0.0f;
+        for (size_t k = 0; k < Count; k++) {
+            const float v = Src[k * ldb];
+            if (fabsf(v) > AbsMax) {
+                AbsMax = fabsf(v);
+                Max = v;
+            }
+        }
+        Scale = Max / -8.0f;
+        ZeroPoint = 8;
+    }
+
+    memcpy(Blob, &Scale, sizeof(float));
+
+    const float ReciprocalScale = (Scale != 0.0f) ? 1.0f / Scale : 0.0f;
+    uint8_t* Data = Blob + sizeof(float) + (Q4Type::HasZeroPoint ? sizeof(uint8_t) : 0);
+
+    for (size_t chunk = 0; chunk < Q4Type::BlkLen; chunk += MLAS_Q4_BLK_CHUNK) {
+        uint8_t q[MLAS_Q4_BLK_CHUNK];
+        for (size_t i = 0; i < MLAS_Q4_BLK_CHUNK; i++) {
+            const size_t k = chunk + i;
+            const float v = (k < Count) ? Src[k * ldb] : 0.0f;
+            q[i] = uint8_t(std::clamp(int32_t(nearbyintf(v * ReciprocalScale)) + ZeroPoint, 0, 15));
+        }
+        for (size_t i = 0; i < MLAS_Q4_BLK_CHUNK / 2; i++) {
+            Data[chunk / 2 + i] = uint8_t(q[i] | (q[i + MLAS_Q4_BLK_CHUNK / 2] << 4));
+        }
+    }
+}
+
+/**
+ * @brief Dequantizes the valid values of one block of a column of B.
+ */
+template<typename Q4Type>
+MLAS_FORCEINLINE
+void
+MlasQ4DequantizeBlock(
+    float* Dst,
+    const uint8_t* Blob,
+    size_t ldb,
+    size_t Count
+    )
+{
+    const float Scale = MlasQ4BlkScale<Q4Type>(Blob);
+    const int32_t ZeroPoint = MlasQ4BlkZeroPoint<Q4Type>(Blob);
+    const uint8_t* Data = MlasQ4BlkData<Q4Type>(Blob);
+
+    for (size_t k = 0; k < Count; k++) {
+        const size_t chunk = k / MLAS_Q4_BLK_CHUNK * MLAS_Q4_BLK_CHUNK;
+        const size_t i = k % MLAS_Q4_BLK_CHUNK;
+        const uint8_t Byte = Data[chunk / 2 + i % (MLAS_Q4_BLK_CHUNK / 2)];
+        const int32_t q = (i < MLAS_Q4_BLK_CHUNK / 2) ? (Byte & 0x0F) : (Byte >> 4);
+        Dst[k * ldb] = float(q - ZeroPoint) * Scale;
+    }
+}
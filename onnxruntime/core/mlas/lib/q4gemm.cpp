@@ -0,0 +1,276 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4gemm.cpp
+
+Abstract:
+
+    This module implements the fp32 matrix multiplication with compressed
+    weight tensor (right hand side). The assumption is the right hand side
+    tensor can be pre-packed and compressed using int-4 quantization to save
+    memory and memory bandwidth.
+
+--*/
+
+#include "q4gemm.h"
+
+template<typename Q4Type>
+void
+MLASCALL
+MlasQ4GemmKernelDefault(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    size_t lda,
+    size_t ldb,
+    size_t ldc,
+    const float* Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine is the portable implementation of the Q4GEMM kernel. The
+    products of each block are accumulated on the quantized values, and the
+    block scale and zero point are applied once per block.
+
+--*/
+{
+    for (size_t m = 0; m < CountM; m++) {
+        const float* a = A + m * lda;
+
+        for (size_t n = 0; n < CountN; n++) {
+            const uint8_t* Blob = PackedB + n * ldb;
+            float Sum = (Bias == nullptr) ? 0.0f : Bias[n];
+
+            for (size_t k = 0; k < CountK; k += Q4Type::BlkLen) {
+                const size_t CountBlk = std::min(CountK - k, Q4Type::BlkLen);
+                const float Scale = MlasQ4BlkScale<Q4Type>(Blob);
+                const float ZeroPoint = float(MlasQ4BlkZeroPoint<Q4Type>(Blob));
+                const uint8_t* Data = MlasQ4BlkData<Q4Type>(Blob);
+
+                float SumQ = 0.0f;
+                float SumA = 0.0f;
+                for (size_t kk = 0; kk < CountBlk; kk++) {
+                    const size_t chunk = kk / MLAS_Q4_BLK_CHUNK * MLAS_Q4_BLK_CHUNK;
+                    const size_t i = kk % MLAS_Q4_BLK_CHUNK;
+                    const uint8_t Byte = Data[chunk / 2 + i % (MLAS_Q4_BLK_CHUNK / 2)];
+                    const float q = float((i < MLAS_Q4_BLK_CHUNK / 2) ? (Byte & 0x0F) : (Byte >> 4));
+                    SumQ += a[k + kk] * q;
+                    SumA += a[k + kk];
+                }
+                Sum += (SumQ - ZeroPoint * SumA) * Scale;
+
+                Blob += Q4Type::BlobSize;
+            }
+
+            C[m * ldc + n] = Sum;
+        }
+    }
+}
+
+const MLAS_Q4GEMM_DISPATCH MlasQ4GemmDispatchDefault = {{
+    MlasQ4GemmKernelDefault<MLAS_Q4TYPE_BLK0>,
+    MlasQ4GemmKernelDefault<MLAS_Q4TYPE_BLK1>,
+    MlasQ4GemmKernelDefault<MLAS_Q4TYPE_BLK2>,
+    MlasQ4GemmKernelDefault<MLAS_Q4TYPE_BLK3>,
+}};
+
+template<typename Q4Type>
+void
+MlasQ4GemmDequantOperation(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    size_t lda,
+    size_t ldb,
+    size_t ldc,
+    const float* Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a tile of the Q4GEMM operation with many rows by
+    dequantizing panels of B to fp32 and multiplying them with SGEMM.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_Q4GEMM_STRIDEN * MLAS_Q4GEMM_STRIDEK], 16 * sizeof(float));
+
+    static_assert(MLAS_Q4GEMM_STRIDEK % Q4Type::BlkLen == 0, "K stride must cover whole blocks");
+
+    size_t StrideN;
+    for (size_t n = 0; n < CountN; n += StrideN) {
+        StrideN = std::min(CountN - n, size_t(MLAS_Q4GEMM_STRIDEN));
+
+        size_t StrideK;
+        for (size_t k = 0; k < CountK; k += StrideK) {
+            StrideK = std::min(CountK - k, size_t(MLAS_Q4GEMM_STRIDEK));
+
+            for (size_t nn = 0; nn < StrideN; nn++) {
+                const uint8_t* Blob = PackedB + (n + nn) * ldb + (k / Q4Type::BlkLen) * Q4Type::BlobSize;
+                for (size_t kk = 0; kk < StrideK; kk += Q4Type::BlkLen) {
+                    const size_t CountBlk = std::min(StrideK - kk, Q4Type::BlkLen);
+                    MlasQ4DequantizeBlock<Q4Type>(PanelB + kk * StrideN + nn, Blob, StrideN, CountBlk);
+                    Blob += Q4Type::BlobSize;
+                }
+            }
+
+            MlasGemm(CblasNoTrans, CblasNoTrans, CountM, StrideN, StrideK, 1.0f,
+                     A + k, lda, PanelB, StrideN, (k == 0) ? 0.0f : 1.0f, C + n, ldc, nullptr);
+        }
+
+        if (Bias != nullptr) {
+            for (size_t m = 0; m < CountM; m++) {
+                float* c = C + m * ldc + n;
+                for (size_t nn = 0; nn < StrideN; nn++) {
+                    c[nn] += Bias[n + nn];
+                }
+            }
+        }
+    }
+}
+
+static
+void
+MlasQ4GemmOperation(
+    MLAS_BLK_QUANT_TYPE QType,
+    const size_t K,
+    const MLAS_Q4_GEMM_DATA_PARAMS* Data,
+    const size_t RangeStartM,
+    const size_t RangeCountM,
+    const size_t RangeStartN,
+    const size_t RangeCountN
+    )
+{
+    const size_t lda = Data->lda;
+    const size_t ldc = Data->ldc;
+    const size_t ldb = MlasQ4GemmPackBSize(QType, 1, K);
+
+    const float* A = Data->A + RangeStartM * lda;
+    const uint8_t* PackedB = static_cast<const uint8_t*>(Data->B) + RangeStartN * ldb;
+    float* C = Data->C + RangeStartM * ldc + RangeStartN;
+    const float* Bias = (Data->Bias == nullptr) ? nullptr : Data->Bias + RangeStartN;
+
+    if (RangeCountM <= MLAS_Q4GEMM_KERNEL_MAXM || K == 0) {
+        MLAS_Q4GEMM_KERNEL* Kernel = GetMlasPlatform().Q4GemmDispatch->Kernels[QType];
+        Kernel(A, PackedB, C, RangeCountM, RangeCountN, K, lda, ldb, ldc, Bias);
+        return;
+    }
+
+    switch (QType) {
+        case BlkQ4Sym:
+            return MlasQ4GemmDequantOperation<MLAS_Q4TYPE_BLK0>(
+                A, PackedB, C, RangeCountM, RangeCountN, K, lda, ldb, ldc, Bias);
+        case BlkQ4Zp8:
+            return MlasQ4GemmDequantOperation<MLAS_Q4TYPE_BLK1>(
+                A, PackedB, C, RangeCountM, RangeCountN, K, lda, ldb, ldc, Bias);
+        case BlkQ4Sym64:
+            return MlasQ4GemmDequantOperation<MLAS_Q4TYPE_BLK2>(
+                A, PackedB, C, RangeCountM, RangeCountN, K, lda, ldb, ldc, Bias);
+        case BlkQ4Sym128:
+            return MlasQ4GemmDequantOperation<MLAS_Q4TYPE_BLK3>(
+                A, PackedB, C, RangeCountM, RangeCountN, K, lda, ldb, ldc, Bias);
+        default:
+            MLAS_THROW_EX(std::runtime_error, "unsupported quantization type for MlasQ4GemmBatch");
+    }
+}
+
+void
+MLASCALL
+MlasQ4GemmBatch(
+    MLAS_BLK_QUANT_TYPE QType,
+    const size_t M,
+    const size_t N,
+    const size_t K,
+    const size_t BatchN,
+    const MLAS_Q4_GEMM_DATA_PARAMS* DataParams,
+    MLAS_THREADPOOL* ThreadPool
+    )
+{
+    if (QType < BlkQ4Sym || QType > BlkQ4Sym128) {
+        MLAS_THROW_EX(std::runtime_error, "unsupported quantization type for MlasQ4GemmBatch");
+    }
+
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    if (ThreadPool == nullptr) {
+        for (size_t gemm_i = 0; gemm_i < BatchN; gemm_i++) {
+            MlasQ4GemmOperation(QType, K, &DataParams[gemm_i], 0, M, 0, N);
+        }
+        return;
+    }
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    const double Complexity = double(M) * double(N) * double(K) * double(BatchN);
+
+    ptrdiff_t TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_QGEMM_THREAD_COMPLEXITY)) + 1;
+
+    ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    ptrdiff_t ThreadsPerGemm = TargetThreadCount / BatchN;
+    if (ThreadsPerGemm < 1) {
+        ThreadsPerGemm = 1;
+    }
+
+    //
+    // Partition the work along N first: every tile along M reads (and for
+    // the larger M, dequantizes) the whole B panel again.
+    //
+
+    const size_t StrideM = (M <= MLAS_Q4GEMM_KERNEL_MAXM) ? M : size_t(MLAS_Q4GEMM_STRIDEM);
+    const size_t BlockedM = MlasDivRoundup(M, StrideM);
+
+    size_t nc = N;
+    if (ThreadsPerGemm > 1) {
+        const size_t max_nc = MlasDivRoundup(N * BlockedM, ThreadsPerGemm);
+        if (max_nc < nc) {
+            nc = std::min(nc, MlasDivRoundup(max_nc, MLAS_QGEMM_STRIDEN_THREAD_ALIGN) *
+                                  MLAS_QGEMM_STRIDEN_THREAD_ALIGN);
+        }
+    }
+    const size_t StrideN = nc;
+
+    const size_t ThreadCountM = BlockedM;
+    const size_t ThreadCountN = MlasDivRoundup(N, StrideN);
+    ThreadsPerGemm = ThreadCountM * ThreadCountN;
+
+    MlasTrySimpleParallel(ThreadPool, ThreadsPerGemm * BatchN, [&](ptrdiff_t tid) {
+        const auto gemm_i = tid / ThreadsPerGemm;
+        const auto blk_i = tid % ThreadsPerGemm;
+        auto Data = &DataParams[gemm_i];
+
+        const ptrdiff_t ThreadIdN = blk_i / ThreadCountM;
+        const ptrdiff_t ThreadIdM = blk_i % ThreadCountM;
+
+        const size_t RangeStartM = ThreadIdM * StrideM;
+        const size_t RangeCountM = std::min(M - RangeStartM, StrideM);
+
+        const size_t RangeStartN = ThreadIdN * StrideN;
+        const size_t RangeCountN = std::min(N - RangeStartN, StrideN);
+
+        MlasQ4GemmOperation(QType, K, Data, RangeStartM, RangeCountM, RangeStartN, RangeCountN);
+    });
+}
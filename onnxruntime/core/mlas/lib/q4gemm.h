@@ -0,0 +1,84 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    q4gemm.h
+
+Abstract:
+
+    This module defines the dispatch structure of the matrix multiply
+    operation with blockwise int4 quantized B (Q4GEMM).
+
+    Small M, typical for token generation, is computed by a hardware
+    dependent kernel that dequantizes B on the fly, so B is only read once
+    from memory in its compressed form. Larger M is computed by
+    dequantizing panels of B to fp32 and running SGEMM on them.
+
+--*/
+
+#pragma once
+
+#include "q4common.h"
+
+//
+// Maximum number of rows of A computed by the on-the-fly dequantization
+// kernel. Beyond this, the cost of dequantizing B once per row exceeds the
+// cost of dequantizing it once to a buffer.
+//
+
+#define MLAS_Q4GEMM_KERNEL_MAXM                     8
+
+//
+// Panel sizes of the dequantized B buffer. The K stride must be a multiple
+// of the block length of every quantization type.
+//
+
+#define MLAS_Q4GEMM_STRIDEN                         128
+#define MLAS_Q4GEMM_STRIDEK                         128
+
+//
+// Stride along M when splitting the operation over threads.
+//
+
+#define MLAS_Q4GEMM_STRIDEM                         128
+
+/**
+ * @brief Computes C = A * B + Bias for a few rows of A, dequantizing B on the fly.
+ *
+ * @param A       Address of matrix A
+ * @param PackedB Address of the first packed column of B
+ * @param C       Address of matrix C
+ * @param CountM  Number of rows to compute, at most MLAS_Q4GEMM_KERNEL_MAXM
+ * @param CountN  Number of columns to compute
+ * @param CountK  Number of columns of A and rows of B
+ * @param lda     Leading dimension of A
+ * @param ldb     Number of bytes of one packed column of B
+ * @param ldc     Leading dimension of C
+ * @param Bias    Address of the bias vector, optional
+ */
+typedef
+void
+(MLASCALL MLAS_Q4GEMM_KERNEL)(
+    const float* A,
+    const uint8_t* PackedB,
+    float* C,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    size_t lda,
+    size_t ldb,
+    size_t ldc,
+    const float* Bias
+    );
+
+/**
+ * @brief Hardware dependent dispatch for Q4GEMM, one kernel per
+ *        MLAS_BLK_QUANT_TYPE, indexed by the type value.
+ */
+struct MLAS_Q4GEMM_DISPATCH {
+    MLAS_Q4GEMM_KERNEL* Kernels[4];
+};
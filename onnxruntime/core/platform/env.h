@@ -91,6 +91,11 @@ struct ThreadOptions {
   void* custom_thread_creation_options = nullptr;
   OrtCustomJoinThreadFn custom_join_thread_fn = nullptr;
   int dynamic_block_base_ = 0;
+
+  // NUMA node of each thread, in the same order as the affinities, including the entry of the main thread.
+  // If the vector is not empty, parallel loops give the threads of each node the same part of the iteration space
+  // in every loop, so data placed by the first touch of a loop stays local to the node for the following loops.
+  std::vector<int> numa_nodes;
 };
 
 std::ostream& operator<<(std::ostream& os, const LogicalProcessors&);
@@ -141,6 +146,12 @@ class Env {
 
   virtual std::vector<LogicalProcessors> GetDefaultThreadAffinities() const = 0;
 
+  /// \brief Returns the logical processors of each NUMA node the process can run on.
+  /// Returns an empty vector if the process can only run on a single node or the topology is unknown.
+  virtual std::vector<LogicalProcessors> GetNumaNodeAffinities() const {
+    return {};
+  }
+
   /// \brief Returns the number of micro-seconds since the Unix epoch.
   virtual uint64_t NowMicros() const {
     return env_time_->NowMicros();
@@ -186,6 +197,22 @@ class Env {
   virtual common::Status MapFileIntoMemory(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
                                            MappedMemoryPtr& mapped_memory) const = 0;
 
+  /**
+   * Maps the content of the file into memory with read-only page protection.
+   * The mapped pages are never copied on write, so they stay backed by the OS page cache and are shared with
+   * any other process mapping the same file. Writing to the mapped memory is an access violation.
+   * The default implementation forwards to MapFileIntoMemory().
+   * @param file_path The path to the file.
+   * @param offset The file offset from which to start the mapping.
+   * @param length The length in bytes of the mapping.
+   * @param[out] mapped_memory A smart pointer to the mapped memory which
+   *             unmaps the memory (unless release()'d) when destroyed.
+   */
+  virtual common::Status MapFileIntoMemoryReadOnly(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset,
+                                                   size_t length, MappedMemoryPtr& mapped_memory) const {
+    return MapFileIntoMemory(file_path, offset, length, mapped_memory);
+  }
+
 #ifdef _WIN32
   /// \brief Returns true if the directory exists.
   virtual bool FolderExists(const std::wstring& path) const = 0;
@@ -203,6 +230,12 @@ class Env {
   // Recursively deletes the directory and its contents.
   // Note: This function is not thread safe!
   virtual common::Status DeleteFolder(const PathString& path) const = 0;
+  /// \brief Returns true if the path is a regular file.
+  virtual bool FileExists(const PathString& path) const = 0;
+  // Renames the file, atomically replacing new_path if it exists.
+  virtual common::Status RenameFile(const PathString& old_path, const PathString& new_path) const = 0;
+  // Deletes the file.
+  virtual common::Status RemoveFile(const PathString& path) const = 0;
   // Mainly for use with protobuf library
   virtual common::Status FileOpenRd(const std::string& path, /*out*/ int& fd) const = 0;
   // Mainly for use with protobuf library
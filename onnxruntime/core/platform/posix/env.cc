@@ -29,6 +29,7 @@ limitations under the License.
 #include <sys/syscall.h>
 #include <unistd.h>
 
+#include <fstream>
 #include <iostream>
 #include <optional>
 #include <thread>
@@ -90,6 +91,36 @@ static std::pair<int, std::string> GetSystemError() {
   return GetSystemError(e);
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+/**
+ * @brief Parse a list of ids in the format used by sysfs, e.g. "0-3,8,10-11"
+ *
+ * @return the ids, empty if the list is malformed
+ */
+static std::vector<int> ParseIdList(const std::string& id_list) {
+  std::vector<int> ids;
+  size_t pos = 0;
+  while (pos < id_list.size()) {
+    size_t end = id_list.find(',', pos);
+    if (end == std::string::npos) {
+      end = id_list.size();
+    }
+    const std::string range = id_list.substr(pos, end - pos);
+    pos = end + 1;
+    if (range.empty() || range.find_first_not_of("0123456789-") != std::string::npos) {
+      return {};
+    }
+    const size_t dash = range.find('-');
+    const int first = std::atoi(range.substr(0, dash).c_str());
+    const int last = dash == std::string::npos ? first : std::atoi(range.substr(dash + 1).c_str());
+    for (int id = first; id <= last; ++id) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+#endif
+
 static void UnmapFile(void* param) noexcept {
   std::unique_ptr<UnmapFileParam> p(reinterpret_cast<UnmapFileParam*>(param));
   int ret = munmap(p->addr, p->len);
@@ -324,6 +355,46 @@ class PosixEnv : public Env {
     return ret;
   }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+  std::vector<LogicalProcessors> GetNumaNodeAffinities() const override {
+    std::vector<LogicalProcessors> ret;
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    if (sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) != 0) {
+      return ret;
+    }
+
+    std::ifstream online_file("/sys/devices/system/node/online");
+    std::string online_nodes;
+    if (!online_file || !std::getline(online_file, online_nodes)) {
+      return ret;
+    }
+
+    for (int node : ParseIdList(online_nodes)) {
+      std::ifstream cpu_list_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::string cpu_list;
+      if (!cpu_list_file || !std::getline(cpu_list_file, cpu_list)) {
+        continue;
+      }
+      LogicalProcessors node_processors;
+      for (int cpu : ParseIdList(cpu_list)) {
+        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed_cpus)) {
+          node_processors.push_back(cpu);
+        }
+      }
+      // nodes without processors (e.g. memory only nodes) or outside of the cpuset of the process are skipped
+      if (!node_processors.empty()) {
+        ret.push_back(std::move(node_processors));
+      }
+    }
+
+    if (ret.size() < 2) {
+      ret.clear();
+    }
+    return ret;
+  }
+#endif
+
   void SleepForMicroseconds(int64_t micros) const override {
     while (micros > 0) {
       timespec sleep_time;
@@ -424,6 +495,16 @@ class PosixEnv : public Env {
 
   Status MapFileIntoMemory(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
                            MappedMemoryPtr& mapped_memory) const override {
+    return MapFileIntoMemoryWithProtection(file_path, offset, length, PROT_READ | PROT_WRITE, mapped_memory);
+  }
+
+  Status MapFileIntoMemoryReadOnly(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    return MapFileIntoMemoryWithProtection(file_path, offset, length, PROT_READ, mapped_memory);
+  }
+
+  static Status MapFileIntoMemoryWithProtection(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
+                                                int protection, MappedMemoryPtr& mapped_memory) {
     ORT_RETURN_IF_NOT(file_path, "file_path == nullptr");
     ORT_RETURN_IF_NOT(offset >= 0, "offset < 0");
 
@@ -442,7 +523,7 @@ class PosixEnv : public Env {
     const size_t mapped_length = length + offset_to_page;
     const FileOffsetType mapped_offset = offset - offset_to_page;
     void* const mapped_base =
-        mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor.Get(), mapped_offset);
+        mmap(nullptr, mapped_length, protection, MAP_PRIVATE, file_descriptor.Get(), mapped_offset);
 
     if (mapped_base == MAP_FAILED) {
       return ReportSystemError("mmap", file_path);
@@ -492,6 +573,28 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  bool FileExists(const PathString& path) const override {
+    struct stat sb;
+    if (stat(path.c_str(), &sb)) {
+      return false;
+    }
+    return S_ISREG(sb.st_mode);
+  }
+
+  common::Status RenameFile(const PathString& old_path, const PathString& new_path) const override {
+    if (rename(old_path.c_str(), new_path.c_str()) != 0) {
+      return ReportSystemError("rename", old_path);
+    }
+    return Status::OK();
+  }
+
+  common::Status RemoveFile(const PathString& path) const override {
+    if (unlink(path.c_str()) != 0) {
+      return ReportSystemError("unlink", path);
+    }
+    return Status::OK();
+  }
+
   common::Status FileOpenRd(const std::string& path, /*out*/ int& fd) const override {
     fd = open(path.c_str(), O_RDONLY);
     if (0 > fd) {
@@ -541,6 +541,31 @@ common::Status WindowsEnv::DeleteFolder(const PathString& path) const {
   return final_status;
 }
 
+bool WindowsEnv::FileExists(const PathString& path) const {
+  DWORD attributes = GetFileAttributesW(path.c_str());
+  return (attributes != INVALID_FILE_ATTRIBUTES) && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+common::Status WindowsEnv::RenameFile(const PathString& old_path, const PathString& new_path) const {
+  if (!MoveFileExW(old_path.c_str(), new_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    const auto error_code = GetLastError();
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
+                           "MoveFileEx() failed - path: ", ToUTF8String(Basename(old_path)),
+                           ", error code: ", error_code, " - ", std::system_category().message(error_code));
+  }
+  return Status::OK();
+}
+
+common::Status WindowsEnv::RemoveFile(const PathString& path) const {
+  if (!DeleteFileW(path.c_str())) {
+    const auto error_code = GetLastError();
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
+                           "DeleteFile() failed - path: ", ToUTF8String(Basename(path)),
+                           ", error code: ", error_code, " - ", std::system_category().message(error_code));
+  }
+  return Status::OK();
+}
+
 common::Status WindowsEnv::FileOpenRd(const std::wstring& path, /*out*/ int& fd) const {
   _wsopen_s(&fd, path.c_str(), _O_RDONLY | _O_SEQUENTIAL | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
   if (0 > fd) {
@@ -70,6 +70,9 @@ class WindowsEnv : public Env {
   common::Status CreateFolder(const std::wstring& path) const override;
   common::Status CreateFolder(const std::string& path) const override;
   common::Status DeleteFolder(const PathString& path) const override;
+  bool FileExists(const PathString& path) const override;
+  common::Status RenameFile(const PathString& old_path, const PathString& new_path) const override;
+  common::Status RemoveFile(const PathString& path) const override;
   common::Status FileOpenRd(const std::wstring& path, /*out*/ int& fd) const override;
   common::Status FileOpenWr(const std::wstring& path, /*out*/ int& fd) const override;
   common::Status FileOpenRd(const std::string& path, /*out*/ int& fd) const override;
@@ -2425,4 +2425,10 @@ std::unique_ptr<IDataTransfer> CPUExecutionProvider::GetDataTransfer() const {
   return std::make_unique<CPUDataTransfer>();
 }
 
+#if !defined(ORT_MINIMAL_BUILD)
+ITuningContext* CPUExecutionProvider::GetTuningContext() const {
+  return &tuning_context_;
+}
+#endif
+
 }  // namespace onnxruntime
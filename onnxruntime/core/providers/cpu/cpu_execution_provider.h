@@ -6,6 +6,9 @@
 #include "core/framework/allocatormgr.h"
 #include "core/framework/execution_provider.h"
 #include "core/graph/constants.h"
+#if !defined(ORT_MINIMAL_BUILD)
+#include "core/providers/cpu/tunable/cpu_tuning_context.h"
+#endif
 
 namespace onnxruntime {
 
@@ -34,9 +37,17 @@ class CPUExecutionProvider : public IExecutionProvider {
   std::shared_ptr<KernelRegistry> GetKernelRegistry() const override;
   std::unique_ptr<IDataTransfer> GetDataTransfer() const override;
 
+#if !defined(ORT_MINIMAL_BUILD)
+  ITuningContext* GetTuningContext() const override;
+#endif
+
  private:
   CPUExecutionProviderInfo info_;
   std::vector<FuseRuleFn> fuse_rules_;
+
+#if !defined(ORT_MINIMAL_BUILD)
+  mutable cpu::tunable::CpuTuningContext tuning_context_{this};
+#endif
 };
 
 // Registers all available CPU kernels
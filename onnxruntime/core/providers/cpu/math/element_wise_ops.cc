@@ -1932,45 +1932,68 @@ void UntypedBroadcastTwo(OpKernelContext& context, const ProcessBroadcastSpanFun
 
   Tensor& output_tensor = *context.Output(0, input_broadcaster.GetOutputShape());
 
-  size_t span_size = input_broadcaster.GetSpanSize();
-  size_t output_size = static_cast<ptrdiff_t>(output_tensor.Shape().Size());
+  ParallelBroadcastLooper(input_broadcaster, output_tensor, funcs, context.GetOperatorThreadPool(), unit_cost,
+                          user_data);
+}
+
+// Processes the output elements [first, last).
+// The span functor is still called once per span, so a broadcast with short spans costs the same per element on a
+// single thread as with BroadcastLooper. Only the partitioning between the threads differs.
+static void BroadcastRange(const InputBroadcaster& input_broadcaster, Tensor& output,
+                           const ProcessBroadcastSpanFuncs& funcs, void* user_data, size_t first, size_t last) {
+  const size_t span_size = input_broadcaster.GetSpanSize();
+  const size_t first_span = first / span_size;
+  const size_t end_span = (last + span_size - 1) / span_size;
+
+  // copy original input_broadcaster (which is at start of all input) and advance to the first span of the range
+  InputBroadcaster segment_input_broadcaster(input_broadcaster);
+  segment_input_broadcaster.AdvanceBy(first_span * span_size);
+  OutputBroadcaster segment_output_broadcaster(span_size, output, static_cast<ptrdiff_t>(first_span * span_size),
+                                               static_cast<ptrdiff_t>(end_span * span_size));
+  BroadcastHelper helper(segment_input_broadcaster, segment_output_broadcaster, user_data);
+
+  const ProcessSpanFunc process_span = helper.IsInput0Scalar()   ? funcs.input0scalar
+                                       : helper.IsInput1Scalar() ? funcs.input1scalar
+                                                                 : funcs.general;
+
+  // only the first and the last span of the range can be partial
+  size_t offset = first - first_span * span_size;
+  size_t remaining = last - first;
+  while (remaining > 0) {
+    const size_t count = std::min(span_size - offset, remaining);
+    if (count == span_size) {
+      process_span(helper);
+    } else {
+      BroadcastHelper span_helper(helper, offset, count);
+      process_span(span_helper);
+    }
+    helper.Next();
+    remaining -= count;
+    offset = 0;
+  }
+}
 
+void ParallelBroadcastLooper(const InputBroadcaster& input_broadcaster, Tensor& output,
+                             const ProcessBroadcastSpanFuncs& funcs, concurrency::ThreadPool* tp, double unit_cost,
+                             void* user_data) {
+  ORT_ENFORCE(input_broadcaster.HaveTwoTensors(), "ParallelBroadcastLooper requires two tensors as input.");
+
+  const size_t output_size = narrow<size_t>(output.Shape().Size());
   // one or more zero dimensions so nothing more to do
   if (output_size == 0) {
     return;
   }
 
-  concurrency::ThreadPool* tp = context.GetOperatorThreadPool();
-
-  if (span_size == output_size) {  // Input data will be processed in a single span, so parallelize within the span
-    OutputBroadcaster output_broadcaster(span_size, output_tensor);
-    BroadcastHelper broadcast_helper(input_broadcaster, output_broadcaster, user_data, tp, unit_cost);
-    BroadcastLooper(broadcast_helper, funcs);
-  } else {
-    // Input data will be processed in multiple spans, so parallelize across spans.
-
-    // enforce const on input broadcaster we copy from
-    const InputBroadcaster& const_input_broadcaster = input_broadcaster;
-
-    concurrency::ThreadPool::TryParallelFor(
-        tp, output_size / span_size,
-        TensorOpCost{static_cast<double>(input_broadcaster.Input0ElementSize()) * span_size,
-                     static_cast<double>(output_tensor.DataType()->Size()) * span_size,
-                     unit_cost * span_size},
-        [span_size, &const_input_broadcaster, &output_tensor, &funcs, user_data](std::ptrdiff_t first_span,
-                                                                                 std::ptrdiff_t last_span) {
-          // copy original input_broadcaster (which is at start of all input) and advance to this segment
-          InputBroadcaster segment_input_broadcaster(const_input_broadcaster);
-          segment_input_broadcaster.AdvanceBy(first_span * span_size);
-
-          // create broadcaster for this segment of output
-          OutputBroadcaster segment_output_broadcaster(span_size, output_tensor,
-                                                       first_span * span_size, last_span * span_size);
-
-          BroadcastHelper segment_helper(segment_input_broadcaster, segment_output_broadcaster, user_data);
-          BroadcastLooper(segment_helper, funcs);
-        });
-  }
+  const TensorOpCost cost{
+      static_cast<double>(std::max(input_broadcaster.Input0ElementSize(), input_broadcaster.Input1ElementSize())),
+      static_cast<double>(output.DataType()->Size()),
+      unit_cost};
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(output_size), cost,
+      [&input_broadcaster, &output, &funcs, user_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+        BroadcastRange(input_broadcaster, output, funcs, user_data, static_cast<size_t>(first),
+                       static_cast<size_t>(last));
+      });
 }
 
 // allocate_tensor should allocate a tensor of the output type with the given shape
@@ -2007,10 +2030,7 @@ static void UntypedBroadcastVariadic(int input_count, OpKernelContext& context,
       p_output = temp_output.get();
     }
 
-    OutputBroadcaster output_broadcaster(input_broadcaster.GetSpanSize(), *p_output);
-    BroadcastHelper broadcast_helper(input_broadcaster, output_broadcaster);
-
-    BroadcastLooper(broadcast_helper, funcs);
+    ParallelBroadcastLooper(input_broadcaster, *p_output, funcs, context.GetOperatorThreadPool(), 1.0);
 
     temp_input = std::move(temp_output);
   }
@@ -994,6 +994,17 @@ void UntypedBroadcastTwo(OpKernelContext& context, const ProcessBroadcastSpanFun
 void UntypedBroadcastTwo(OpKernelContext& context, const ProcessBroadcastSpanFuncs& funcs, double unit_cost,
                          void* user_data = nullptr);
 
+// Broadcast two inputs into output, in parallel if tp is not nullptr.
+//
+// The output is partitioned into contiguous ranges of elements, which may start and end within a span. This splits
+// the work evenly between the threads whatever the shape of the broadcast: a few long spans are split within the
+// spans, and many short spans, e.g. for [B, 1, S, 1] + [1, H, 1, D], are split across the outer dimensions with each
+// thread writing a contiguous block of the output. The spans of a range are passed to funcs as in BroadcastLooper.
+// unit_cost is the compute cost of an output element.
+void ParallelBroadcastLooper(const InputBroadcaster& input_broadcaster, Tensor& output,
+                             const ProcessBroadcastSpanFuncs& funcs, concurrency::ThreadPool* tp, double unit_cost,
+                             void* user_data = nullptr);
+
 // Helper to provide the looping logic with optimization for parallelizing within a single span if the
 // TBroadcastHelper instance was setup to enable that.
 template <typename TBroadcastHelper>
@@ -196,6 +196,33 @@ Status Gemm<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prep
   return Status::OK();
 }
 
+template <typename T>
+bool Gemm<T>::CanRestorePrePackedWeights(int /*input_idx*/) const {
+  return false;
+}
+
+template <>
+bool Gemm<float>::CanRestorePrePackedWeights(int input_idx) const {
+  return input_idx == 1;
+}
+
+template <typename T>
+Status Gemm<T>::RestorePrePackedWeights(const Tensor& /*tensor*/, int /*input_idx*/,
+                                        std::vector<BufferUniquePtr>& /*prepacked_buffers*/) {
+  ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
+}
+
+template <>
+Status Gemm<float>::RestorePrePackedWeights(const Tensor& tensor, int input_idx,
+                                            std::vector<BufferUniquePtr>& prepacked_buffers) {
+  ORT_RETURN_IF_NOT(input_idx == 1 && prepacked_buffers.size() == 1, "Unexpected pre-packed weights for input ",
+                    input_idx);
+
+  b_shape_ = tensor.Shape();
+  packed_b_ = std::move(prepacked_buffers[0]);
+  return Status::OK();
+}
+
 template <typename T>
 void Gemm<T>::ComputeActivation(T* y_data, size_t y_size, concurrency::ThreadPool* thread_pool) const {
   if (activation_) {
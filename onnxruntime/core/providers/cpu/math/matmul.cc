@@ -7,6 +7,9 @@
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/mlas/inc/mlas.h"
+#if !defined(ORT_MINIMAL_BUILD)
+#include "core/providers/cpu/tunable/cpu_tunable.h"
+#endif
 
 namespace onnxruntime {
 
@@ -126,6 +129,98 @@ Status MatMul<T>::Compute(OpKernelContext* ctx) const {
   return Status::OK();
 }
 
+#if !defined(ORT_MINIMAL_BUILD)
+namespace cpu {
+namespace tunable {
+
+struct MatMulParams : OpParams {
+  MatMulParams(ITuningContext* tuning_ctx, concurrency::ThreadPool* thread_pool) : OpParams(tuning_ctx, thread_pool) {}
+
+  std::string Signature() const override {
+    return MakeString(trans_a == CblasTrans ? "T" : "N", trans_b == CblasTrans ? "T" : "N", "_", M, "_", N, "_", K,
+                      "_", batch_size, b_is_packed ? "_packed" : "", "_",
+                      concurrency::ThreadPool::DegreeOfParallelism(stream));
+  }
+
+  CBLAS_TRANSPOSE trans_a;
+  CBLAS_TRANSPOSE trans_b;
+  size_t M;
+  size_t N;
+  size_t K;
+  const MLAS_SGEMM_DATA_PARAMS* data;
+  size_t batch_size;
+  bool b_is_packed;
+};
+
+static TensorOpCost GemmCost(const MatMulParams* params, size_t rows) {
+  return TensorOpCost{static_cast<double>((rows + params->N) * params->K * sizeof(float)),
+                      static_cast<double>(rows * params->N * sizeof(float)),
+                      2.0 * rows * params->N * params->K};
+}
+
+// MLAS partitions each GEMM of the batch over the thread pool.
+static Status MlasPartitionedGemm(const MatMulParams* params) {
+  MlasGemmBatch(params->trans_a, params->trans_b, params->M, params->N, params->K, params->data, params->batch_size,
+                params->stream);
+  return Status::OK();
+}
+
+// Each GEMM of the batch runs single threaded, the thread pool partitions the batch.
+static Status BatchPartitionedGemm(const MatMulParams* params) {
+  TUNABLE_OP_RETURN_UNSUPPORTED_ARGUMENT_IF(
+      params->batch_size < 2 || concurrency::ThreadPool::DegreeOfParallelism(params->stream) < 2,
+      "no batch to partition");
+  concurrency::ThreadPool::TryParallelFor(
+      params->stream, static_cast<std::ptrdiff_t>(params->batch_size), GemmCost(params, params->M),
+      [params](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        MlasGemmBatch(params->trans_a, params->trans_b, params->M, params->N, params->K, params->data + begin,
+                      static_cast<size_t>(end - begin), nullptr);
+      });
+  return Status::OK();
+}
+
+// The rows of every GEMM of the batch are split into blocks of RowsPerBlock rows, which the thread pool partitions.
+// Unlike MLAS, which splits the output in as many parts as there are threads, the blocks stay the same size
+// whatever the number of threads, so a thread computes a whole block against all of B.
+template <size_t RowsPerBlock>
+static Status RowBlockPartitionedGemm(const MatMulParams* params) {
+  TUNABLE_OP_RETURN_UNSUPPORTED_ARGUMENT_IF(
+      params->M <= RowsPerBlock || concurrency::ThreadPool::DegreeOfParallelism(params->stream) < 2,
+      "not enough rows to partition");
+  const size_t blocks_per_gemm = (params->M + RowsPerBlock - 1) / RowsPerBlock;
+  concurrency::ThreadPool::TryParallelFor(
+      params->stream, static_cast<std::ptrdiff_t>(params->batch_size * blocks_per_gemm),
+      GemmCost(params, RowsPerBlock),
+      [params, blocks_per_gemm](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (auto block = static_cast<size_t>(begin); block < static_cast<size_t>(end); block++) {
+          const auto& gemm = params->data[block / blocks_per_gemm];
+          const size_t row = (block % blocks_per_gemm) * RowsPerBlock;
+          MLAS_SGEMM_DATA_PARAMS block_gemm = gemm;
+          // a transposed A holds the rows of op(A) in its columns
+          block_gemm.A = gemm.A + (params->trans_a == CblasTrans ? row : row * gemm.lda);
+          block_gemm.C = gemm.C + row * gemm.ldc;
+          MlasGemmBatch(params->trans_a, params->trans_b, std::min(RowsPerBlock, params->M - row), params->N,
+                        params->K, &block_gemm, 1, nullptr);
+        }
+      });
+  return Status::OK();
+}
+
+class MatMulTunableOp : public TunableOp<MatMulParams> {
+ public:
+  MatMulTunableOp() {
+    RegisterOp(MlasPartitionedGemm);
+    RegisterOp(BatchPartitionedGemm);
+    RegisterOp(RowBlockPartitionedGemm<16>);
+    RegisterOp(RowBlockPartitionedGemm<64>);
+    SetDefaultId(0);
+  }
+};
+
+}  // namespace tunable
+}  // namespace cpu
+#endif  // !defined(ORT_MINIMAL_BUILD)
+
 Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ AllocatorPtr alloc,
                               /*out*/ bool& is_packed,
                               /*out*/ PrePackedWeights* prepacked_weights) {
@@ -157,6 +252,16 @@ Status MatMul<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& pr
   return Status::OK();
 }
 
+Status MatMul<float>::RestorePrePackedWeights(const Tensor& tensor, int input_idx,
+                                              std::vector<BufferUniquePtr>& prepacked_buffers) {
+  ORT_RETURN_IF_NOT(input_idx == 1 && prepacked_buffers.size() == 1, "Unexpected pre-packed weights for input ",
+                    input_idx);
+
+  b_shape_ = tensor.Shape();
+  packed_b_ = std::move(prepacked_buffers[0]);
+  return Status::OK();
+}
+
 Status MatMul<float>::Compute(OpKernelContext* ctx) const {
   concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
 
@@ -199,6 +304,24 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
     data[i].alpha = alpha_attr_;
     data[i].beta = 0.0f;
   }
+
+#if !defined(ORT_MINIMAL_BUILD)
+  ITuningContext* tuning_ctx = Info().GetExecutionProvider()->GetTuningContext();
+  if (tuning_ctx != nullptr && tuning_ctx->IsTunableOpEnabled()) {
+    static cpu::tunable::MatMulTunableOp tunable_op;
+    cpu::tunable::MatMulParams params(tuning_ctx, thread_pool);
+    params.trans_a = trans_a ? CblasTrans : CblasNoTrans;
+    params.trans_b = trans_b ? CblasTrans : CblasNoTrans;
+    params.M = M;
+    params.N = N;
+    params.K = K;
+    params.data = data.data();
+    params.batch_size = max_len;
+    params.b_is_packed = bool(packed_b_);
+    return tunable_op(&params);
+  }
+#endif
+
   MlasGemmBatch(trans_a ? CblasTrans : CblasNoTrans, trans_b ? CblasTrans : CblasNoTrans,
                 M, N, K, data.data(), max_len, thread_pool);
 
@@ -36,6 +36,11 @@ class MatMul<float> final : public OpKernel {
   Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers, int input_idx,
                                    /*out*/ bool& used_shared_buffers) override;
 
+  bool CanRestorePrePackedWeights(int input_idx) const override { return input_idx == 1; }
+
+  Status RestorePrePackedWeights(const Tensor& tensor, int input_idx,
+                                 std::vector<BufferUniquePtr>& prepacked_buffers) override;
+
   Status Compute(OpKernelContext* context) const override;
 
  private:
@@ -10,6 +10,7 @@
 #include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 #include "core/common/inlined_containers.h"
+#include "core/common/flat_hash_map.h"
 
 namespace onnxruntime {
 namespace ml {  // name space for onnx.ml operators
@@ -524,5 +525,26 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
     }
   }
 }
+
+// Maps every element of input to its value in map, or to default_value if the map doesn't contain it, as the
+// LabelEncoder and CategoryMapper kernels do. The strings of a string input are looked up as std::string_view, and the
+// elements are looked up in batches, in parallel over the intra-op thread pool for large inputs.
+template <typename TKey, typename TMapKey, typename TValue>
+void LookUpElements(const FlatHashMap<TMapKey, TValue>& map, gsl::span<const TKey> input, gsl::span<TValue> output,
+                    const TValue& default_value, concurrency::ThreadPool* thread_pool) {
+  // hashing a string costs more than its 32 bytes of std::string
+  const double compute_cycles = std::is_same<TKey, std::string>::value ? 64.0 : 16.0;
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(input.size()),
+      TensorOpCost{static_cast<double>(sizeof(TKey)), static_cast<double>(sizeof(TValue)), compute_cycles},
+      [&map, &input, &output, &default_value](std::ptrdiff_t first, std::ptrdiff_t last) {
+        const auto begin = static_cast<size_t>(first);
+        map.FindBatch(input.subspan(begin, static_cast<size_t>(last - first)),
+                      [&output, &default_value, begin](size_t i, const TValue* value) {
+                        output[begin + i] = value != nullptr ? *value : default_value;
+                      });
+      });
+}
+
 }  // namespace ml
 }  // namespace onnxruntime
@@ -48,6 +48,20 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
 
+  // Struct-of-arrays copy of the nodes used to evaluate a block of rows against one tree in lockstep
+  // when all the nodes share the same mode. Node i compares feature soa_feature_ids_[i] to soa_thresholds_[i]
+  // and moves to soa_children_[2 * i] if the condition holds, soa_children_[2 * i + 1] otherwise.
+  // Leaves point to themselves, so that every row takes tree_depths_[j] steps in tree j without
+  // checking whether it has reached a leaf.
+  bool use_soa_layout_ = false;
+  NODE_MODE soa_mode_ = NODE_MODE::LEAF;
+  std::vector<int32_t> soa_feature_ids_;
+  std::vector<ThresholdType> soa_thresholds_;
+  std::vector<uint32_t> soa_children_;
+  std::vector<uint8_t> soa_missing_tracks_true_;
+  std::vector<uint32_t> root_ids_;
+  std::vector<uint32_t> tree_depths_;
+
  public:
   TreeEnsembleCommon() {}
 
@@ -83,6 +97,16 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(TreeNodeElement<ThresholdType>* root,
                                                        const InputType* x_data) const;
 
+  // Evaluates tree j on rows [begin, end) and calls fct(i, leaf) for every row i.
+  template <typename FCT>
+  void ProcessTreeNodeLeaves(size_t j, const InputType* x_data, int64_t stride,
+                             int64_t begin, int64_t end, FCT&& fct) const;
+
+  template <NODE_MODE mode, bool has_missing_tracks>
+  void FindLeavesInBlock(size_t j, const InputType* x_data, int64_t stride, size_t n_rows, uint32_t* node_ids) const;
+
+  void InitSoALayout();
+
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 };
@@ -361,9 +385,78 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
       break;
     }
   }
+
+  InitSoALayout();
   return Status::OK();
 }
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::InitSoALayout() {
+  // Trees deeper than this are evaluated one row at a time, every row of a block taking as many
+  // steps as the deepest leaf of the tree.
+  constexpr uint32_t kMaxTreeDepthForSoALayout = 64;
+
+  use_soa_layout_ = false;
+  if (!same_mode_) {
+    return;
+  }
+
+  const size_t n_nodes = nodes_.size();
+  soa_feature_ids_.resize(n_nodes);
+  soa_thresholds_.resize(n_nodes);
+  soa_children_.resize(2 * n_nodes);
+  soa_missing_tracks_true_.resize(has_missing_tracks_ ? n_nodes : 0);
+  soa_mode_ = NODE_MODE::LEAF;
+  for (size_t i = 0; i < n_nodes; ++i) {
+    const auto& node = nodes_[i];
+    if (node.is_not_leaf()) {
+      soa_mode_ = node.mode();
+      soa_feature_ids_[i] = node.feature_id;
+      soa_thresholds_[i] = node.value_or_unique_weight;
+      soa_children_[2 * i] = static_cast<uint32_t>(i + node.truenode_inc_or_first_weight);
+      soa_children_[2 * i + 1] = static_cast<uint32_t>(i + node.falsenode_inc_or_n_weights);
+    } else {
+      soa_feature_ids_[i] = 0;
+      soa_thresholds_[i] = 0;
+      soa_children_[2 * i] = static_cast<uint32_t>(i);
+      soa_children_[2 * i + 1] = static_cast<uint32_t>(i);
+    }
+    if (has_missing_tracks_) {
+      soa_missing_tracks_true_[i] = node.is_missing_track_true() ? 1 : 0;
+    }
+  }
+
+  root_ids_.resize(roots_.size());
+  tree_depths_.resize(roots_.size());
+  InlinedVector<std::pair<uint32_t, uint32_t>> stack;
+  // Every node is visited once unless nodes are shared between branches, the layout is not used in that case.
+  size_t n_visited = 0;
+  for (size_t j = 0; j < roots_.size(); ++j) {
+    root_ids_[j] = static_cast<uint32_t>(roots_[j] - nodes_.data());
+    uint32_t depth = 0;
+    stack.clear();
+    stack.emplace_back(root_ids_[j], 0);
+    while (!stack.empty()) {
+      auto [id, node_depth] = stack.back();
+      stack.pop_back();
+      if (++n_visited > n_nodes) {
+        return;
+      }
+      if (!nodes_[id].is_not_leaf()) {
+        depth = std::max(depth, node_depth);
+      } else if (node_depth >= kMaxTreeDepthForSoALayout) {
+        return;
+      } else {
+        stack.emplace_back(soa_children_[2 * id], node_depth + 1);
+        stack.emplace_back(soa_children_[2 * id + 1], node_depth + 1);
+      }
+    }
+    tree_depths_[j] = depth;
+  }
+
+  use_soa_layout_ = true;
+}
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::compute(OpKernelContext* ctx,
                                                                          const Tensor* X,
@@ -466,9 +559,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           scores[SafeInt<ptrdiff_t>(i - batch)] = {0, 0};
         }
         for (j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-          }
+          ProcessTreeNodeLeaves(j, x_data, stride, batch, batch_end,
+                                [&agg, &scores, batch](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                  agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(i - batch)], leaf);
+                                });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores1(z_data + i, scores[SafeInt<ptrdiff_t>(i - batch)],
@@ -490,10 +584,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i] = {0, 0};
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                 *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-                }
+                ProcessTreeNodeLeaves(j, x_data, stride, begin_n, end_n,
+                                      [&agg, &scores, batch_num, N](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                        agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i], leaf);
+                                      });
               }
             });
         begin_n = end_n;
@@ -566,9 +660,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           std::fill(scores[SafeInt<ptrdiff_t>(i - batch)].begin(), scores[SafeInt<ptrdiff_t>(i - batch)].end(), ScoreValue<ThresholdType>({0, 0}));
         }
         for (j = 0, limit = roots_.size(); j < limit; ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-          }
+          ProcessTreeNodeLeaves(j, x_data, stride, batch, batch_end,
+                                [this, &agg, &scores, batch](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                  agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(i - batch)], leaf, weights_);
+                                });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores(scores[SafeInt<ptrdiff_t>(i - batch)], z_data + i * n_targets_or_classes_, -1,
@@ -591,10 +686,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-                }
+                ProcessTreeNodeLeaves(j, x_data, stride, begin_n, end_n,
+                                      [this, &agg, &scores, batch_num, N](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                        agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i], leaf, weights_);
+                                      });
               }
             });
         begin_n = end_n;
@@ -745,6 +840,102 @@ TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeave(
   return root;
 }
 
+template <NODE_MODE mode, typename InputType, typename ThresholdType>
+inline bool CompareToThreshold(InputType val, ThresholdType threshold) {
+  switch (mode) {
+    case NODE_MODE::BRANCH_LEQ:
+      return val <= threshold;
+    case NODE_MODE::BRANCH_LT:
+      return val < threshold;
+    case NODE_MODE::BRANCH_GTE:
+      return val >= threshold;
+    case NODE_MODE::BRANCH_GT:
+      return val > threshold;
+    case NODE_MODE::BRANCH_EQ:
+      return val == threshold;
+    case NODE_MODE::BRANCH_NEQ:
+      return val != threshold;
+    default:
+      return false;
+  }
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <NODE_MODE mode, bool has_missing_tracks>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::FindLeavesInBlock(
+    size_t j, const InputType* x_data, int64_t stride, size_t n_rows, uint32_t* node_ids) const {
+  const int32_t* feature_ids = soa_feature_ids_.data();
+  const ThresholdType* thresholds = soa_thresholds_.data();
+  const uint32_t* children = soa_children_.data();
+  const uint8_t* missing_tracks_true = soa_missing_tracks_true_.data();
+
+  for (size_t r = 0; r < n_rows; ++r) {
+    node_ids[r] = root_ids_[j];
+  }
+  // Every step moves all the rows of the block one level down, the rows are independent from each other
+  // so the loads and comparisons of different rows overlap instead of waiting on each other.
+  for (uint32_t depth = 0; depth < tree_depths_[j]; ++depth) {
+    for (size_t r = 0; r < n_rows; ++r) {
+      const uint32_t id = node_ids[r];
+      const InputType val = x_data[static_cast<int64_t>(r) * stride + feature_ids[id]];
+      bool cond = CompareToThreshold<mode>(val, thresholds[id]);
+      if (has_missing_tracks) {
+        cond = cond || (missing_tracks_true[id] && _isnan_(val));
+      }
+      node_ids[r] = children[2 * id + (cond ? 0 : 1)];
+    }
+  }
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename FCT>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeaves(
+    size_t j, const InputType* x_data, int64_t stride, int64_t begin, int64_t end, FCT&& fct) const {
+  if (!use_soa_layout_ || stride <= 0) {
+    for (int64_t i = begin; i < end; ++i) {
+      fct(i, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+    }
+    return;
+  }
+
+  constexpr int64_t kRowBlockSize = 16;
+  uint32_t node_ids[kRowBlockSize];
+  for (int64_t block = begin; block < end; block += kRowBlockSize) {
+    const size_t n_rows = static_cast<size_t>(std::min(kRowBlockSize, end - block));
+    const InputType* x_block = x_data + block * stride;
+
+#define TREE_FIND_LEAVES_IN_BLOCK(MODE)                                                \
+  case NODE_MODE::MODE:                                                                \
+    if (has_missing_tracks_) {                                                         \
+      FindLeavesInBlock<NODE_MODE::MODE, true>(j, x_block, stride, n_rows, node_ids);  \
+    } else {                                                                           \
+      FindLeavesInBlock<NODE_MODE::MODE, false>(j, x_block, stride, n_rows, node_ids); \
+    }                                                                                  \
+    break;
+
+    switch (soa_mode_) {
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_LEQ)
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_LT)
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_GTE)
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_GT)
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_EQ)
+      TREE_FIND_LEAVES_IN_BLOCK(BRANCH_NEQ)
+      default:
+        // Every tree is a single leaf.
+        for (size_t r = 0; r < n_rows; ++r) {
+          node_ids[r] = root_ids_[j];
+        }
+        break;
+    }
+
+#undef TREE_FIND_LEAVES_IN_BLOCK
+
+    for (size_t r = 0; r < n_rows; ++r) {
+      fct(block + static_cast<int64_t>(r), nodes_[node_ids[r]]);
+    }
+  }
+}
+
 // TI: input type
 // TH: threshold type, double if T==double, float otherwise
 // TO: output type
@@ -3,11 +3,15 @@
 
 #include "tfidfvectorizer.h"
 #include "core/common/common.h"
+#include "core/common/flat_hash_map.h"
 #include "core/framework/tensor.h"
 #include "core/platform/threadpool.h"
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
+#include <limits>
+#include <map>
+#include <string_view>
 #include <core/common/safeint.h>
 
 namespace onnxruntime {
@@ -24,61 +28,138 @@ ONNX_CPU_OPERATOR_KERNEL(
 
 namespace ngram_details {
 
-// NgrampPart implements a Trie like structure
-// for a unigram (1) it would insert into a root map with a valid id.
-// for (1,2,3) node 2 would be a child of 1 but have id == 0
-// because (1,2) does not exists. Node 3 would have a valid id.
-template <class T>
-struct NgramPart;
+// The pool as a trie of token ids, where the tokens are numbered from 1 in the order they first appear in the pool.
+// A unigram (1) is a child of the root with a valid id.
+// For (1,2,3) node 2 is a child of 1 but has id == 0
+// because (1,2) does not exists. Node 3 has a valid id.
+struct TrieBuilder {
+  struct Node {
+    std::map<uint32_t, size_t> children;
+    size_t ngram_id = 0;  // 0 - means no entry, search for a bigger N
+  };
 
-template <>
-struct NgramPart<int64_t>;
+  std::vector<Node> nodes{1};
 
-template <>
-struct NgramPart<std::string>;
+  size_t AddChild(size_t node, uint32_t token) {
+    const auto p = nodes[node].children.emplace(token, nodes.size());
+    const size_t child = p.first->second;
+    if (p.second) {
+      nodes.emplace_back();
+    }
+    return child;
+  }
+};
 
-using NgramPartInt = NgramPart<int64_t>;
-using NgramPartString = NgramPart<std::string>;
+// The trie of a TrieBuilder packed into a double-array trie: the child of node s for token t is the node
+// base_[s] + t if check_[base_[s] + t] == s. The root is node 0. Following an n-gram indexes three flat arrays
+// rather than looking up a hash map per token.
+class NgramTrie {
+ public:
+  static constexpr int32_t kNoNode = -1;
 
-// Avoid recursive class definitions using unique_ptr + forward declaration
-using IntMap = std::unordered_map<int64_t, std::unique_ptr<NgramPartInt>>;
+  NgramTrie() = default;
+  NgramTrie(const TrieBuilder& builder, gsl::span<const int64_t> ngram_indexes);
 
-using StrMap = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                  std::hash<std::string>, std::equal_to<std::string>>;
+  bool Empty() const { return empty_; }
 
-template <>
-struct NgramPart<int64_t> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  IntMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+  // kNoNode if the node has no child for the token. Token 0 is never in the trie.
+  int32_t Child(int32_t node, uint32_t token) const {
+    const size_t index = static_cast<size_t>(base_[node]) + token;
+    return index < check_.size() && check_[index] == node ? static_cast<int32_t>(index) : kNoNode;
+  }
+
+  // The index in the output of the n-gram which ends at the node, or -1 if there is none.
+  int64_t OutputIndex(int32_t node) const { return output_indexes_[node]; }
+
+ private:
+  void Resize(size_t size) {
+    base_.resize(size, 0);
+    check_.resize(size, kNoNode);
+    output_indexes_.resize(size, -1);
+  }
 
-template <>
-struct NgramPart<std::string> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  StrMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
+  std::vector<int32_t> base_;
+  std::vector<int32_t> check_;
+  std::vector<int64_t> output_indexes_;
+  bool empty_ = true;
 };
 
+NgramTrie::NgramTrie(const TrieBuilder& builder, gsl::span<const int64_t> ngram_indexes) {
+  const auto& nodes = builder.nodes;
+  empty_ = nodes[0].children.empty();
+  Resize(1);
+
+  // The nodes are placed breadth first. The slot of a node is used once its check is set, the root's slot 0 is never
+  // a child slot as the tokens start at 1.
+  std::vector<std::pair<size_t, int32_t>> queue{{0, 0}};
+  size_t first_free = 1;
+  size_t num_slots = 1;
+  for (size_t q = 0; q < queue.size(); ++q) {
+    const size_t builder_node = queue[q].first;
+    const int32_t node = queue[q].second;
+    const size_t ngram_id = nodes[builder_node].ngram_id;
+    // an n-gram without an output index is not counted
+    if (ngram_id != 0 && ngram_id <= ngram_indexes.size()) {
+      output_indexes_[node] = ngram_indexes[ngram_id - 1];
+    }
+
+    const auto& children = nodes[builder_node].children;
+    if (children.empty()) {
+      continue;
+    }
+
+    // the lowest base for which the slots of all the children are free
+    const uint32_t first_token = children.begin()->first;
+    size_t base = first_free > first_token ? first_free - first_token : 0;
+    const auto is_free = [this, &base](const std::pair<const uint32_t, size_t>& child) {
+      const size_t slot = base + child.first;
+      return slot >= check_.size() || check_[slot] == kNoNode;
+    };
+    while (!std::all_of(children.begin(), children.end(), is_free)) {
+      ++base;
+    }
+
+    const size_t last_slot = base + children.rbegin()->first;
+    ORT_ENFORCE(last_slot < static_cast<size_t>(std::numeric_limits<int32_t>::max()), "Too many n-grams in the pool");
+    if (last_slot >= check_.size()) {
+      Resize(std::max(last_slot + 1, check_.size() * 2));
+    }
+    num_slots = std::max(num_slots, last_slot + 1);
+    base_[node] = static_cast<int32_t>(base);
+    for (const auto& child : children) {
+      const size_t slot = base + child.first;
+      check_[slot] = node;
+      queue.emplace_back(child.second, static_cast<int32_t>(slot));
+    }
+    while (first_free < check_.size() && check_[first_free] != kNoNode) {
+      ++first_free;
+    }
+  }
+  // drop the free slots at the end
+  Resize(num_slots);
+  base_.shrink_to_fit();
+  check_.shrink_to_fit();
+  output_indexes_.shrink_to_fit();
+}
+
+inline int64_t NgramKey(int64_t item) { return item; }
+inline std::string_view NgramKey(const std::string& item) { return item; }
+
+// Adds the n-grams to the trie and their tokens to the vocabulary.
 // Returns next ngram_id
-template <class K, class ForwardIter, class Map>
+template <class ForwardIter, class Vocabulary>
 inline size_t PopulateGrams(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id,
-                            Map& c) {
+                            Vocabulary& vocabulary, TrieBuilder& trie) {
   for (; ngrams > 0; --ngrams) {
-    size_t n = 1;
-    Map* m = &c;
-    while (true) {
-      auto p = m->emplace(*first, std::make_unique<NgramPart<K>>(0));
-      ++first;
-      if (n == ngram_size) {
-        ORT_ENFORCE(p.first->second->id_ == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
-        p.first->second->id_ = ngram_id;
-        ++ngram_id;
-        break;
-      }
-      ++n;
-      m = &p.first->second->leafs_;
+    size_t node = 0;
+    for (size_t n = 0; n < ngram_size; ++n, ++first) {
+      const auto next_token = static_cast<uint32_t>(vocabulary.Size() + 1);
+      const uint32_t token = *vocabulary.Insert(NgramKey(*first), next_token).first;
+      node = trie.AddChild(node, token);
     }
+    ORT_ENFORCE(trie.nodes[node].ngram_id == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
+    trie.nodes[node].ngram_id = ngram_id;
+    ++ngram_id;
   }
   return ngram_id;
 }
@@ -90,10 +171,6 @@ using namespace onnxruntime::ngram_details;
 
 namespace onnxruntime {
 
-inline const void* AdvanceElementPtr(const void* p, size_t elements, size_t element_size) {
-  return reinterpret_cast<const uint8_t*>(p) + elements * element_size;
-}
-
 // The weighting criteria.
 // "TF"(term frequency),
 //    the counts are propagated to output
@@ -128,11 +205,12 @@ struct TfIdfVectorizer::Impl {
   gsl::span<const int64_t> ngram_indexes_;
   gsl::span<const float> weights_;
 
-  // This map contains references to pool_string_ entries
-  // of pool_strings attribute
-  StrMap str_map_;
-  // This map contains pool_int64s entries
-  IntMap int64_map_;
+  // The token ids of the pool_strings entries, the keys are views of the attribute strings
+  FlatHashMap<std::string_view, uint32_t> str_tokens_;
+  // The token ids of the pool_int64s entries
+  FlatHashMap<int64_t, uint32_t> int64_tokens_;
+  bool pool_strings_ = false;
+  NgramTrie trie_;
 
   size_t output_size_ = 0;
 
@@ -141,14 +219,54 @@ struct TfIdfVectorizer::Impl {
   Impl(const Impl&) = delete;
   Impl& operator=(const Impl&) = delete;
 
-  void IncrementCount(size_t ngram_id, size_t row_num,
-                      std::vector<uint32_t>& frequencies) const {
-    assert(ngram_id != 0);
-    --ngram_id;
-    assert(ngram_id < ngram_indexes_.size());
-    size_t output_idx = row_num * output_size_ + SafeInt<size_t>(ngram_indexes_[ngram_id]);
-    assert(output_idx < frequencies.size());
-    ++frequencies[output_idx];
+  // Maps the input elements [first, last) to their token ids, 0 for the elements which are not in the pool
+  void GetTokenIds(const Tensor& X, size_t first, size_t last, uint32_t* token_ids) const {
+    const auto write = [token_ids](size_t i, const uint32_t* token) { token_ids[i] = token != nullptr ? *token : 0; };
+    if (X.IsDataTypeString()) {
+      str_tokens_.FindBatch(X.DataAsSpan<std::string>().subspan(first, last - first), write);
+    } else if (X.IsDataType<int32_t>()) {
+      int64_tokens_.FindBatch(X.DataAsSpan<int32_t>().subspan(first, last - first), write);
+    } else {
+      int64_tokens_.FindBatch(X.DataAsSpan<int64_t>().subspan(first, last - first), write);
+    }
+  }
+
+  // Counts the n-grams which start at the positions [begin, end) of a row of token ids into the row's frequencies
+  void CountNgrams(const uint32_t* row, size_t row_size, size_t begin, size_t end, uint32_t* frequencies) const {
+    const auto max_gram_length = onnxruntime::narrow<size_t>(max_gram_length_);
+    const auto max_skip_distance = onnxruntime::narrow<size_t>(max_skip_count_) + 1;  // Convert to distance
+    auto start_ngram_size = onnxruntime::narrow<size_t>(min_gram_length_);
+
+    for (size_t skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
+      for (size_t ngram_start = begin; ngram_start < end; ++ngram_start) {
+        // We went far enough so no n-grams of any size can be gathered
+        if (ngram_start + skip_distance * (start_ngram_size - 1) >= row_size) {
+          break;
+        }
+
+        // One walk down the trie matches the n-grams of all the sizes which start here
+        int32_t node = 0;
+        for (size_t ngram_size = 1, item = ngram_start;
+             ngram_size <= max_gram_length && item < row_size;
+             ++ngram_size, item += skip_distance) {
+          node = trie_.Child(node, row[item]);
+          if (node == NgramTrie::kNoNode) {
+            break;
+          }
+          if (ngram_size >= start_ngram_size) {
+            const int64_t output_index = trie_.OutputIndex(node);
+            if (output_index >= 0) {
+              ++frequencies[output_index];
+            }
+          }
+        }
+      }
+      // We count UniGrams only once since they are not affected
+      // by skip distance
+      if (start_ngram_size == 1 && ++start_ngram_size > max_gram_length) {
+        break;
+      }
+    }
   }
 };
 
@@ -225,6 +343,7 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
   const size_t min_gram_length = onnxruntime::narrow<size_t>(impl_->min_gram_length_);
   const size_t max_gram_length = onnxruntime::narrow<size_t>(impl_->max_gram_length_);
   size_t ngram_size = 1;
+  TrieBuilder trie_builder;
   for (size_t i = 0; i < impl_->ngram_counts_.size(); ++i) {
     size_t start_idx = onnxruntime::narrow<size_t>(impl_->ngram_counts_[i]);
     size_t end_idx = onnxruntime::narrow<size_t>((i + 1) < impl_->ngram_counts_.size() ? impl_->ngram_counts_[i + 1] : total_items);
@@ -238,9 +357,11 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
         if (pool_strings.empty()) {
-          ngram_id = PopulateGrams<int64_t>(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_map_);
+          ngram_id = PopulateGrams(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id,
+                                   impl_->int64_tokens_, trie_builder);
         } else {
-          ngram_id = PopulateGrams<std::string>(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_map_);
+          ngram_id = PopulateGrams(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id,
+                                   impl_->str_tokens_, trie_builder);
         }
       } else {
         ngram_id += ngrams;
@@ -248,6 +369,8 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
     }
     ++ngram_size;
   }
+  impl_->pool_strings_ = !pool_strings.empty();
+  impl_->trie_ = NgramTrie(trie_builder, impl_->ngram_indexes_);
 }
 
 TfIdfVectorizer::~TfIdfVectorizer() = default;
@@ -311,77 +434,6 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
   }
 }
 
-void TfIdfVectorizer::ComputeImpl(OpKernelContext* ctx, ptrdiff_t row_num, size_t row_size,
-                                  std::vector<uint32_t>& frequencies) const {
-  auto X = ctx->Input<Tensor>(0);
-  const auto elem_size = X->DataType()->Size();
-
-  const void* const row_begin = AdvanceElementPtr(X->DataRaw(), row_num * row_size, elem_size);
-  const void* const row_end = AdvanceElementPtr(row_begin, row_size, elem_size);
-
-  const auto& impl = *impl_;
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
-
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = row_begin;
-    auto const ngram_row_end = row_end;
-
-    while (ngram_start < ngram_row_end) {
-      // We went far enough so no n-grams of any size can be gathered
-      auto at_least_this = AdvanceElementPtr(ngram_start, SafeInt<size_t>(skip_distance) * (start_ngram_size - 1), elem_size);
-      if (at_least_this >= ngram_row_end) {
-        break;
-      }
-
-      auto ngram_item = ngram_start;
-      if (X->IsDataTypeString()) {
-        const std::string* str_item = reinterpret_cast<const std::string*>(ngram_item);
-        const StrMap* str_map = &impl.str_map_;
-        for (auto ngram_size = 1;
-             !str_map->empty() &&
-             ngram_size <= max_gram_length &&
-             str_item < ngram_row_end;
-             ++ngram_size, str_item += skip_distance) {
-          auto hit = str_map->find(*str_item);
-          if (hit == str_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
-          }
-          str_map = &hit->second->leafs_;
-        }
-      } else {
-        const IntMap* int_map = &impl.int64_map_;
-        for (auto ngram_size = 1;
-             !int_map->empty() &&
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
-             ++ngram_size, ngram_item = AdvanceElementPtr(ngram_item, skip_distance, elem_size)) {
-          int64_t val = (X->IsDataType<int32_t>()) ? int64_t{*reinterpret_cast<const int32_t*>(ngram_item)} : *reinterpret_cast<const int64_t*>(ngram_item);
-          auto hit = int_map->find(val);
-          if (hit == int_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
-          }
-          int_map = &hit->second->leafs_;
-        }
-      }
-      // Sliding window shift
-      ngram_start = AdvanceElementPtr(ngram_start, 1, elem_size);
-    }
-    // We count UniGrams only once since they are not affected
-    // by skip distance
-    if (start_ngram_size == 1 && ++start_ngram_size > max_gram_length) {
-      break;
-    }
-  }
-}
-
 Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   auto X = ctx->Input<Tensor>(0);
   auto& input_shape = X->Shape();
@@ -417,9 +469,7 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   std::vector<uint32_t> frequencies;
   frequencies.resize(num_rows * impl_->output_size_, 0);
 
-  if (total_items == 0 ||
-      (X->IsDataTypeString() && impl_->str_map_.empty()) ||
-      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_map_.empty())) {
+  if (total_items == 0 || impl_->trie_.Empty() || X->IsDataTypeString() != impl_->pool_strings_) {
     // TfidfVectorizer may receive an empty input when it follows a Tokenizer
     // (for example for a string containing only stopwords).
     // TfidfVectorizer returns a zero tensor of shape
@@ -429,11 +479,61 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
     return Status::OK();
   }
 
-  std::function<void(ptrdiff_t)> fn = [this, ctx, C, &frequencies](ptrdiff_t row_num) {
-    ComputeImpl(ctx, row_num, C, frequencies);
-  };
+  const Impl& impl = *impl_;
+  auto* const thread_pool = ctx->GetOperatorThreadPool();
+
+  // The input as token ids, which index the trie
+  std::vector<uint32_t> token_ids(total_items);
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(total_items),
+      TensorOpCost{static_cast<double>(X->DataType()->Size()), static_cast<double>(sizeof(uint32_t)), 32.0},
+      [&impl, X, &token_ids](std::ptrdiff_t first, std::ptrdiff_t last) {
+        impl.GetTokenIds(*X, static_cast<size_t>(first), static_cast<size_t>(last), token_ids.data() + first);
+      });
+
+  // Every row counts its n-grams into its own row of frequencies. With fewer rows than threads the start positions
+  // of long rows are split into blocks as well, which count into frequencies of their own that are summed afterwards.
+  const size_t output_size = impl.output_size_;
+  const auto rows = static_cast<size_t>(num_rows);
+  const auto degree_of_parallelism = static_cast<size_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool));
+  constexpr size_t kMinBlockSize = 1024;
+  size_t blocks_per_row = std::min((degree_of_parallelism + rows - 1) / rows, C / kMinBlockSize);
+  // summing the frequencies of the blocks mustn't cost more than counting
+  while (blocks_per_row > 1 && blocks_per_row * output_size > C) {
+    --blocks_per_row;
+  }
 
-  concurrency::ThreadPool::TryBatchParallelFor(ctx->GetOperatorThreadPool(), num_rows, std::move(fn), 0);
+  if (blocks_per_row <= 1) {
+    concurrency::ThreadPool::TryBatchParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(rows),
+        [&impl, &token_ids, &frequencies, C, output_size](std::ptrdiff_t row_num) {
+          const auto row = static_cast<size_t>(row_num);
+          impl.CountNgrams(token_ids.data() + row * C, C, 0, C, frequencies.data() + row * output_size);
+        },
+        0);
+  } else {
+    std::vector<uint32_t> block_frequencies(rows * blocks_per_row * output_size, 0);
+    concurrency::ThreadPool::TryBatchParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(rows * blocks_per_row),
+        [&impl, &token_ids, &block_frequencies, C, output_size, blocks_per_row](std::ptrdiff_t block_num) {
+          const auto block = static_cast<size_t>(block_num);
+          const size_t row = block / blocks_per_row;
+          const size_t block_in_row = block % blocks_per_row;
+          impl.CountNgrams(token_ids.data() + row * C, C, C * block_in_row / blocks_per_row,
+                           C * (block_in_row + 1) / blocks_per_row, block_frequencies.data() + block * output_size);
+        },
+        0);
+
+    for (size_t row = 0; row < rows; ++row) {
+      uint32_t* row_frequencies = frequencies.data() + row * output_size;
+      for (size_t block_in_row = 0; block_in_row < blocks_per_row; ++block_in_row) {
+        const uint32_t* counts = block_frequencies.data() + (row * blocks_per_row + block_in_row) * output_size;
+        for (size_t i = 0; i < output_size; ++i) {
+          row_frequencies[i] += counts[i];
+        }
+      }
+    }
+  }
 
   OutputResult(ctx, B, frequencies);
 
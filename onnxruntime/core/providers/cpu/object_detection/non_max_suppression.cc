@@ -13,8 +13,11 @@ limitations under the License.
 
 #include "non_max_suppression.h"
 #include "non_max_suppression_helper.h"
-#include <queue>
+#include "core/common/narrow.h"
+#include "core/platform/threadpool.h"
+#include <algorithm>
 #include <utility>
+#include <vector>
 //TODO:fix the warnings
 #ifdef _MSC_VER
 #pragma warning(disable : 4244)
@@ -114,6 +117,160 @@ Status NonMaxSuppressionBase::GetThresholdsFromInputs(const PrepareContext& pc,
   return Status::OK();
 }
 
+namespace {
+
+struct BoxInfoPtr {
+  float score_{};
+  int64_t index_{};
+
+  BoxInfoPtr() = default;
+  explicit BoxInfoPtr(float score, int64_t idx) : score_(score), index_(idx) {}
+  inline bool operator<(const BoxInfoPtr& rhs) const {
+    return score_ < rhs.score_ || (score_ == rhs.score_ && index_ > rhs.index_);
+  }
+};
+
+// The corners and the area of a box, computed as SuppressByIOU() computes them.
+struct BoxCorners {
+  float x_min{};
+  float y_min{};
+  float x_max{};
+  float y_max{};
+  float area{};
+};
+
+BoxCorners GetBoxCorners(const float* box, int64_t center_point_box) {
+  BoxCorners corners;
+  if (0 == center_point_box) {
+    // boxes data format [y1, x1, y2, x2]
+    MaxMin(box[1], box[3], corners.x_min, corners.x_max);
+    MaxMin(box[0], box[2], corners.y_min, corners.y_max);
+  } else {
+    // boxes data format [x_center, y_center, width, height]
+    const float width_half = box[2] / 2;
+    const float height_half = box[3] / 2;
+    corners.x_min = box[0] - width_half;
+    corners.x_max = box[0] + width_half;
+    corners.y_min = box[1] - height_half;
+    corners.y_max = box[1] + height_half;
+  }
+  corners.area = (corners.x_max - corners.x_min) * (corners.y_max - corners.y_min);
+  return corners;
+}
+
+// The boxes selected for a class, stored as a structure of arrays so that the IOU of a candidate with a block of them
+// is computed with SIMD instructions.
+class SelectedBoxes {
+ public:
+  void Clear() {
+    x_min_.clear();
+    y_min_.clear();
+    x_max_.clear();
+    y_max_.clear();
+    area_.clear();
+  }
+
+  void Add(const BoxCorners& box) {
+    x_min_.push_back(box.x_min);
+    y_min_.push_back(box.y_min);
+    x_max_.push_back(box.x_max);
+    y_max_.push_back(box.y_max);
+    area_.push_back(box.area);
+  }
+
+  // Whether the IOU of the box with any selected box exceeds the threshold, with the same result as SuppressByIOU().
+  bool Suppress(const BoxCorners& box, float iou_threshold) const {
+    constexpr size_t kBlockSize = 16;
+    const size_t num_boxes = area_.size();
+    for (size_t begin = 0; begin < num_boxes; begin += kBlockSize) {
+      const size_t end = std::min(num_boxes, begin + kBlockSize);
+      // no branches inside a block, so that the compiler vectorizes it
+      bool suppressed = false;
+      for (size_t i = begin; i < end; ++i) {
+        const float intersection_x_min = std::max(box.x_min, x_min_[i]);
+        const float intersection_x_max = std::min(box.x_max, x_max_[i]);
+        const float intersection_y_min = std::max(box.y_min, y_min_[i]);
+        const float intersection_y_max = std::min(box.y_max, y_max_[i]);
+        const float intersection_area = (intersection_x_max - intersection_x_min) *
+                                        (intersection_y_max - intersection_y_min);
+        const float union_area = box.area + area_[i] - intersection_area;
+        suppressed = suppressed |
+                     (!(intersection_x_max <= intersection_x_min) & !(intersection_y_max <= intersection_y_min) &
+                      !(intersection_area <= .0f) & !(box.area <= .0f) & !(area_[i] <= .0f) &
+                      !(union_area <= .0f) & (intersection_area / union_area > iou_threshold));
+      }
+      if (suppressed) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<float> x_min_;
+  std::vector<float> y_min_;
+  std::vector<float> x_max_;
+  std::vector<float> y_max_;
+  std::vector<float> area_;
+};
+
+// The buffers of the selection of the boxes of a class, reused by the classes a thread processes.
+struct ClassSelectionScratch {
+  std::vector<BoxInfoPtr> candidate_boxes;
+  SelectedBoxes selected_boxes;
+};
+
+// Selects the boxes of a class, in the order of their selection.
+void SelectBoxesOfClass(const float* batch_boxes, const float* class_scores, int64_t num_boxes,
+                        bool has_score_threshold, float score_threshold, int64_t max_output_boxes_per_class,
+                        float iou_threshold, int64_t center_point_box, ClassSelectionScratch& scratch,
+                        std::vector<int64_t>& selected_box_indices) {
+  auto& candidate_boxes = scratch.candidate_boxes;
+  candidate_boxes.clear();
+
+  // Filter by score_threshold_
+  if (has_score_threshold) {
+    for (int64_t box_index = 0; box_index < num_boxes; ++box_index) {
+      if (class_scores[box_index] > score_threshold) {
+        candidate_boxes.emplace_back(class_scores[box_index], box_index);
+      }
+    }
+  } else {
+    for (int64_t box_index = 0; box_index < num_boxes; ++box_index) {
+      candidate_boxes.emplace_back(class_scores[box_index], box_index);
+    }
+  }
+
+  auto& selected_boxes = scratch.selected_boxes;
+  selected_boxes.Clear();
+  const size_t max_selected = static_cast<size_t>(std::min<int64_t>(max_output_boxes_per_class, num_boxes));
+
+  // The candidates are visited by descending score and ascending index. Rather than sorting all of them, the ones
+  // with the top scores are sorted a chunk at a time, as most classes select their boxes from the first few
+  // candidates. The chunks double in size, in case many candidates are suppressed.
+  const auto higher_score = [](const BoxInfoPtr& lhs, const BoxInfoPtr& rhs) { return rhs < lhs; };
+  size_t chunk_size = std::max<size_t>(64, 2 * max_selected);
+  size_t sorted_end = 0;
+  for (size_t next = 0; next < candidate_boxes.size() && selected_box_indices.size() < max_selected; ++next) {
+    if (next == sorted_end) {
+      sorted_end = next + std::min(chunk_size, candidate_boxes.size() - next);
+      std::partial_sort(candidate_boxes.begin() + next, candidate_boxes.begin() + sorted_end, candidate_boxes.end(),
+                        higher_score);
+      chunk_size *= 2;
+    }
+
+    // Check with existing selected boxes for this class, suppress if exceed the IOU (Intersection Over Union) threshold
+    const int64_t box_index = candidate_boxes[next].index_;
+    const BoxCorners box = GetBoxCorners(batch_boxes + 4 * box_index, center_point_box);
+    if (!selected_boxes.Suppress(box, iou_threshold)) {
+      selected_boxes.Add(box);
+      selected_box_indices.push_back(box_index);
+    }
+  }
+}
+
+}  // namespace
+
 Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
   PrepareContext pc;
   ORT_RETURN_IF_ERROR(PrepareCompute(ctx, pc));
@@ -131,75 +288,45 @@ Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
 
   const auto* const boxes_data = pc.boxes_data_;
   const auto* const scores_data = pc.scores_data_;
-
-  struct BoxInfoPtr {
-    float score_{};
-    int64_t index_{};
-
-    BoxInfoPtr() = default;
-    explicit BoxInfoPtr(float score, int64_t idx) : score_(score), index_(idx) {}
-    inline bool operator<(const BoxInfoPtr& rhs) const {
-      return score_ < rhs.score_ || (score_ == rhs.score_ && index_ > rhs.index_);
-    }
-  };
-
   const auto center_point_box = GetCenterPointBox();
-
-  std::vector<SelectedIndex> selected_indices;
-  std::vector<BoxInfoPtr> selected_boxes_inside_class;
-  selected_boxes_inside_class.reserve(std::min<size_t>(static_cast<size_t>(max_output_boxes_per_class), pc.num_boxes_));
-
-  for (int64_t batch_index = 0; batch_index < pc.num_batches_; ++batch_index) {
-    for (int64_t class_index = 0; class_index < pc.num_classes_; ++class_index) {
-      int64_t box_score_offset = (batch_index * pc.num_classes_ + class_index) * pc.num_boxes_;
-      const float* batch_boxes = boxes_data + (batch_index * pc.num_boxes_ * 4);
-      std::vector<BoxInfoPtr> candidate_boxes;
-      candidate_boxes.reserve(pc.num_boxes_);
-
-      // Filter by score_threshold_
-      const auto* class_scores = scores_data + box_score_offset;
-      if (pc.score_threshold_ != nullptr) {
-        for (int64_t box_index = 0; box_index < pc.num_boxes_; ++box_index, ++class_scores) {
-          if (*class_scores > score_threshold) {
-            candidate_boxes.emplace_back(*class_scores, box_index);
-          }
-        }
-      } else {
-        for (int64_t box_index = 0; box_index < pc.num_boxes_; ++box_index, ++class_scores) {
-          candidate_boxes.emplace_back(*class_scores, box_index);
-        }
-      }
-      std::priority_queue<BoxInfoPtr, std::vector<BoxInfoPtr>> sorted_boxes(std::less<BoxInfoPtr>(), std::move(candidate_boxes));
-
-      selected_boxes_inside_class.clear();
-      // Get the next box with top score, filter by iou_threshold
-      while (!sorted_boxes.empty() && static_cast<int64_t>(selected_boxes_inside_class.size()) < max_output_boxes_per_class) {
-        const BoxInfoPtr& next_top_score = sorted_boxes.top();
-
-        bool selected = true;
-        // Check with existing selected boxes for this class, suppress if exceed the IOU (Intersection Over Union) threshold
-        for (const auto& selected_index : selected_boxes_inside_class) {
-          if (SuppressByIOU(batch_boxes, next_top_score.index_, selected_index.index_, center_point_box, iou_threshold)) {
-            selected = false;
-            break;
-          }
+  const bool has_score_threshold = pc.score_threshold_ != nullptr;
+  const int64_t num_boxes = pc.num_boxes_;
+
+  // The (batch, class) pairs are independent, and are processed in parallel. Their selected boxes are concatenated
+  // in order afterwards.
+  const int64_t num_batch_classes = pc.num_batches_ * pc.num_classes_;
+  std::vector<std::vector<int64_t>> selected_box_indices(onnxruntime::narrow<size_t>(num_batch_classes));
+  const TensorOpCost cost{static_cast<double>(num_boxes * sizeof(float)), 0,
+                          static_cast<double>(num_boxes) * 16.0};
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(num_batch_classes), cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        ClassSelectionScratch scratch;
+        scratch.candidate_boxes.reserve(onnxruntime::narrow<size_t>(num_boxes));
+        for (std::ptrdiff_t batch_class = first; batch_class < last; ++batch_class) {
+          const int64_t batch_index = batch_class / pc.num_classes_;
+          SelectBoxesOfClass(boxes_data + batch_index * num_boxes * 4, scores_data + batch_class * num_boxes,
+                             num_boxes, has_score_threshold, score_threshold, max_output_boxes_per_class,
+                             iou_threshold, center_point_box, scratch,
+                             selected_box_indices[static_cast<size_t>(batch_class)]);
         }
+      });
 
-        if (selected) {
-          selected_boxes_inside_class.push_back(next_top_score);
-          selected_indices.emplace_back(batch_index, class_index, next_top_score.index_);
-        }
-        sorted_boxes.pop();
-      }  //while
-    }    //for class_index
-  }      //for batch_index
+  size_t num_selected = 0;
+  for (const auto& box_indices : selected_box_indices) {
+    num_selected += box_indices.size();
+  }
 
   constexpr auto last_dim = 3;
-  const auto num_selected = selected_indices.size();
   Tensor* output = ctx->Output(0, {static_cast<int64_t>(num_selected), last_dim});
   ORT_ENFORCE(output != nullptr);
   static_assert(last_dim * sizeof(int64_t) == sizeof(SelectedIndex), "Possible modification of SelectedIndex");
-  memcpy(output->MutableData<int64_t>(), selected_indices.data(), num_selected * sizeof(SelectedIndex));
+  auto* selected_indices = reinterpret_cast<SelectedIndex*>(output->MutableData<int64_t>());
+  for (int64_t batch_class = 0; batch_class < num_batch_classes; ++batch_class) {
+    for (int64_t box_index : selected_box_indices[static_cast<size_t>(batch_class)]) {
+      *selected_indices++ = SelectedIndex(batch_class / pc.num_classes_, batch_class % pc.num_classes_, box_index);
+    }
+  }
 
   return Status::OK();
 }
@@ -3,10 +3,11 @@
 
 #include "core/providers/cpu/tensor/nonzero_op.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
-#include <core/common/safeint.h>
-#include "core/util/math_cpuonly.h"
+#include "core/common/narrow.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 // kernel builder functions
@@ -51,6 +52,22 @@ NONZERO_TYPED_KERNEL(float)
 #undef NONZERO_9_TYPED_KERNEL
 #undef NONZERO_TYPED_KERNEL
 
+namespace {
+// The input is scanned in blocks of this many elements, counting the non-zero values of all the blocks in parallel
+// and then writing the coordinates of the non-zero values of all the blocks in parallel.
+constexpr size_t kNonZeroBlockSize = 16384;
+
+template <typename T>
+size_t CountNonZero(const T* data, size_t size) {
+  // branch-free, so that the compiler vectorizes the loop
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    count += static_cast<size_t>(data[i] != T{});
+  }
+  return count;
+}
+}  // namespace
+
 template <typename T>
 Status NonZero<T>::Compute(OpKernelContext* context) const {
   const auto X = context->Input<Tensor>(0);
@@ -59,59 +76,84 @@ Status NonZero<T>::Compute(OpKernelContext* context) const {
   const auto& X_shape = X->Shape();
   assert(X_shape.Size() >= 0);
 
-  const Eigen::Index coordinate_size = X_shape.IsScalar() ? 1 : onnxruntime::narrow<Eigen::Index>(X_shape.NumDimensions());
-  std::vector<int64_t> non_zero_indices_buffer{};
-  // reserve enough space for indices for every element of X
-  non_zero_indices_buffer.reserve(SafeInt<size_t>(X_shape.Size()) * coordinate_size);
-
+  const size_t coordinate_size = X_shape.IsScalar() ? 1 : X_shape.NumDimensions();
+  const size_t size = onnxruntime::narrow<size_t>(X_shape.Size());
   const T* data = X->Data<T>();
 
+  auto* thread_pool = context->GetOperatorThreadPool();
+  const size_t num_blocks = (size + kNonZeroBlockSize - 1) / kNonZeroBlockSize;
+
+  // the offset of the first non-zero value of every block among all the non-zero values
+  std::vector<size_t> block_offsets(num_blocks + 1, 0);
+  concurrency::ThreadPool::TryBatchParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_blocks),
+      [data, size, &block_offsets](std::ptrdiff_t block_num) {
+        const auto block = static_cast<size_t>(block_num);
+        const size_t begin = block * kNonZeroBlockSize;
+        block_offsets[block + 1] = CountNonZero(data + begin, std::min(kNonZeroBlockSize, size - begin));
+      },
+      0);
+  for (size_t block = 0; block < num_blocks; ++block) {
+    block_offsets[block + 1] += block_offsets[block];
+  }
+  const size_t num_non_zero_values = block_offsets[num_blocks];
+
+  Tensor* const Y = context->Output(0, {static_cast<int64_t>(coordinate_size),
+                                        static_cast<int64_t>(num_non_zero_values)});
+  ORT_ENFORCE(Y, "failed to get first output!");
+  if (num_non_zero_values == 0) {
+    return Status::OK();
+  }
+
+  // Y is [coordinate_size, num_non_zero_values], every block writes the coordinates of its non-zero values to its
+  // range of columns
+  int64_t* const y_data = Y->MutableData<int64_t>();
   if (X_shape.IsScalar()) {
-    const T& value = *data;
-    if (value != T{}) {
-      non_zero_indices_buffer.push_back(0);
-    }
-  } else {
-    std::vector<int64_t> coordinate(coordinate_size, 0);
-
-    // as we iterate the entries, increment the coordinate for the current entry
-    // e.g. if shape is {2,2}, we start with 0,0 increment to 0,1 increment to 1,0 and finally 1,1
-    auto increment_coordinate = [&coordinate, &coordinate_size, &X_shape]() {
-      for (Eigen::Index idx = coordinate_size - 1; idx >= 0; --idx) {
-        int64_t& cur_coord = coordinate[idx];
-        if (cur_coord != X_shape[idx] - 1) {
-          ++cur_coord;
-          break;
-        }
-        cur_coord = 0;
-      }
-    };
-
-    for (size_t i = 0, end = onnxruntime::narrow<size_t>(X_shape.Size()); i < end; ++i) {
-      const T& value = *data++;
-      if (value != T{}) {
-        non_zero_indices_buffer.insert(non_zero_indices_buffer.end(),
-                                       coordinate.begin(), coordinate.end());
-      }
-
-      increment_coordinate();
-    }
+    *y_data = 0;
+    return Status::OK();
   }
 
-  const Eigen::Index num_non_zero_values = onnxruntime::narrow<Eigen::Index>(non_zero_indices_buffer.size()) / coordinate_size;
+  concurrency::ThreadPool::TryBatchParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_blocks),
+      [data, size, coordinate_size, num_non_zero_values, y_data, &X_shape, &block_offsets](std::ptrdiff_t block_num) {
+        const auto block = static_cast<size_t>(block_num);
+        size_t column = block_offsets[block];
+        if (column == block_offsets[block + 1]) {
+          return;
+        }
 
-  // transpose result for output
-  ConstEigenMatrixMapRowMajor<int64_t> non_zero_indices_matrix{
-      non_zero_indices_buffer.data(),
-      num_non_zero_values, coordinate_size};
+        const size_t begin = block * kNonZeroBlockSize;
+        const size_t end = std::min(begin + kNonZeroBlockSize, size);
 
-  Tensor* const Y = context->Output(0, {coordinate_size, num_non_zero_values});
-  ORT_ENFORCE(Y, "failed to get first output!");
+        // the coordinate of the first element of the block
+        std::vector<int64_t> coordinate(coordinate_size, 0);
+        for (size_t idx = coordinate_size, remaining = begin; idx-- > 0;) {
+          const auto dim = static_cast<size_t>(X_shape[idx]);
+          coordinate[idx] = static_cast<int64_t>(remaining % dim);
+          remaining /= dim;
+        }
 
-  EigenMatrixMapRowMajor<int64_t> y_matrix{
-      Y->MutableData<int64_t>(),
-      coordinate_size, num_non_zero_values};
-  y_matrix = non_zero_indices_matrix.transpose();
+        // as we iterate the entries, increment the coordinate for the current entry
+        // e.g. if shape is {2,2}, we start with 0,0 increment to 0,1 increment to 1,0 and finally 1,1
+        for (size_t i = begin; i < end; ++i) {
+          if (data[i] != T{}) {
+            for (size_t idx = 0; idx < coordinate_size; ++idx) {
+              y_data[idx * num_non_zero_values + column] = coordinate[idx];
+            }
+            ++column;
+          }
+
+          for (size_t idx = coordinate_size; idx-- > 0;) {
+            int64_t& cur_coord = coordinate[idx];
+            if (cur_coord != X_shape[idx] - 1) {
+              ++cur_coord;
+              break;
+            }
+            cur_coord = 0;
+          }
+        }
+      },
+      0);
 
   return Status::OK();
 }
@@ -2,12 +2,19 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/tensor/unique.h"
+#include <cmath>
+#include <cstring>
 #include <map>
+#include <numeric>
+#include <string_view>
 #include <core/common/safeint.h>
+#include "core/common/flat_hash_map.h"
 #include "core/common/gsl.h"
+#include "core/common/narrow.h"
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/providers/common.h"
 #include "core/providers/op_kernel_type_control.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
@@ -142,65 +149,273 @@ class Subtensor {
   std::vector<T> items_;
 };
 
-template <typename T>
-static void CreateFlattenedOutput(OpKernelContext& context,
-                                  const std::map<const T, int64_t>& offsets,         // map sorted key to unsorted idx
-                                  const std::vector<std::vector<int64_t>>& indices,  // unsorted
-                                  const std::vector<int64_t>& inverse_index,         // unsorted
-                                  bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
-  Tensor& Y = *context.Output(0, {num_unique});
-  Tensor* indices_out = context.Output(1, {num_unique});
-  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(inverse_index.size())});
-  Tensor* counts = context.Output(3, {num_unique});
+namespace {
 
-  auto Y_data = Y.MutableDataAsSpan<T>();
-  gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
-                                                           : gsl::span<int64_t>();
-  gsl::span<int64_t> inverse_indices_data = inverse_indices != nullptr ? inverse_indices->MutableDataAsSpan<int64_t>()
-                                                                       : gsl::span<int64_t>();
-  gsl::span<int64_t> counts_data = counts != nullptr ? counts->MutableDataAsSpan<int64_t>()
-                                                     : gsl::span<int64_t>();
-
-  // iterate using 'offsets' which is sorted, but contains the offset of the unsorted entry
-  auto offsets_iter = offsets.begin();
-  for (int64_t i = 0, end = num_unique; i < end; ++i, ++offsets_iter) {
-    // write sequentially if we want sorted output, use the unsorted_idx if not
-    auto unsorted_idx = offsets_iter->second;
-    auto output_idx = sorted ? i : unsorted_idx;
+// The key of an element of a flattened input in the hash maps of Unique. The elements with equal keys are the same
+// unique value, as for operator<: -0.f equals 0.f. All the NaNs are a single unique value as well.
+template <typename T>
+struct UniqueKey {
+  using Type = T;
+  static T Of(const T& value) { return value; }
+};
 
-    Y_data[onnxruntime::narrow<size_t>(output_idx)] = offsets_iter->first;
+template <>
+struct UniqueKey<std::string> {
+  using Type = std::string_view;
+  static std::string_view Of(const std::string& value) { return value; }
+};
 
-    if (indices_out) {
-      indices_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].front();
+template <>
+struct UniqueKey<float> {
+  using Type = uint32_t;
+  static uint32_t Of(float value) {
+    if (value == 0.f) {
+      return 0;
+    }
+    if (std::isnan(value)) {
+      return 0x7fc00000;
     }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+};
 
-    if (counts) {
-      counts_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].size();
+// The order of the sorted unique values, with the NaNs last.
+template <typename T>
+bool UniqueLess(const T& lhs, const T& rhs) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return std::isnan(rhs) ? !std::isnan(lhs) : lhs < rhs;
+  } else {
+    return lhs < rhs;
+  }
+}
+
+// Sorts ids whose ranges [range_begins[r], range_begins[r + 1]) are sorted already, by merging pairs of ranges in
+// parallel until a single range is left.
+template <typename Less>
+void MergeSortedRanges(std::vector<int64_t>& ids, std::vector<size_t> range_begins, Less less,
+                       concurrency::ThreadPool* thread_pool) {
+  std::vector<int64_t> merged(ids.size());
+  while (range_begins.size() > 2) {
+    const size_t num_ranges = range_begins.size() - 1;
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>((num_ranges + 1) / 2),
+        [&ids, &merged, &range_begins, num_ranges, &less](std::ptrdiff_t pair) {
+          const size_t first = static_cast<size_t>(pair) * 2;
+          const size_t last = std::min(first + 2, num_ranges);
+          const auto begin = ids.begin() + range_begins[first];
+          const auto middle = ids.begin() + range_begins[first + 1];
+          const auto end = ids.begin() + range_begins[last];
+          std::merge(begin, middle, middle, end, merged.begin() + range_begins[first], less);
+        });
+    ids.swap(merged);
+
+    std::vector<size_t> merged_begins;
+    for (size_t r = 0; r < num_ranges; r += 2) {
+      merged_begins.push_back(range_begins[r]);
     }
+    merged_begins.push_back(range_begins.back());
+    range_begins = std::move(merged_begins);
   }
+}
 
-  if (inverse_indices) {
-    if (sorted) {
-      // need to convert unsorted entries in the inverse index to their sorted values
-      std::vector<int64_t> unsorted_to_sorted;
-      unsorted_to_sorted.resize(onnxruntime::narrow<size_t>(num_unique));
-      int64_t sorted_idx = 0;
-      for (const auto& offset : offsets) {
-        unsorted_to_sorted[onnxruntime::narrow<size_t>(offset.second)] = sorted_idx++;
-      }
+// Unique of the flattened input.
+//
+// The elements are partitioned by the hash of their value, keeping the order of the input within every partition.
+// The partitions are deduplicated in parallel, each with a hash map of its own, which gives the first index and the
+// count of the unique values of the partition. The unique values of all the partitions are then ordered by their first
+// index, or by value if sorted, by sorting them within every partition and merging the partitions.
+template <typename T>
+void ComputeFlattenedUnique(OpKernelContext& context, gsl::span<const T> data, bool sorted) {
+  using Key = typename UniqueKey<T>::Type;
+  constexpr size_t kBlockSize = 16384;
+  constexpr size_t kMaxPartitions = 256;
+
+  auto* thread_pool = context.GetOperatorThreadPool();
+  const size_t size = data.size();
+  const size_t num_blocks = (size + kBlockSize - 1) / kBlockSize;
+
+  size_t num_partitions = 1;
+  const auto degree_of_parallelism = static_cast<size_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool));
+  while (num_partitions < kMaxPartitions && num_partitions < 4 * degree_of_parallelism &&
+         num_partitions * kBlockSize < size) {
+    num_partitions *= 2;
+  }
+  int partition_shift = 64;
+  for (size_t n = num_partitions; n > 1; n /= 2) {
+    --partition_shift;
+  }
 
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[onnxruntime::narrow<size_t>(i)] = unsorted_to_sorted[onnxruntime::narrow<size_t>(inverse_index[i])];
-      }
-    } else {
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = inverse_index[i];
+  // the indices of the elements grouped by partition, in the order of the input within every partition
+  std::vector<int64_t> element_indices(size);
+  std::vector<size_t> partition_begins(num_partitions + 1, 0);
+  if (num_partitions == 1) {
+    std::iota(element_indices.begin(), element_indices.end(), int64_t{0});
+    partition_begins[1] = size;
+  } else {
+    std::vector<uint8_t> partitions(size);
+    // the number of elements of every block in every partition, and then where the block writes its elements
+    std::vector<size_t> block_offsets(num_blocks * num_partitions, 0);
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_blocks),
+        [&](std::ptrdiff_t block_num) {
+          const auto block = static_cast<size_t>(block_num);
+          size_t* counts = block_offsets.data() + block * num_partitions;
+          for (size_t i = block * kBlockSize, end = std::min(i + kBlockSize, size); i < end; ++i) {
+            const auto hash = static_cast<uint64_t>(FlatHashMapHash<Key>{}(UniqueKey<T>::Of(data[i])));
+            const auto partition = static_cast<uint8_t>((hash * 0x9e3779b97f4a7c15ULL) >> partition_shift);
+            partitions[i] = partition;
+            ++counts[partition];
+          }
+        });
+
+    size_t offset = 0;
+    for (size_t partition = 0; partition < num_partitions; ++partition) {
+      partition_begins[partition] = offset;
+      for (size_t block = 0; block < num_blocks; ++block) {
+        size_t& block_offset = block_offsets[block * num_partitions + partition];
+        const size_t count = block_offset;
+        block_offset = offset;
+        offset += count;
       }
     }
+    partition_begins[num_partitions] = offset;
+
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_blocks),
+        [&](std::ptrdiff_t block_num) {
+          const auto block = static_cast<size_t>(block_num);
+          size_t* offsets = block_offsets.data() + block * num_partitions;
+          for (size_t i = block * kBlockSize, end = std::min(i + kBlockSize, size); i < end; ++i) {
+            element_indices[offsets[partitions[i]]++] = static_cast<int64_t>(i);
+          }
+        });
+  }
+
+  // Deduplicate every partition. The unique values of a partition are numbered in the order of their first index.
+  // inverse_index holds the number of the unique value of every element within its partition for now.
+  struct PartitionUniques {
+    std::vector<int64_t> first_indices;
+    std::vector<int64_t> counts;
+  };
+  std::vector<PartitionUniques> partition_uniques(num_partitions);
+  std::vector<int64_t> inverse_index(size);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_partitions),
+      [&](std::ptrdiff_t partition_num) {
+        const auto partition = static_cast<size_t>(partition_num);
+        auto& uniques = partition_uniques[partition];
+        FlatHashMap<Key, int64_t> unique_numbers;
+        for (size_t e = partition_begins[partition]; e < partition_begins[partition + 1]; ++e) {
+          const int64_t i = element_indices[e];
+          const auto number = static_cast<int64_t>(uniques.first_indices.size());
+          const auto inserted = unique_numbers.Insert(UniqueKey<T>::Of(data[onnxruntime::narrow<size_t>(i)]), number);
+          if (inserted.second) {
+            uniques.first_indices.push_back(i);
+            uniques.counts.push_back(0);
+          }
+          ++uniques.counts[onnxruntime::narrow<size_t>(*inserted.first)];
+          inverse_index[onnxruntime::narrow<size_t>(i)] = *inserted.first;
+        }
+      });
+
+  // Number the unique values of all the partitions one partition after the other, and order them by first index or
+  // by value.
+  std::vector<size_t> unique_begins(num_partitions + 1, 0);
+  for (size_t partition = 0; partition < num_partitions; ++partition) {
+    unique_begins[partition + 1] = unique_begins[partition] + partition_uniques[partition].first_indices.size();
+  }
+  const size_t num_unique = unique_begins[num_partitions];
+  std::vector<int64_t> first_indices(num_unique);
+  std::vector<int64_t> counts(num_unique);
+  std::vector<int64_t> order(num_unique);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_partitions),
+      [&](std::ptrdiff_t partition_num) {
+        const auto partition = static_cast<size_t>(partition_num);
+        const auto& uniques = partition_uniques[partition];
+        const size_t begin = unique_begins[partition];
+        std::copy(uniques.first_indices.begin(), uniques.first_indices.end(), first_indices.begin() + begin);
+        std::copy(uniques.counts.begin(), uniques.counts.end(), counts.begin() + begin);
+        std::iota(order.begin() + begin, order.begin() + unique_begins[partition + 1], static_cast<int64_t>(begin));
+      });
+  partition_uniques.clear();
+
+  if (sorted) {
+    const auto value_less = [&data, &first_indices](int64_t lhs, int64_t rhs) {
+      return UniqueLess(data[onnxruntime::narrow<size_t>(first_indices[onnxruntime::narrow<size_t>(lhs)])],
+                        data[onnxruntime::narrow<size_t>(first_indices[onnxruntime::narrow<size_t>(rhs)])]);
+    };
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_partitions),
+        [&order, &unique_begins, &value_less](std::ptrdiff_t partition_num) {
+          const auto partition = static_cast<size_t>(partition_num);
+          std::sort(order.begin() + unique_begins[partition], order.begin() + unique_begins[partition + 1],
+                    value_less);
+        });
+    MergeSortedRanges(order, unique_begins, value_less, thread_pool);
+  } else {
+    // the unique values of a partition are in the order of their first index already
+    MergeSortedRanges(
+        order, unique_begins,
+        [&first_indices](int64_t lhs, int64_t rhs) {
+          return first_indices[onnxruntime::narrow<size_t>(lhs)] < first_indices[onnxruntime::narrow<size_t>(rhs)];
+        },
+        thread_pool);
+  }
+
+  Tensor& Y = *context.Output(0, {static_cast<int64_t>(num_unique)});
+  Tensor* indices_out = context.Output(1, {static_cast<int64_t>(num_unique)});
+  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(size)});
+  Tensor* counts_out = context.Output(3, {static_cast<int64_t>(num_unique)});
+
+  auto Y_data = Y.MutableDataAsSpan<T>();
+  gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
+                                                           : gsl::span<int64_t>();
+  gsl::span<int64_t> counts_data = counts_out != nullptr ? counts_out->MutableDataAsSpan<int64_t>()
+                                                         : gsl::span<int64_t>();
+
+  // the position of every unique value in the output
+  std::vector<int64_t> output_positions(inverse_indices != nullptr ? num_unique : 0);
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_unique),
+      TensorOpCost{static_cast<double>(sizeof(T) + 3 * sizeof(int64_t)),
+                   static_cast<double>(sizeof(T) + 3 * sizeof(int64_t)), 4.0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto output_idx = static_cast<size_t>(first); output_idx < static_cast<size_t>(last); ++output_idx) {
+          const auto unique_idx = onnxruntime::narrow<size_t>(order[output_idx]);
+          const int64_t first_index = first_indices[unique_idx];
+          Y_data[output_idx] = data[onnxruntime::narrow<size_t>(first_index)];
+          if (indices_out) {
+            indices_data[output_idx] = first_index;
+          }
+          if (counts_out) {
+            counts_data[output_idx] = counts[unique_idx];
+          }
+          if (inverse_indices) {
+            output_positions[unique_idx] = static_cast<int64_t>(output_idx);
+          }
+        }
+      });
+
+  if (inverse_indices) {
+    auto inverse_indices_data = inverse_indices->MutableDataAsSpan<int64_t>();
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_partitions),
+        [&](std::ptrdiff_t partition_num) {
+          const auto partition = static_cast<size_t>(partition_num);
+          const size_t unique_begin = unique_begins[partition];
+          for (size_t e = partition_begins[partition]; e < partition_begins[partition + 1]; ++e) {
+            const auto i = onnxruntime::narrow<size_t>(element_indices[e]);
+            inverse_indices_data[i] = output_positions[unique_begin + onnxruntime::narrow<size_t>(inverse_index[i])];
+          }
+        });
   }
 }
 
+}  // namespace
+
 template <typename T>
 static void CreateOutput(OpKernelContext& context,
                          const TensorShape& subtensor_shape,
@@ -306,30 +521,7 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
   auto data = input.DataAsSpan<T>();
 
   if (flatten_) {
-    std::map<const T, int64_t> offsets;  // offset of entry in indices. provides map between sorted and unsorted values
-    std::vector<std::vector<int64_t>> indices;
-    std::vector<int64_t> inverse_index;
-
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
-    int64_t num_unique = 0;
-
-    for (int64_t i = 0, end = input.Shape().Size(); i < end; ++i) {
-      auto entry = offsets.find(data[onnxruntime::narrow<size_t>(i)]);
-      if (entry == offsets.end()) {
-        offsets[data[onnxruntime::narrow<size_t>(i)]] = num_unique;
-        inverse_index.push_back({num_unique});
-        indices.push_back({i});
-        ++num_unique;
-      } else {
-        size_t indices_idx = onnxruntime::narrow<size_t>(entry->second);
-        indices[indices_idx].push_back(i);
-        inverse_index.push_back(onnxruntime::narrow<int64_t>(indices_idx));
-      }
-    }
-
-    CreateFlattenedOutput(context, offsets, indices, inverse_index, sort_);
+    ComputeFlattenedUnique(context, data, sort_);
   } else {
     const auto& input_shape = input.Shape();
     const int64_t input_dims = static_cast<int64_t>(input_shape.NumDimensions());
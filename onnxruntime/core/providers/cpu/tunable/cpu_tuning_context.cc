@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#if !defined(ORT_MINIMAL_BUILD)
+
+#include "core/providers/cpu/tunable/cpu_tuning_context.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "core/common/cpuid_info.h"
+#include "core/framework/tuning_context.h"
+#define TUNING_CONTEXT_IMPL
+#include "core/framework/tuning_context_impl.h"
+#undef TUNING_CONTEXT_IMPL
+#include "core/providers/cpu/cpu_execution_provider.h"
+#include "onnxruntime_config.h"
+
+namespace onnxruntime {
+namespace cpu {
+namespace tunable {
+
+std::string CpuTuningResultsValidator::GetCpuFeatures() const {
+  const auto& cpu_info = CPUIDInfo::GetCPUIDInfo();
+  std::ostringstream ss;
+  ss << cpu_info.HasSSE3() << cpu_info.HasSSE4_1() << cpu_info.HasAVX() << cpu_info.HasAVX2()
+     << cpu_info.HasF16C() << cpu_info.HasAVX512f() << cpu_info.HasAVX512Skylake() << cpu_info.HasAVX512_BF16()
+     << cpu_info.HasAMX_BF16() << cpu_info.HasArmNeonDot() << cpu_info.HasFp16VectorAcceleration();
+  return ss.str();
+}
+
+Status CpuTuningResultsValidator::ValidateCpuFeatures(const std::string& value) const {
+  auto current = GetCpuFeatures();
+  ORT_RETURN_IF(current != value, "CPU features mismatch: tuning results produced with CPU features ", value,
+                ", onnxruntime currently run with CPU features ", current);
+  return Status::OK();
+}
+
+CpuTuningResultsValidator::CpuTuningResultsValidator() {
+  RegisterValidator(
+      "CPU_FEATURES",
+      [this]() { return GetCpuFeatures(); },
+      [this](const std::string& value) { return ValidateCpuFeatures(value); });
+}
+
+CpuTuningContext::CpuTuningContext(CPUExecutionProvider* ep) : ITuningContext(ep) {}
+
+void CpuTuningContext::EnableTunableOp() {
+#ifdef ORT_NO_RTTI
+  // the signature of a TunableOp is its type name
+  LOGS_DEFAULT(WARNING) << "TunableOp requires RTTI, it stays disabled for CPU Execution Provider";
+#else
+  LOGS_DEFAULT(INFO) << "Enable TunableOp for CPU Execution Provider";
+  enabled_ = true;
+#endif
+}
+
+void CpuTuningContext::DisableTunableOp() {
+  LOGS_DEFAULT(INFO) << "Disable TunableOp for CPU Execution Provider";
+  enabled_ = false;
+}
+
+bool CpuTuningContext::IsTunableOpEnabled() const {
+  return enabled_;
+}
+
+TuningResultsManager& CpuTuningContext::GetTuningResultsManager() {
+  return manager_;
+}
+
+const TuningResultsManager& CpuTuningContext::GetTuningResultsManager() const {
+  return manager_;
+}
+
+const TuningResultsValidator& CpuTuningContext::GetTuningResultsValidator() const {
+  return validator_;
+}
+
+}  // namespace tunable
+}  // namespace cpu
+}  // namespace onnxruntime
+
+#endif  // !defined(ORT_MINIMAL_BUILD)
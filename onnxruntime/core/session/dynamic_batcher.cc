@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/dynamic_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/common/safeint.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+DynamicBatcher::DynamicBatcher(int64_t max_batch_size, std::chrono::microseconds max_delay,
+                               AllocatorPtr cpu_allocator, RunFn run_fn)
+    : max_batch_size_(max_batch_size),
+      max_delay_(max_delay),
+      cpu_allocator_(std::move(cpu_allocator)),
+      run_fn_(std::move(run_fn)) {
+  ORT_ENFORCE(max_batch_size_ > 0, "The maximum batch size must be positive.");
+  ORT_ENFORCE(cpu_allocator_ != nullptr);
+}
+
+bool DynamicBatcher::CanBatch(gsl::span<const OrtValue> feeds, const std::vector<OrtValue>& fetches) const {
+  if (feeds.empty()) {
+    return false;
+  }
+
+  int64_t batch_size = -1;
+  for (const auto& feed : feeds) {
+    if (!feed.IsTensor()) {
+      return false;
+    }
+    const auto& tensor = feed.Get<Tensor>();
+    const auto& shape = tensor.Shape();
+    if (tensor.Location().device.Type() != OrtDevice::CPU || shape.NumDimensions() == 0) {
+      return false;
+    }
+    if (batch_size == -1) {
+      batch_size = shape[0];
+    } else if (shape[0] != batch_size) {
+      return false;
+    }
+  }
+
+  if (batch_size < 1 || batch_size > max_batch_size_) {
+    return false;
+  }
+
+  // pre-allocated outputs can't be views of the batched outputs
+  return std::none_of(fetches.begin(), fetches.end(), [](const OrtValue& fetch) { return fetch.IsAllocated(); });
+}
+
+std::string DynamicBatcher::BatchKey(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> output_names) {
+  std::string key;
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    const auto& tensor = feeds[i].Get<Tensor>();
+    key += feed_names[i];
+    key += '\0';
+    key += std::to_string(tensor.GetElementType());
+    const auto dims = tensor.Shape().GetDims();
+    for (size_t d = 1; d < dims.size(); ++d) {
+      key += ',';
+      key += std::to_string(dims[d]);
+    }
+    key += '\0';
+  }
+  key += '\0';
+  for (const auto& name : output_names) {
+    key += name;
+    key += '\0';
+  }
+  return key;
+}
+
+void DynamicBatcher::CloseBatch(const std::string& key, const std::shared_ptr<Batch>& batch) {
+  batch->closed = true;
+  auto it = open_batches_.find(key);
+  if (it != open_batches_.end() && it->second == batch) {
+    open_batches_.erase(it);
+  }
+  batch->cv.notify_all();
+}
+
+Status DynamicBatcher::Run(const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                           gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                           std::vector<OrtValue>& fetches) {
+  Request request{feeds, &fetches, feeds[0].Get<Tensor>().Shape()[0], std::chrono::high_resolution_clock::now(),
+                  Status::OK()};
+  const std::string key = BatchKey(feed_names, feeds, output_names);
+
+  std::shared_ptr<Batch> batch;
+  bool is_leader = false;
+  {
+    std::unique_lock<OrtMutex> lock(mutex_);
+    stats_.num_requests++;
+    stats_.queue_depth++;
+    stats_.max_queue_depth = std::max(stats_.max_queue_depth, stats_.queue_depth);
+
+    auto it = open_batches_.find(key);
+    if (it != open_batches_.end() && it->second->batch_size + request.batch_size > max_batch_size_) {
+      // the request doesn't fit, let the batch run and start a new one
+      CloseBatch(key, it->second);
+      it = open_batches_.end();
+    }
+
+    if (it == open_batches_.end()) {
+      batch = std::make_shared<Batch>();
+      batch->run_options = &run_options;
+      batch->feed_names = feed_names;
+      batch->output_names = output_names;
+      open_batches_.emplace(key, batch);
+      is_leader = true;
+    } else {
+      batch = it->second;
+    }
+
+    batch->requests.push_back(&request);
+    batch->batch_size += request.batch_size;
+    if (batch->batch_size == max_batch_size_) {
+      CloseBatch(key, batch);
+    }
+
+    if (!is_leader) {
+      // the leader runs the batch, wait for it to complete
+      while (!batch->done) {
+        batch->cv.wait(lock);
+      }
+      return request.status;
+    }
+
+    const auto deadline = request.arrival_time + max_delay_;
+    while (!batch->closed) {
+      const auto now = std::chrono::high_resolution_clock::now();
+      if (now >= deadline) {
+        CloseBatch(key, batch);
+        break;
+      }
+      batch->cv.wait_for(lock, deadline - now);
+    }
+
+    // the requests of a closed batch don't change anymore
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    stats_.num_batches++;
+    for (const Request* r : batch->requests) {
+      const int64_t queue_time_us = TimeDiffMicroSeconds(r->arrival_time, start_time);
+      stats_.total_queue_time_us += queue_time_us;
+      stats_.max_queue_time_us = std::max(stats_.max_queue_time_us, queue_time_us);
+    }
+  }
+
+  // the other requests of the batch wait for the leader, so any error must be reported to them as well
+  ORT_TRY {
+    RunBatch(*batch);
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      const Status status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exception during batched run: ", ex.what());
+      for (Request* r : batch->requests) {
+        r->status = status;
+      }
+    });
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    stats_.queue_depth -= static_cast<int64_t>(batch->requests.size());
+    batch->done = true;
+    batch->cv.notify_all();
+  }
+  return request.status;
+}
+
+void DynamicBatcher::ConcatFeeds(const Batch& batch, std::vector<OrtValue>& batched_feeds) const {
+  const size_t num_feeds = batch.feed_names.size();
+  batched_feeds.resize(num_feeds);
+  for (size_t i = 0; i < num_feeds; ++i) {
+    const auto& first = batch.requests.front()->feeds[i].Get<Tensor>();
+    TensorShapeVector dims = first.Shape().AsShapeVector();
+    dims[0] = batch.batch_size;
+    Tensor::InitOrtValue(first.DataType(), TensorShape(dims), cpu_allocator_, batched_feeds[i]);
+    auto* batched = batched_feeds[i].GetMutable<Tensor>();
+
+    if (batched->IsDataTypeString()) {
+      std::string* dst = batched->MutableData<std::string>();
+      for (const Request* r : batch.requests) {
+        const auto src = r->feeds[i].Get<Tensor>().DataAsSpan<std::string>();
+        dst = std::copy(src.begin(), src.end(), dst);
+      }
+    } else {
+      char* dst = static_cast<char*>(batched->MutableDataRaw());
+      for (const Request* r : batch.requests) {
+        const auto& src = r->feeds[i].Get<Tensor>();
+        const size_t num_bytes = src.SizeInBytes();
+        if (num_bytes > 0) {
+          memcpy(dst, src.DataRaw(), num_bytes);
+        }
+        dst += num_bytes;
+      }
+    }
+  }
+}
+
+void DynamicBatcher::RunBatch(Batch& batch) {
+  const RunOptions& run_options = *batch.run_options;
+  if (batch.requests.size() == 1) {
+    Request& request = *batch.requests.front();
+    request.status = run_fn_(run_options, batch.feed_names, request.feeds, batch.output_names, *request.fetches);
+    return;
+  }
+
+  std::vector<OrtValue> batched_feeds;
+  std::vector<OrtValue> batched_fetches;
+  ConcatFeeds(batch, batched_feeds);
+  const Status status = run_fn_(run_options, batch.feed_names, batched_feeds, batch.output_names, batched_fetches);
+  if (!status.IsOK()) {
+    for (Request* request : batch.requests) {
+      request->status = status;
+    }
+    return;
+  }
+
+  const bool is_row_wise = std::all_of(
+      batched_fetches.begin(), batched_fetches.end(), [&batch](const OrtValue& fetch) {
+        return fetch.IsTensor() && fetch.Get<Tensor>().Shape().NumDimensions() > 0 &&
+               fetch.Get<Tensor>().Shape()[0] == batch.batch_size;
+      });
+  if (!is_row_wise) {
+    // the outputs can't be split by request, e.g. the model reduces over the batch axis
+    for (Request* request : batch.requests) {
+      request->status = run_fn_(run_options, batch.feed_names, request->feeds, batch.output_names,
+                                *request->fetches);
+    }
+    return;
+  }
+
+  const auto tensor_type = DataTypeImpl::GetType<Tensor>();
+  int64_t row = 0;
+  for (Request* request : batch.requests) {
+    auto& fetches = *request->fetches;
+    fetches.resize(batched_fetches.size());
+    for (size_t i = 0; i < batched_fetches.size(); ++i) {
+      const OrtValue& batched_fetch = batched_fetches[i];
+      const auto& batched = batched_fetch.Get<Tensor>();
+      TensorShapeVector dims = batched.Shape().AsShapeVector();
+      dims[0] = request->batch_size;
+      const int64_t row_size = batched.Shape().Size() / batch.batch_size;
+      const ptrdiff_t offset = SafeInt<ptrdiff_t>(row) * row_size * batched.DataType()->Size();
+
+      // a view of the rows of the request, which keeps the batched output alive
+      auto slice = std::make_unique<Tensor>(batched.DataType(), TensorShape(dims),
+                                            const_cast<void*>(batched.DataRaw()), batched.Location(), offset);
+      fetches[i].Init(slice.release(), tensor_type,
+                      [batched_fetch](void* p) { delete static_cast<Tensor*>(p); });
+    }
+    row += request->batch_size;
+  }
+}
+
+DynamicBatchingStats DynamicBatcher::GetStats() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/gsl.h"
+#include "core/common/inlined_containers.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/run_options.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+struct DynamicBatchingStats {
+  // the number of requests that went through the batcher
+  int64_t num_requests{0};
+  // the number of runs of the model they were coalesced into
+  int64_t num_batches{0};
+  // the number of requests currently waiting for their batch to run or completing
+  int64_t queue_depth{0};
+  int64_t max_queue_depth{0};
+  // the time between the arrival of a request and the start of its batch
+  int64_t total_queue_time_us{0};
+  int64_t max_queue_time_us{0};
+};
+
+// Coalesces concurrent Run() requests into a single run of the model along the batch axis, the first dimension of
+// every input.
+//
+// Requests are compatible if they have the same input names, the same element types and the same dimensions except
+// the first one, and the same output names. The first request of a batch waits for up to max_delay for compatible
+// requests to join it, or until the batch holds max_batch_size rows, then concatenates the inputs of all the requests,
+// runs the model once and hands out a slice of every output to each request. The slices are views of the batched
+// outputs, which live until the last slice is released, so no output is copied.
+//
+// The rows of the batch must be independent, i.e. the model must compute the first dimension of every output row
+// by row. If an output of the batched run doesn't have the size of the batch as its first dimension, the requests are
+// run individually instead.
+class DynamicBatcher {
+ public:
+  using RunFn = std::function<Status(const RunOptions& run_options,
+                                     gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches)>;
+
+  // cpu_allocator allocates the batched inputs. run_fn runs the model.
+  DynamicBatcher(int64_t max_batch_size, std::chrono::microseconds max_delay, AllocatorPtr cpu_allocator,
+                 RunFn run_fn);
+
+  // Whether a request can be batched: the inputs must be CPU tensors with a batch dimension of at most
+  // max_batch_size rows, and the outputs must be allocated by the run.
+  bool CanBatch(gsl::span<const OrtValue> feeds, const std::vector<OrtValue>& fetches) const;
+
+  // Runs a request as part of a batch. Blocks until the batch ran.
+  // The run options of the first request of a batch apply to the whole batch.
+  Status Run(const RunOptions& run_options, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+             gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  DynamicBatchingStats GetStats() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(DynamicBatcher);
+
+  struct Request {
+    gsl::span<const OrtValue> feeds;
+    std::vector<OrtValue>* fetches;
+    int64_t batch_size;
+    TimePoint arrival_time;
+    Status status;
+  };
+
+  struct Batch {
+    // the parameters of the first request, which runs the batch
+    const RunOptions* run_options;
+    gsl::span<const std::string> feed_names;
+    gsl::span<const std::string> output_names;
+
+    std::vector<Request*> requests;
+    int64_t batch_size{0};
+    // no request can join the batch anymore
+    bool closed{false};
+    // the batch ran, the status and the fetches of all the requests are set
+    bool done{false};
+    OrtCondVar cv;
+  };
+
+  static std::string BatchKey(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                              gsl::span<const std::string> output_names);
+
+  // Closes batch to new requests. mutex_ must be held.
+  void CloseBatch(const std::string& key, const std::shared_ptr<Batch>& batch);
+
+  void RunBatch(Batch& batch);
+  void ConcatFeeds(const Batch& batch, std::vector<OrtValue>& batched_feeds) const;
+
+  const int64_t max_batch_size_;
+  const std::chrono::microseconds max_delay_;
+  AllocatorPtr cpu_allocator_;
+  RunFn run_fn_;
+
+  mutable OrtMutex mutex_;
+  // the batches that requests can still join, by compatibility key
+  InlinedHashMap<std::string, std::shared_ptr<Batch>> open_batches_;
+  DynamicBatchingStats stats_;
+};
+
+}  // namespace onnxruntime
@@ -272,6 +272,9 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
 
   use_per_session_threads_ = session_options.use_per_session_threads;
   force_spinning_stop_between_runs_ = session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigForceSpinningStop, "0") == "1";
+  ORT_THROW_IF_ERROR(concurrency::ThreadPool::ParseLoopPriority(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigThreadPoolPriority, "normal"),
+      thread_pool_priority_));
 
   if (use_per_session_threads_) {
     LOGS(*session_logger_, INFO) << "Creating and using per session threadpools since use_per_session_threads_ is true";
@@ -301,6 +304,8 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         if (session_options_.config_options.TryGetConfigEntry(kOrtSessionOptionsConfigIntraOpThreadAffinities, to.affinity_str)) {
           ORT_ENFORCE(!to.affinity_str.empty(), "Affinity string must not be empty");
         }
+        to.numa_aware =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpNumaAware, "0") == "1";
         to.auto_set_affinity = to.thread_pool_size == 0 &&
                                session_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL &&
                                to.affinity_str.empty();
@@ -311,6 +316,20 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
 
         thread_pool_ =
             concurrency::CreateThreadPool(&Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
+
+        const std::string cost_model_str =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpParallelForCostModel, "");
+        if (thread_pool_ && !cost_model_str.empty()) {
+          concurrency::ParallelForCostModel cost_model;
+          if (cost_model_str == "calibrate") {
+            cost_model = concurrency::ThreadPool::CalibrateCostModel(thread_pool_.get());
+            LOGS(*session_logger_, INFO) << "Calibrated the cost model of the intra op thread pool: "
+                                         << concurrency::ThreadPool::CostModelToString(cost_model);
+          } else {
+            ORT_THROW_IF_ERROR(concurrency::ThreadPool::ParseCostModel(cost_model_str, cost_model));
+          }
+          thread_pool_->SetCostModel(cost_model);
+        }
       }
     }
     if (session_options_.execution_mode == ExecutionMode::ORT_PARALLEL) {
@@ -445,6 +464,27 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, const
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
 InferenceSession::~InferenceSession() {
+  {
+    // the runs scheduled by RunAsync() use the session
+    std::unique_lock<OrtMutex> lock(async_runs_mutex_);
+    while (num_pending_async_runs_ > 0) {
+      async_runs_cv_.wait(lock);
+    }
+  }
+
+  // A RunAsync() callback may release the session on a worker thread of one of the session's own thread pools, which
+  // can't wait for itself to exit. The pools are then destroyed on another thread, once the callback returned.
+  const auto is_worker_of = [](const std::unique_ptr<concurrency::ThreadPool>& tp) {
+    return tp != nullptr && tp->CurrentThreadId() != -1;
+  };
+  if (is_worker_of(thread_pool_) || is_worker_of(inter_op_thread_pool_)) {
+    std::thread([intra_op_thread_pool = std::move(thread_pool_),
+                 inter_op_thread_pool = std::move(inter_op_thread_pool_)]() mutable {
+      inter_op_thread_pool.reset();
+      intra_op_thread_pool.reset();
+    }).detach();
+  }
+
   if (session_options_.enable_profiling) {
     ORT_TRY {
       EndProfiling();
@@ -1459,6 +1499,20 @@ common::Status InferenceSession::Initialize() {
         }
       }
 
+      if (session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigCpuGraphCaptureEnable, "0") ==
+          "1") {
+        // Same constraints as the CUDA Graph feature: the replay runs the kernels of the main graph only.
+        if (HasControlflowNodes(graph) ||
+            !AreAllNodesInMainGraphAssignedToOneEp(graph, onnxruntime::kCpuExecutionProvider)) {
+          ORT_RETURN_IF_ERROR_SESSIONID_(
+              ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
+                              "This session cannot use the CPU graph capture as requested by the user "
+                              "as the model has control flow nodes or nodes not assigned to the CPU EP."));
+        }
+        LOGS(*session_logger_, INFO) << "This session will capture and replay the CPU graph as requested by the user.";
+        cpu_graph_replay_ = std::make_unique<CpuGraphReplay>(*session_state_);
+      }
+
       // Update temporary copies of metadata, input- and output definitions to the same state as the resolved graph
       ORT_RETURN_IF_ERROR_SESSIONID_(SaveModelMetadata(*model_));
 #else   // !defined(ORT_MINIMAL_BUILD)
@@ -1509,6 +1563,17 @@ common::Status InferenceSession::Initialize() {
       }
     }
 
+    if (session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigCpuTunableOpEnable, "0") == "1") {
+      auto* tuning_ctx = execution_providers_.Get(onnxruntime::kCpuExecutionProvider)->GetTuningContext();
+      if (tuning_ctx == nullptr) {
+        ORT_RETURN_IF_ERROR_SESSIONID_(ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                                                       kOrtSessionOptionsConfigCpuTunableOpEnable,
+                                                       " is set but the CPU execution provider doesn't support "
+                                                       "TunableOp in this build."));
+      }
+      tuning_ctx->EnableTunableOp();
+    }
+
     std::vector<TuningResults> tuning_results;
     bool found_tuning_results = false;
     ORT_RETURN_IF_ERROR_SESSIONID_(inference_session_utils::ParseTuningResultsFromModelMetadata(
@@ -1521,6 +1586,25 @@ common::Status InferenceSession::Initialize() {
     // Resolve memory pattern flags of the main graph and subgraph session states
     ResolveMemoryPatternFlags(*session_state_);
 
+    const int64_t dynamic_batching_max_batch_size = ParseStringWithClassicLocale<int64_t>(
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize, "0"));
+    if (dynamic_batching_max_batch_size > 0) {
+      const int64_t max_delay_us = ParseStringWithClassicLocale<int64_t>(
+          session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBatchingMaxDelayUs,
+                                                             "1000"));
+      ORT_RETURN_IF(max_delay_us < 0, "Invalid ", kOrtSessionOptionsConfigDynamicBatchingMaxDelayUs, ": ",
+                    max_delay_us);
+      auto cpu_allocator =
+          execution_providers_.Get(onnxruntime::kCpuExecutionProvider)->GetAllocator(OrtMemTypeDefault);
+      dynamic_batcher_ = std::make_unique<DynamicBatcher>(
+          dynamic_batching_max_batch_size, std::chrono::microseconds(max_delay_us), std::move(cpu_allocator),
+          [this](const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                 gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                 std::vector<OrtValue>& fetches) {
+            return RunImpl(run_options, feed_names, feeds, output_names, &fetches, nullptr);
+          });
+    }
+
     is_inited_ = true;
 
     if (!using_ort_model_bytes_for_initializers_) {
@@ -1892,6 +1976,17 @@ Status InferenceSession::Run(const RunOptions& run_options,
                              gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
                              gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
                              const std::vector<OrtDevice>* p_fetches_device_info) {
+  if (dynamic_batcher_ && p_fetches != nullptr && p_fetches_device_info == nullptr &&
+      feed_names.size() == feeds.size() && dynamic_batcher_->CanBatch(feeds, *p_fetches)) {
+    return dynamic_batcher_->Run(run_options, feed_names, feeds, output_names, *p_fetches);
+  }
+  return RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info);
+}
+
+Status InferenceSession::RunImpl(const RunOptions& run_options,
+                                 gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                 gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
+                                 const std::vector<OrtDevice>* p_fetches_device_info) {
   TimePoint tp;
   if (session_profiler_.IsEnabled()) {
     tp = session_profiler_.Start();
@@ -1914,6 +2009,24 @@ Status InferenceSession::Run(const RunOptions& run_options,
   auto* inter_tp = (control_spinning) ? inter_op_thread_pool_.get() : nullptr;
   ThreadPoolSpinningSwitch runs_refcounter_and_tp_spin_control(intra_tp, inter_tp, current_num_runs_);
 
+  // Priority class of the parallel loops started on this thread, for pools shared with other sessions.
+  auto loop_priority = thread_pool_priority_;
+  std::string run_priority;
+  if (run_options.config_options.TryGetConfigEntry(kOrtRunOptionsConfigThreadPoolPriority, run_priority)) {
+    ORT_RETURN_IF_ERROR_SESSIONID_(concurrency::ThreadPool::ParseLoopPriority(run_priority, loop_priority));
+  }
+  concurrency::ThreadPool::PriorityScope loop_priority_scope(loop_priority);
+
+  // Check if this Run() can replay the captured CPU graph, or capture it.
+  if (cpu_graph_replay_ != nullptr && is_inited_ && p_fetches != nullptr && p_fetches_device_info == nullptr) {
+    bool executed = false;
+    ORT_RETURN_IF_ERROR_SESSIONID_(cpu_graph_replay_->Run(feed_names, feeds, output_names, *p_fetches,
+                                                          run_options.terminate, *session_logger_, executed));
+    if (executed) {
+      return Status::OK();
+    }
+  }
+
   // Check if this Run() is simply going to be a CUDA Graph replay.
   if (cached_execution_provider_for_graph_replay_.IsGraphCaptured()) {
     LOGS(*session_logger_, INFO) << "Replaying the captured "
@@ -2053,6 +2166,11 @@ Status InferenceSession::Run(const RunOptions& run_options,
   TraceLoggingWriteStop(ortrun_activity, "OrtRun");
 #endif
 
+  // The next run with the same inputs captures the CPU graph, using the memory pattern traced by this one.
+  if (retval.IsOK() && cpu_graph_replay_ != nullptr && p_fetches_device_info == nullptr) {
+    cpu_graph_replay_->OnRegularRun(feed_names, feeds, output_names);
+  }
+
   // As two inference runs (one for memory allocation and one for graph capturing)
   // are needed before replaying the captured graph, here run the inference again
   // to capture the graph, so that users just need one session run to capture
@@ -2062,11 +2180,61 @@ Status InferenceSession::Run(const RunOptions& run_options,
     LOGS(*session_logger_, INFO) << "Start the second Run() to capture the graph. "
                                     "The first one is for necessary memory allocation;"
                                     "The second one is for capturing the graph.";
-    ORT_RETURN_IF_ERROR(Run(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
+    ORT_RETURN_IF_ERROR(RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
   }
   return retval;
 }
 
+Status InferenceSession::RunAsync(const RunOptions* run_options, gsl::span<const std::string> feed_names,
+                                  gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                                  std::vector<OrtValue> fetches, RunAsyncCallback callback) {
+  auto* tp = GetInterOpThreadPoolToUse();
+  if (tp == nullptr) {
+    tp = GetIntraOpThreadPoolToUse();
+  }
+  if (tp == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "RunAsync requires a thread pool with at least one thread. "
+                           "Set the number of intra op threads of the session to a value other than 1.");
+  }
+  ORT_RETURN_IF(!callback, "RunAsync requires a callback.");
+
+  {
+    std::lock_guard<OrtMutex> lock(async_runs_mutex_);
+    ++num_pending_async_runs_;
+  }
+
+  // the feeds and the names are copied, the caller may release them as soon as RunAsync returns
+  auto task = [this, run_options,
+               feed_names = std::vector<std::string>(feed_names.begin(), feed_names.end()),
+               feeds = std::vector<OrtValue>(feeds.begin(), feeds.end()),
+               output_names = std::vector<std::string>(output_names.begin(), output_names.end()),
+               fetches = std::move(fetches), callback = std::move(callback)]() mutable {
+    Status status;
+    ORT_TRY {
+      status = Run(run_options != nullptr ? *run_options : RunOptions(), feed_names, feeds, output_names, &fetches,
+                   nullptr);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+
+    // The run is done with the session before the callback is called, which may release the session. Nothing of
+    // the session may be used past this point.
+    {
+      std::lock_guard<OrtMutex> lock(async_runs_mutex_);
+      if (--num_pending_async_runs_ == 0) {
+        async_runs_cv_.notify_all();
+      }
+    }
+    callback(status, fetches);
+  };
+  concurrency::ThreadPool::Schedule(tp, std::move(task));
+  return Status::OK();
+}
+
 common::Status InferenceSession::Run(const NameMLValMap& feeds, gsl::span<const std::string> output_names,
                                      std::vector<OrtValue>* p_fetches) {
   return Run(RunOptions(), feeds, output_names, p_fetches);
@@ -2246,6 +2414,33 @@ Status InferenceSession::SetTuningResults(const std::vector<TuningResults>& trs,
 }
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
+DynamicBatchingStats InferenceSession::GetDynamicBatchingStats() const {
+  return dynamic_batcher_ ? dynamic_batcher_->GetStats() : DynamicBatchingStats{};
+}
+
+Status InferenceSession::GetNodeLatencyHistograms(
+    std::vector<std::pair<const Node*, NodeLatencyHistograms::Snapshot>>& histograms) const {
+  histograms.clear();
+  if (!is_inited_) {
+    LOGS(*session_logger_, ERROR) << "Session was not initialized";
+    return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+  }
+
+  const NodeLatencyHistograms* node_histograms = session_state_->GetNodeLatencyHistograms();
+  if (node_histograms == nullptr) {
+    return Status::OK();
+  }
+
+  const auto& graph_viewer = session_state_->GetGraphViewer();
+  for (const NodeIndex node_index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto snapshot = node_histograms->Get(node_index);
+    if (snapshot.count > 0) {
+      histograms.emplace_back(graph_viewer.GetNode(node_index), snapshot);
+    }
+  }
+  return Status::OK();
+}
+
 AllocatorPtr InferenceSession::GetAllocator(const OrtMemoryInfo& mem_info) const {
   return session_state_->GetAllocator(mem_info);
 }
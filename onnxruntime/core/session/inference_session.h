@@ -12,6 +12,7 @@
 #include "core/common/path_string.h"
 #include "core/common/profiler.h"
 #include "core/common/status.h"
+#include "core/framework/cpu_graph_replay.h"
 #include "core/framework/execution_providers.h"
 #include "core/framework/framework_common.h"
 #include "core/framework/iexecutor.h"
@@ -24,6 +25,7 @@
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/insert_cast_transformer.h"
 #include "core/framework/session_options.h"
+#include "core/session/dynamic_batcher.h"
 #ifdef ENABLE_LANGUAGE_INTEROP_OPS
 #include "core/language_interop_ops/language_interop_ops.h"
 #endif
@@ -309,6 +311,21 @@ class InferenceSession {
                                    std::vector<OrtValue>* p_fetches,
                                    const std::vector<OrtDevice>* p_fetches_device_info = nullptr);
 
+  using RunAsyncCallback = std::function<void(const Status& status, std::vector<OrtValue>& fetches)>;
+
+  /**
+   * Schedule a run of a pre-loaded and pre-intialized model on the inter op thread pool of the session, or on the
+   * intra op thread pool if there is none, and return immediately.
+   * callback is called with the status and the outputs of the run on the thread that ran it.
+   * The session waits for the scheduled runs to complete before it is destroyed.
+   * @param run_options options of the run, nullptr for the defaults. Must remain valid until callback is called.
+   * @param fetches the outputs, as in Run(). Unallocated values are allocated by the run.
+   * @return OK if the run was scheduled, in which case callback is always called.
+   */
+  [[nodiscard]] common::Status RunAsync(const RunOptions* run_options, gsl::span<const std::string> feed_names,
+                                        gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                                        std::vector<OrtValue> fetches, RunAsyncCallback callback);
+
   /**
    * Run a pre-loaded and pre-intialized model.
    * Multiple threads are allowed to run this function; hence its thread-safe.
@@ -482,6 +499,21 @@ class InferenceSession {
    */
   const logging::Logger* GetLogger() const { return session_logger_; };
 
+  /**
+   * Get the statistics of the dynamic batcher of the session, see kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize.
+   * @return the statistics, all zeros if dynamic batching is disabled.
+   */
+  DynamicBatchingStats GetDynamicBatchingStats() const;
+
+  /**
+   * Get the latency histograms of the nodes of the main graph that ran at least once,
+   * see kOrtSessionOptionsConfigNodeLatencyHistogramsEnable.
+   * @param histograms the nodes and their histograms, in topological order. Empty if the histograms are disabled.
+   * @return OK if the session is initialized.
+   */
+  common::Status GetNodeLatencyHistograms(
+      std::vector<std::pair<const Node*, NodeLatencyHistograms::Snapshot>>& histograms) const;
+
   const SessionState& GetSessionState() const {
     ORT_ENFORCE(session_state_ != nullptr, "Session must be initialized to create session state.");
     return *session_state_;
@@ -574,6 +606,12 @@ class InferenceSession {
 
   [[nodiscard]] common::Status SaveModelMetadata(const onnxruntime::Model& model);
 
+  // Runs the model for a single request. Run() dispatches to it directly or through the dynamic batcher.
+  [[nodiscard]] common::Status RunImpl(const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                                       gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                                       std::vector<OrtValue>* p_fetches,
+                                       const std::vector<OrtDevice>* p_fetches_device_info);
+
 #if !defined(ORT_MINIMAL_BUILD)
 
   [[nodiscard]] common::Status LoadOnnxModel(const PathString& model_uri);
@@ -704,9 +742,18 @@ class InferenceSession {
   // Spinning is restarted on the next Run()
   bool force_spinning_stop_between_runs_ = false;
 
+  // Priority class of the parallel loops of the runs of this session, see kOrtSessionOptionsConfigThreadPoolPriority.
+  concurrency::ThreadPool::LoopPriority thread_pool_priority_ = concurrency::ThreadPool::LoopPriority::kNormal;
+
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> thread_pool_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
 
+  // Coalesces concurrent Run() calls, see kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize. nullptr if disabled.
+  std::unique_ptr<DynamicBatcher> dynamic_batcher_;
+
+  // Captures and replays the runs, see kOrtSessionOptionsConfigCpuGraphCaptureEnable. nullptr if disabled.
+  std::unique_ptr<CpuGraphReplay> cpu_graph_replay_;
+
   // Global threadpools. These are intialized and used when use_per_session_threads is false *and*
   // the environment is created with create_global_thread_pools = true.
   onnxruntime::concurrency::ThreadPool* intra_op_thread_pool_from_env_{};
@@ -755,6 +802,11 @@ class InferenceSession {
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_ = 0;
 
+  // Number of the runs scheduled by RunAsync() that didn't complete yet. The destructor waits for them.
+  int num_pending_async_runs_ = 0;  // GUARDED_BY(async_runs_mutex_)
+  OrtMutex async_runs_mutex_;
+  OrtCondVar async_runs_cv_;
+
   mutable onnxruntime::OrtMutex session_mutex_;  // to ensure only one thread can invoke Load/Initialize
   bool is_model_loaded_ = false;                 // GUARDED_BY(session_mutex_)
   bool is_inited_ = false;                       // GUARDED_BY(session_mutex_)
@@ -904,6 +904,89 @@ struct OrtIoBinding {
   OrtIoBinding& operator=(const OrtIoBinding&) = delete;
 };
 
+ORT_API_STATUS_IMPL(OrtApis::RunAsync, _Inout_ OrtSession* sess, _In_opt_ const OrtRunOptions* run_options,
+                    _In_reads_(input_len) const char* const* input_names,
+                    _In_reads_(input_len) const OrtValue* const* input, size_t input_len,
+                    _In_reads_(output_names_len) const char* const* output_names1, size_t output_names_len,
+                    _Inout_updates_all_(output_names_len) OrtValue** output,
+                    _In_ RunAsyncCallbackFn run_async_callback, _In_opt_ void* user_data) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+
+  if (run_async_callback == nullptr) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "run_async_callback cannot be null");
+  }
+
+  InlinedVector<std::string> feed_names;
+  feed_names.reserve(input_len);
+  InlinedVector<OrtValue> feeds;
+  feeds.reserve(input_len);
+
+  for (size_t i = 0; i != input_len; ++i) {
+    if (input_names[i] == nullptr || input_names[i][0] == '\0') {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "input name cannot be empty");
+    }
+
+    if (!input[i]) {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT,
+                                   MakeString("NULL input supplied for input ", input_names[i]).c_str());
+    }
+
+    feed_names.emplace_back(input_names[i]);
+    feeds.emplace_back(*input[i]);
+  }
+
+  InlinedVector<std::string> output_names;
+  output_names.reserve(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names.emplace_back(output_names1[i]);
+  }
+
+  std::vector<OrtValue> fetches;
+  fetches.reserve(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output[i] != nullptr) {
+      fetches.emplace_back(*output[i]);
+    } else {
+      fetches.emplace_back();
+    }
+  }
+
+  auto callback = [output, output_names_len, run_async_callback, user_data](const Status& run_status,
+                                                                             std::vector<OrtValue>& run_fetches) {
+    Status status = run_status;
+    if (status.IsOK()) {
+      ORT_TRY {
+        // as in Run(), the outputs that were not provided are allocated, the others were written in place
+        InlinedVector<std::unique_ptr<OrtValue>> output_unique_ptrs(output_names_len);
+        for (size_t i = 0; i != output_names_len; ++i) {
+          if (output[i] == nullptr) {
+            output_unique_ptrs[i] = std::make_unique<OrtValue>(run_fetches[i]);
+          }
+        }
+        for (size_t i = 0; i != output_names_len; ++i) {
+          if (output[i] == nullptr) {
+            output[i] = output_unique_ptrs[i].release();
+          }
+        }
+      }
+      ORT_CATCH(const std::exception& ex) {
+        ORT_HANDLE_EXCEPTION([&]() {
+          status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+        });
+      }
+    }
+    run_async_callback(user_data, output, output_names_len, ToOrtStatus(status));
+  };
+
+  return ToOrtStatus(session->RunAsync(run_options, feed_names, feeds, output_names, std::move(fetches),
+                                       std::move(callback)));
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtApis::RunWithBinding, _Inout_ OrtSession* sess, _In_ const OrtRunOptions* run_options,
                     _In_ const OrtIoBinding* binding_ptr) {
   API_IMPL_BEGIN
@@ -2204,6 +2287,53 @@ ORT_API_STATUS_IMPL(OrtApis::SessionGetProfilingStartTimeNs, _In_ const OrtSessi
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::SessionGetDynamicBatchingStats, _In_ const OrtSession* sess,
+                    _Out_ OrtDynamicBatchingStats* out) {
+  API_IMPL_BEGIN
+  const auto* session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  const auto stats = session->GetDynamicBatchingStats();
+  out->num_requests = stats.num_requests;
+  out->num_batches = stats.num_batches;
+  out->queue_depth = stats.queue_depth;
+  out->max_queue_depth = stats.max_queue_depth;
+  out->total_queue_time_us = stats.total_queue_time_us;
+  out->max_queue_time_us = stats.max_queue_time_us;
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::SessionGetNodeLatencyStats, _In_ const OrtSession* sess, _Inout_ OrtAllocator* allocator,
+                    _Outptr_result_buffer_maybenull_(*num_nodes) OrtNodeLatencyStats** out,
+                    _Out_ size_t* num_nodes) {
+  API_IMPL_BEGIN
+  *out = nullptr;
+  *num_nodes = 0;
+  const auto* session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  std::vector<std::pair<const onnxruntime::Node*, onnxruntime::NodeLatencyHistograms::Snapshot>> histograms;
+  ORT_API_RETURN_IF_STATUS_NOT_OK(session->GetNodeLatencyHistograms(histograms));
+  if (histograms.empty()) {
+    return nullptr;
+  }
+
+  auto* stats = reinterpret_cast<OrtNodeLatencyStats*>(
+      allocator->Alloc(allocator, histograms.size() * sizeof(OrtNodeLatencyStats)));
+  for (size_t i = 0; i < histograms.size(); ++i) {
+    const auto& [node, histogram] = histograms[i];
+    stats[i].node_name = node->Name().c_str();
+    stats[i].op_type = node->OpType().c_str();
+    stats[i].count = histogram.count;
+    stats[i].total_ns = histogram.total_ns;
+    stats[i].p50_ns = histogram.Percentile(0.5);
+    stats[i].p90_ns = histogram.Percentile(0.9);
+    stats[i].p99_ns = histogram.Percentile(0.99);
+    stats[i].max_ns = histogram.max_ns;
+  }
+  *out = stats;
+  *num_nodes = histograms.size();
+  return nullptr;
+  API_IMPL_END
+}
+
 // End support for non-tensor types
 
 ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfg, _In_ size_t max_mem, int arena_extend_strategy, int initial_chunk_size_bytes,
@@ -2235,6 +2365,8 @@ ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfgV2, _In_reads_(num_keys) const char*
       cfg->max_dead_bytes_per_chunk = static_cast<int>(arena_config_values[i]);
     } else if (strcmp(arena_config_keys[i], "initial_growth_chunk_size_bytes") == 0) {
       cfg->initial_growth_chunk_size_bytes = static_cast<int>(arena_config_values[i]);
+    } else if (strcmp(arena_config_keys[i], "max_thread_cache_bytes") == 0) {
+      cfg->max_thread_cache_bytes = static_cast<int>(arena_config_values[i]);
     } else {
       std::ostringstream oss;
       oss << "Invalid key found: " << arena_config_keys[i];
@@ -2703,6 +2835,9 @@ static constexpr OrtApi ort_api_1_to_15 = {
     &OrtApis::Logger_LogMessage,
     &OrtApis::Logger_GetLoggingSeverityLevel,
     &OrtApis::KernelInfoGetConstantInput_tensor,
+    &OrtApis::SessionGetDynamicBatchingStats,
+    &OrtApis::RunAsync,
+    &OrtApis::SessionGetNodeLatencyStats,
 };
 
 // Asserts to do a some checks to ensure older Versions of the OrtApi never change (will detect an addition or deletion but not if they cancel out each other)
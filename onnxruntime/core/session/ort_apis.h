@@ -453,4 +453,17 @@ ORT_API_STATUS_IMPL(Logger_GetLoggingSeverityLevel, _In_ const OrtLogger* logger
 
 ORT_API_STATUS_IMPL(KernelInfoGetConstantInput_tensor, _In_ const OrtKernelInfo* info, _In_ size_t index,
                     _Out_ int* is_constant, _Outptr_ const OrtValue** out);
+
+ORT_API_STATUS_IMPL(SessionGetDynamicBatchingStats, _In_ const OrtSession* session,
+                    _Out_ OrtDynamicBatchingStats* out);
+
+ORT_API_STATUS_IMPL(RunAsync, _Inout_ OrtSession* sess, _In_opt_ const OrtRunOptions* run_options,
+                    _In_reads_(input_len) const char* const* input_names,
+                    _In_reads_(input_len) const OrtValue* const* input, size_t input_len,
+                    _In_reads_(output_names_len) const char* const* output_names, size_t output_names_len,
+                    _Inout_updates_all_(output_names_len) OrtValue** output,
+                    _In_ RunAsyncCallbackFn run_async_callback, _In_opt_ void* user_data);
+
+ORT_API_STATUS_IMPL(SessionGetNodeLatencyStats, _In_ const OrtSession* session, _Inout_ OrtAllocator* allocator,
+                    _Outptr_result_buffer_maybenull_(*num_nodes) OrtNodeLatencyStats** out, _Out_ size_t* num_nodes);
 }  // namespace OrtApis
@@ -109,6 +109,24 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
 #endif
   }
 
+  if (options.numa_aware && options.affinity_str.empty()) {
+    auto numa_nodes = Env::Default().GetNumaNodeAffinities();
+    if (numa_nodes.size() > 1) {
+      // The main thread counts as a thread of the first node. It is not bound to it though,
+      // the placeholder affinity is dropped during threadpool creation.
+      const size_t num_threads = static_cast<size_t>(options.thread_pool_size);
+      to.affinities.clear();
+      to.numa_nodes.clear();
+      for (size_t i = 0; i < num_threads; ++i) {
+        const size_t node = i * numa_nodes.size() / num_threads;
+        to.affinities.push_back(i == 0 ? LogicalProcessors{} : numa_nodes[node]);
+        to.numa_nodes.push_back(static_cast<int>(node));
+      }
+    } else {
+      LOGS_DEFAULT(INFO) << "NUMA aware thread pool requested, but the process runs on a single NUMA node.";
+    }
+  }
+
   to.set_denormal_as_zero = options.set_denormal_as_zero;
   // set custom thread management members
   to.custom_create_thread_fn = options.custom_create_thread_fn;
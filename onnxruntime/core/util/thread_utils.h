@@ -37,6 +37,11 @@ struct OrtThreadPoolParams {
   // meaning ith thread will be attached to first 8 logical processors
   std::string affinity_str;
 
+  // If it is true and affinity_str is empty, spread the threads evenly over the NUMA nodes of the system, bind each
+  // thread to the processors of its node, and partition parallel loops between the nodes.
+  // Has no effect on systems with a single NUMA node.
+  bool numa_aware = false;
+
   const ORTCHAR_T* name = nullptr;
 
   // Set or unset denormal as zero
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/flat_hash_map.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(FlatHashMapTest, InsertAndFind) {
+  FlatHashMap<std::string, int64_t> map;
+  EXPECT_TRUE(map.Empty());
+  EXPECT_EQ(map.Find(std::string_view("missing")), nullptr);
+
+  // grows several times
+  for (int64_t i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(map.Insert(std::to_string(i), i).second);
+  }
+  EXPECT_EQ(map.Size(), 10000u);
+
+  const auto existing = map.Insert("42", -1);
+  EXPECT_FALSE(existing.second);
+  EXPECT_EQ(*existing.first, 42);
+  map.InsertOrAssign("42", -1);
+  EXPECT_EQ(*map.Find(std::string("42")), -1);
+
+  for (int64_t i = 0; i < 10000; ++i) {
+    const std::string key = std::to_string(i);
+    // looked up as a view, e.g. of a string in a tensor
+    const int64_t* value = map.Find(std::string_view(key));
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, i == 42 ? -1 : i);
+  }
+  EXPECT_EQ(map.Find(std::string_view("10000")), nullptr);
+  EXPECT_EQ(map.Find(std::string_view("")), nullptr);
+}
+
+TEST(FlatHashMapTest, IntegerKeys) {
+  // keys which differ in their high bits only, std::hash of an integer may be the identity
+  FlatHashMap<int64_t, float> map;
+  map.Reserve(1000);
+  const size_t capacity = map.Capacity();
+  for (int64_t i = 0; i < 1000; ++i) {
+    map.Insert(i << 40, static_cast<float>(i));
+  }
+  EXPECT_EQ(map.Capacity(), capacity);
+  for (int64_t i = 0; i < 1000; ++i) {
+    ASSERT_NE(map.Find(i << 40), nullptr);
+    EXPECT_EQ(*map.Find(i << 40), static_cast<float>(i));
+    EXPECT_EQ(map.Find((i << 40) + 1), nullptr);
+  }
+}
+
+TEST(FlatHashMapTest, MoveOnlyValues) {
+  FlatHashMap<std::string_view, std::unique_ptr<int>> map;
+  const std::vector<std::string> keys{"a", "b", "c"};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    map.Insert(keys[i], std::make_unique<int>(static_cast<int>(i)));
+  }
+  const auto* value = map.Find(std::string("c"));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(**value, 2);
+}
+
+TEST(FlatHashMapTest, FindBatch) {
+  FlatHashMap<std::string, int64_t> map;
+  for (int64_t i = 0; i < 100; i += 2) {
+    map.Insert(std::to_string(i), i);
+  }
+
+  std::vector<std::string> keys;
+  for (int64_t i = 0; i < 100; ++i) {
+    keys.push_back(std::to_string(i));
+  }
+  std::vector<int64_t> values(keys.size(), 0);
+  map.FindBatch(gsl::span<const std::string>(keys), [&values](size_t i, const int64_t* value) {
+    values[i] = value != nullptr ? *value : -1;
+  });
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i], i % 2 == 0 ? static_cast<int64_t>(i) : -1);
+  }
+
+  // an empty map finds nothing
+  FlatHashMap<std::string, int64_t> empty_map;
+  size_t num_found = 0;
+  empty_map.FindBatch(gsl::span<const std::string>(keys), [&num_found](size_t, const int64_t* value) {
+    num_found += value != nullptr;
+  });
+  EXPECT_EQ(num_found, 0u);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -1341,6 +1341,138 @@ TEST(AttentionTest, AttentionPastStateBatch2WithPadding_SharedPastPresent) {
   RawAttentionPastStateBatch2WithPadding(true);
 }
 
+// Run the tests with past state through the tiled (flash) attention kernel on CPU.
+TEST(AttentionTest, AttentionPastState_CpuFlashAttention) {
+  ScopedEnvironmentVariables scoped_env_vars{
+      EnvVarMap{
+          {onnxruntime::contrib::attention::kDisableCpuFlashAttention, "0"},
+          {onnxruntime::contrib::attention::kMinSequenceLengthForCpuFlashAttention, "1"}}};
+  RawAttentionEmptyPastState(false);
+  RawAttentionPastStateBatch1(false);
+  RawAttentionPastStateBatch2(false);
+  RawAttentionPastStateBatch2WithPadding(false);
+}
+
+// Naive implementation of the Attention operator without past state, following the mask semantics of the CPU kernel.
+static std::vector<float> ComputeAttentionReference(const std::vector<float>& input_data,
+                                                    const std::vector<float>& weights_data,
+                                                    const std::vector<float>& bias_data,
+                                                    const std::vector<int32_t>& mask_index_data,
+                                                    AttentionMaskType mask_type,
+                                                    int batch_size,
+                                                    int sequence_length,
+                                                    int hidden_size,
+                                                    int number_of_heads,
+                                                    bool is_unidirectional) {
+  constexpr float mask_filter_value = -10000.0f;
+  const int head_size = hidden_size / number_of_heads;
+
+  // qkv: [batch_size, sequence_length, 3 * hidden_size]
+  std::vector<float> qkv(static_cast<size_t>(batch_size) * sequence_length * 3 * hidden_size);
+  for (int t = 0; t < batch_size * sequence_length; t++) {
+    for (int j = 0; j < 3 * hidden_size; j++) {
+      double sum = bias_data[j];
+      for (int k = 0; k < hidden_size; k++) {
+        sum += static_cast<double>(input_data[t * hidden_size + k]) * weights_data[k * 3 * hidden_size + j];
+      }
+      qkv[t * 3 * hidden_size + j] = static_cast<float>(sum);
+    }
+  }
+
+  std::vector<float> output(static_cast<size_t>(batch_size) * sequence_length * hidden_size);
+  std::vector<double> scores(sequence_length);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < number_of_heads; n++) {
+      for (int s = 0; s < sequence_length; s++) {
+        const float* q = qkv.data() + (b * sequence_length + s) * 3 * hidden_size + n * head_size;
+        for (int t = 0; t < sequence_length; t++) {
+          float mask = 0.0f;
+          if (mask_type == AttentionMaskType::MASK_1D_KEY_SEQ_LEN && !mask_index_data.empty()) {
+            mask = t >= mask_index_data[b] ? mask_filter_value : 0.0f;
+          } else if (mask_type == AttentionMaskType::MASK_2D_KEY_PADDING && !mask_index_data.empty()) {
+            mask = mask_index_data[b * sequence_length + t] > 0 ? 0.0f : mask_filter_value;
+          }
+
+          if (is_unidirectional && t > s) {
+            scores[t] = mask + mask_filter_value;
+            continue;
+          }
+
+          const float* k = qkv.data() + (b * sequence_length + t) * 3 * hidden_size + hidden_size + n * head_size;
+          double dot = 0.0;
+          for (int h = 0; h < head_size; h++) {
+            dot += static_cast<double>(q[h]) * k[h];
+          }
+          scores[t] = dot / std::sqrt(static_cast<double>(head_size)) + mask;
+        }
+
+        const double max_score = *std::max_element(scores.begin(), scores.end());
+        double sum = 0.0;
+        for (auto& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+
+        for (int h = 0; h < head_size; h++) {
+          double value = 0.0;
+          for (int t = 0; t < sequence_length; t++) {
+            value += scores[t] / sum * qkv[(b * sequence_length + t) * 3 * hidden_size + 2 * hidden_size + n * head_size + h];
+          }
+          output[(b * sequence_length + s) * hidden_size + n * head_size + h] = static_cast<float>(value);
+        }
+      }
+    }
+  }
+
+  return output;
+}
+
+// The sequence is longer than one tile of keys, so the online softmax of the tiled kernel spans several tiles.
+TEST(AttentionTest, AttentionLongSequence_CpuFlashAttention) {
+  constexpr int batch_size = 2;
+  constexpr int sequence_length = 300;
+  constexpr int hidden_size = 16;
+  constexpr int number_of_heads = 2;
+
+  RandomValueGenerator random{1234};
+  std::vector<float> input_data = random.Uniform<float>(std::vector<int64_t>{batch_size, sequence_length, hidden_size},
+                                                        -1.0f, 1.0f);
+  std::vector<float> weight_data = random.Uniform<float>(std::vector<int64_t>{hidden_size, 3 * hidden_size},
+                                                         -1.0f, 1.0f);
+  std::vector<float> bias_data = random.Uniform<float>(std::vector<int64_t>{3 * hidden_size}, -1.0f, 1.0f);
+
+  std::vector<int32_t> mask_1d = {sequence_length, sequence_length - 45};
+  std::vector<int32_t> mask_2d;
+  for (int b = 0; b < batch_size; b++) {
+    for (int t = 0; t < sequence_length; t++) {
+      mask_2d.push_back((b == 0 || t % 7 != 3) ? 1 : 0);
+    }
+  }
+
+  const std::vector<std::pair<AttentionMaskType, std::vector<int32_t>>> masks = {
+      {AttentionMaskType::MASK_1D_KEY_SEQ_LEN, {}},
+      {AttentionMaskType::MASK_1D_KEY_SEQ_LEN, mask_1d},
+      {AttentionMaskType::MASK_2D_KEY_PADDING, mask_2d}};
+
+  for (const auto& mask : masks) {
+    for (bool is_unidirectional : {false, true}) {
+      std::vector<float> output_data = ComputeAttentionReference(input_data, weight_data, bias_data,
+                                                                 mask.second, mask.first, batch_size, sequence_length,
+                                                                 hidden_size, number_of_heads, is_unidirectional);
+      for (const char* disable_flash_attention : {"1", "0"}) {
+        ScopedEnvironmentVariables scoped_env_vars{
+            EnvVarMap{
+                {onnxruntime::contrib::attention::kDisableCpuFlashAttention, disable_flash_attention},
+                {onnxruntime::contrib::attention::kMinSequenceLengthForCpuFlashAttention, "1"}}};
+        RunAttentionTest(input_data, weight_data, bias_data, mask.second, output_data,
+                         batch_size, sequence_length, hidden_size, number_of_heads,
+                         false, is_unidirectional, false, 0, nullptr, nullptr, mask.first,
+                         0, 0, false, true, true);
+      }
+    }
+  }
+}
+
 TEST(AttentionTest, AttentionBatch2MaskIndex2) {
   int batch_size = 2;
   int sequence_length = 2;
@@ -1,11 +1,13 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include "gtest/gtest.h"
 #include "core/common/gsl.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "contrib_ops/cpu/transformers/generation_device_helper.h"
 #include "test/common/cuda_op_test_utils.h"
 
 extern std::unique_ptr<Ort::Env> ort_env;
@@ -350,5 +352,35 @@ TEST(BeamSearchTest, GptBeamSearchFp16_VocabPadded) {
   }
 }
 
+TEST(BeamSearchTest, ReorderBeamStateInPlace) {
+  constexpr size_t block_size = 5;
+  const std::vector<std::vector<int32_t>> beam_indices_list{
+      {0, 1, 2, 3},     // unchanged
+      {0, 0, 1, 2},     // shift, each block is read by the next one
+      {3, 3, 3, 3},     // all beams continue from the last one
+      {1, 0, 3, 2},     // two swaps
+      {1, 2, 3, 0},     // one cycle over all beams
+      {2, 0, 1, 1, 4},  // cycle with a block read twice
+      {4, 3, 0, 0, 2},  // chain ending in a cycle
+  };
+
+  for (const auto& beam_indices : beam_indices_list) {
+    const size_t num_beams = beam_indices.size();
+    std::vector<float> state(num_beams * block_size);
+    for (size_t i = 0; i < state.size(); i++) {
+      state[i] = static_cast<float>(i);
+    }
+
+    std::vector<float> expected(state.size());
+    for (size_t j = 0; j < num_beams; j++) {
+      std::copy_n(state.begin() + beam_indices[j] * block_size, block_size, expected.begin() + j * block_size);
+    }
+
+    contrib::GenerationCpuDeviceHelper::ReorderBeamStateInPlace<float>(gsl::make_span(state), block_size,
+                                                                       gsl::make_span(beam_indices));
+    ASSERT_EQ(state, expected);
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -2,11 +2,15 @@
 // Licensed under the MIT License.
 
 #include <memory>
+#include <numeric>
 #include <vector>
 #include "gtest/gtest.h"
 #include "core/common/gsl.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "contrib_ops/cpu/transformers/generation_device_helper.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/framework/test_utils.h"
+#include "test/util/include/asserts.h"
 
 extern std::unique_ptr<Ort::Env> ort_env;
 
@@ -143,5 +147,47 @@ TEST(GreedySearchTest, GptGreedySearchFp32) {
   }
 }
 
+TEST(GreedySearchTest, KeepGptBatchRows) {
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault);
+
+  // batch_size = 3, past_seq_len = 2, num_heads = 1, head_size = 2
+  std::vector<float> present_data(2 * 3 * 2 * 2);
+  std::iota(present_data.begin(), present_data.end(), 0.0f);
+  std::vector<OrtValue> last_outputs(2);
+  CreateMLValue<float>(allocator, {3, 1, 4}, std::vector<float>(12, 0.0f), &last_outputs[0]);
+  CreateMLValue<float>(allocator, {2, 3, 1, 2, 2}, present_data, &last_outputs[1]);
+
+  std::vector<OrtValue> next_inputs(4);
+  CreateMLValue<int32_t>(allocator, {3, 2}, {1, 1, 0, 1, 1, 0}, &next_inputs[2]);
+
+  const std::vector<int32_t> kept_rows{0, 2};
+  ASSERT_STATUS_OK(contrib::GenerationCpuDeviceHelper::KeepGptBatchRows(allocator, kept_rows, last_outputs,
+                                                                        next_inputs, 1));
+
+  const Tensor& attention_mask = next_inputs[2].Get<Tensor>();
+  ASSERT_EQ(attention_mask.Shape(), TensorShape({2, 2}));
+  const std::vector<int32_t> expected_attention_mask{1, 1, 1, 0};
+  ASSERT_EQ(std::vector<int32_t>(attention_mask.DataAsSpan<int32_t>().begin(),
+                                 attention_mask.DataAsSpan<int32_t>().end()),
+            expected_attention_mask);
+
+  const Tensor& present = last_outputs[1].Get<Tensor>();
+  ASSERT_EQ(present.Shape(), TensorShape({2, 2, 1, 2, 2}));
+  const std::vector<float> expected_present{0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 20, 21, 22, 23};
+  ASSERT_EQ(std::vector<float>(present.DataAsSpan<float>().begin(), present.DataAsSpan<float>().end()),
+            expected_present);
+
+  // Logits of the kept rows are scattered back to the full batch.
+  OrtValue full_logits;
+  CreateMLValue<float>(allocator, {3, 1, 2}, std::vector<float>(6, 0.0f), &full_logits);
+  OrtValue logits;
+  CreateMLValue<float>(allocator, {2, 1, 2}, {1.0f, 2.0f, 3.0f, 4.0f}, &logits);
+  contrib::GenerationCpuDeviceHelper::ScatterBatchRows(logits.Get<Tensor>(), kept_rows,
+                                                       *full_logits.GetMutable<Tensor>());
+  const std::vector<float> expected_logits{1.0f, 2.0f, 0.0f, 0.0f, 3.0f, 4.0f};
+  auto full_logits_span = full_logits.Get<Tensor>().DataAsSpan<float>();
+  ASSERT_EQ(std::vector<float>(full_logits_span.begin(), full_logits_span.end()), expected_logits);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
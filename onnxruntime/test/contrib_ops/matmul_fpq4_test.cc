@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/mlas/inc/mlas_q4.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static void TestMatMulFpQ4(MLAS_BLK_QUANT_TYPE qtype, int64_t M, int64_t N, int64_t K,
+                           const std::vector<int64_t>& batch_dims = {}) {
+  RandomValueGenerator random{};
+
+  std::vector<int64_t> a_dims(batch_dims);
+  a_dims.push_back(M);
+  a_dims.push_back(K);
+  std::vector<float> a_data = random.Gaussian<float>(a_dims, 0.0f, 0.25f);
+  std::vector<float> b_data = random.Gaussian<float>(std::vector<int64_t>{K, N}, 0.0f, 0.25f);
+
+  const size_t packed_size = MlasQ4GemmPackBSize(qtype, static_cast<size_t>(N), static_cast<size_t>(K));
+  ASSERT_GT(packed_size, size_t(0));
+  std::vector<uint8_t> packed_b(packed_size);
+  MlasQ4GemmPackB(qtype, packed_b.data(), b_data.data(), static_cast<size_t>(N), static_cast<size_t>(K),
+                  static_cast<size_t>(N));
+
+  // the expected output is computed from the dequantized B, so only the
+  // arithmetic of the kernel is tested here, not the quantization error
+  std::vector<float> dequant_b(static_cast<size_t>(K * N));
+  MlasQ4GemmUnPackB(qtype, dequant_b.data(), packed_b.data(), static_cast<size_t>(N), static_cast<size_t>(K),
+                    static_cast<size_t>(N));
+
+  int64_t batch = 1;
+  for (auto d : batch_dims) {
+    batch *= d;
+  }
+
+  std::vector<int64_t> y_dims(batch_dims);
+  y_dims.push_back(M);
+  y_dims.push_back(N);
+  std::vector<float> expected_vals(static_cast<size_t>(batch * M * N));
+  for (int64_t b = 0; b < batch; b++) {
+    for (int64_t m = 0; m < M; m++) {
+      for (int64_t n = 0; n < N; n++) {
+        double sum = 0.0;
+        for (int64_t k = 0; k < K; k++) {
+          sum += double(a_data[(b * M + m) * K + k]) * double(dequant_b[k * N + n]);
+        }
+        expected_vals[(b * M + m) * N + n] = static_cast<float>(sum);
+      }
+    }
+  }
+
+  OpTester test("MatMulFpQ4", 1, kMSDomain);
+  test.AddAttribute<int64_t>("blk_quant_type", static_cast<int64_t>(qtype));
+  test.AddInput<float>("A", a_dims, a_data);
+  test.AddInput<uint8_t>("B", {static_cast<int64_t>(packed_size)}, packed_b, true);
+  test.AddInput<int64_t>("B_shape", {2}, {K, N}, true);
+  test.AddOutput<float>("Y", y_dims, expected_vals);
+  test.SetOutputAbsErr("Y", 0.001f);
+  test.SetOutputRelErr("Y", 0.001f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(MatMulFpQ4, MatMul2D) {
+  for (auto qtype : {BlkQ4Sym, BlkQ4Zp8, BlkQ4Sym64, BlkQ4Sym128}) {
+    TestMatMulFpQ4(qtype, 1, 1, 16);
+    TestMatMulFpQ4(qtype, 1, 288, 1024);
+    TestMatMulFpQ4(qtype, 2, 39, 95);
+    TestMatMulFpQ4(qtype, 100, 288, 1234);
+  }
+}
+
+TEST(MatMulFpQ4, MatMulBatched) {
+  TestMatMulFpQ4(BlkQ4Zp8, 1, 100, 257, {3});
+  TestMatMulFpQ4(BlkQ4Sym, 17, 64, 128, {2, 2});
+}
+
+TEST(MatMulFpQ4, InvalidPackedSize) {
+  OpTester test("MatMulFpQ4", 1, kMSDomain);
+  test.AddAttribute<int64_t>("blk_quant_type", static_cast<int64_t>(BlkQ4Zp8));
+  test.AddInput<float>("A", {1, 64}, std::vector<float>(64, 1.0f));
+  test.AddInput<uint8_t>("B", {10}, std::vector<uint8_t>(10, 0));
+  test.AddInput<int64_t>("B_shape", {2}, {64, 4});
+  test.AddOutput<float>("Y", {1, 4}, std::vector<float>(4, 0.0f));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectFailure, "does not match the expected packed size", {}, nullptr,
+           &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
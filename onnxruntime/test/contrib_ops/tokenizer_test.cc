@@ -864,5 +864,51 @@ TEST(ContribOpTest, Tokenizer_EmptyInput) {
     test.Run(OpTester::ExpectResult::kExpectSuccess);
   }
 }
+
+TEST(ContribOpTest, TokenizerWithSeparators_LiteralAndRegexManyRowsNC) {
+  // Enough rows to be tokenized in parallel. The plain separators are
+  // matched without the regex engine, the results must not change.
+  std::vector<std::string> separators = {u8" ", u8"[,;]+", u8"中"};
+
+  OpTester test("Tokenizer", opset_ver, domain);
+  InitTestAttr(test, true, separators, 2);
+
+  constexpr int64_t rows = 2000;
+  std::vector<int64_t> dims{rows, 2};
+  std::vector<std::string> input;
+  std::vector<std::string> output;
+  for (int64_t i = 0; i < rows; ++i) {
+    input.push_back(u8"ab cd,,ef;g h中ij");
+    input.push_back(i % 2 == 0 ? u8"k" : u8"Абв中де");
+    output.insert(output.end(), {start_mark, u8"ab", u8"cd", u8"ef", u8"ij", end_mark});
+    if (i % 2 == 0) {
+      output.insert(output.end(), {start_mark, end_mark, padval, padval, padval, padval});
+    } else {
+      output.insert(output.end(), {start_mark, u8"Абв", u8"де", end_mark, padval, padval});
+    }
+  }
+  test.AddInput<std::string>("T", dims, input);
+
+  std::vector<int64_t> output_dims(dims);
+  output_dims.push_back(int64_t(6));
+  test.AddOutput<std::string>("Y", output_dims, output);
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
+TEST(ContribOpTest, TokenizerWithSeparators_InvalidUtf8C) {
+  OpTester test("Tokenizer", opset_ver, domain);
+  InitTestAttr(test, false, {u8" "}, 1);
+
+  std::vector<int64_t> dims{3};
+  std::vector<std::string> input{u8"ab cd", "ef \xff", u8"gh"};
+  test.AddInput<std::string>("T", dims, input);
+
+  std::vector<int64_t> output_dims{3, 2};
+  std::vector<std::string> output(6);
+  test.AddOutput<std::string>("Y", output_dims, output);
+
+  test.Run(OpTester::ExpectResult::kExpectFailure, "Input string contains invalid utf8 chars");
+}
 }  // namespace test
 }  // namespace onnxruntime
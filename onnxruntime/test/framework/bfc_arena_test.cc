@@ -5,6 +5,8 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <cstdlib>
+#include <cstring>
+#include <thread>
 #include "core/framework/stream_handles.h"
 
 namespace onnxruntime {
@@ -316,6 +318,126 @@ TEST(BFCArenaTest, TestBackoffDoesntHang) {
   EXPECT_THROW(a.Alloc(1024), OnnxRuntimeException) << "Arena should be unable to allocate memory";
 }
 
+TEST(BFCArenaTest, ThreadCacheSizeClasses) {
+  for (size_t size = 1; size <= ArenaThreadCache::kMaxBlockSize; size += 97) {
+    size_t index = ArenaThreadCache::SizeClassIndex(size);
+    ASSERT_LT(index, ArenaThreadCache::kNumSizeClasses);
+    size_t class_size = ArenaThreadCache::SizeClassSize(index);
+    ASSERT_GE(class_size, size);
+    // the rounding overhead is at most 25%
+    ASSERT_LE(class_size, std::max<size_t>(256, size + size / 4));
+    if (index > 0) {
+      ASSERT_LT(ArenaThreadCache::SizeClassSize(index - 1), size);
+    }
+  }
+  EXPECT_EQ(ArenaThreadCache::SizeClassIndex(ArenaThreadCache::kMaxBlockSize), ArenaThreadCache::kNumSizeClasses - 1);
+}
+
+TEST(BFCArenaTest, ThreadCacheReusesBlocks) {
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, BFCArena::DEFAULT_ARENA_EXTEND_STRATEGY,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, 64 * 1024 * 1024);
+  void* p1 = a.Alloc(1000);
+  a.Free(p1);
+  // a size of the same class gets the cached block
+  void* p2 = a.Alloc(900);
+  EXPECT_EQ(p2, p1);
+  // large allocations bypass the cache
+  void* p3 = a.Alloc(2 * ArenaThreadCache::kMaxBlockSize);
+  a.Free(p3);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, 3);
+  EXPECT_EQ(stats.num_thread_cache_hits, 1);
+  EXPECT_EQ(stats.num_thread_cache_misses, 1);
+  EXPECT_EQ(stats.bytes_in_thread_caches, 0);
+
+  a.Free(p2);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_thread_caches, 1024);
+  EXPECT_EQ(stats.bytes_in_use, 1024) << "the cached block is in use for the arena";
+
+  // shrinking returns the cached blocks to the arena first
+  EXPECT_EQ(a.Shrink(), Status::OK());
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_thread_caches, 0);
+  EXPECT_EQ(stats.num_thread_cache_releases, 1);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(BFCArenaTest, ThreadCacheBoundsCachedBytes) {
+  // a budget of 4K bytes per thread cache
+  const size_t max_thread_cache_bytes = ArenaThreadCache::kNumCaches * 4096;
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, BFCArena::DEFAULT_ARENA_EXTEND_STRATEGY,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, max_thread_cache_bytes);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.Alloc(1024));
+  }
+  for (void* p : ptrs) {
+    a.Free(p);
+  }
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_LE(stats.bytes_in_thread_caches, 4096);
+  EXPECT_GT(stats.num_thread_cache_releases, 0);
+  EXPECT_EQ(stats.bytes_in_use, stats.bytes_in_thread_caches);
+}
+
+TEST(BFCArenaTest, ThreadCacheConcurrentAllocations) {
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, BFCArena::DEFAULT_ARENA_EXTEND_STRATEGY,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, 16 * 1024 * 1024);
+  std::vector<std::thread> threads;
+  std::vector<void*> shared_ptrs(8, nullptr);
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&a, t]() {
+      std::vector<std::pair<char*, size_t>> live;
+      for (int i = 0; i < 5000; ++i) {
+        size_t size = 16 + static_cast<size_t>((i * 7919 + t * 104729) % 20000);
+        char* p = static_cast<char*>(a.Alloc(size));
+        memset(p, t, size);
+        live.emplace_back(p, size);
+        if (live.size() > 16) {
+          // the blocks must not be handed out to another thread while in use
+          auto [q, q_size] = live.front();
+          for (size_t j = 0; j < q_size; j += 512) {
+            ASSERT_EQ(q[j], static_cast<char>(t));
+          }
+          a.Free(q);
+          live.erase(live.begin());
+        }
+      }
+      for (auto [p, size] : live) {
+        a.Free(p);
+      }
+    });
+  }
+  // blocks allocated by one thread can be freed by another one
+  for (auto& p : shared_ptrs) {
+    p = a.Alloc(4096);
+  }
+  std::thread other([&a, &shared_ptrs]() {
+    for (void* p : shared_ptrs) {
+      a.Free(p);
+    }
+  });
+  other.join();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(a.Shrink(), Status::OK());
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.bytes_in_thread_caches, 0);
+  EXPECT_GT(stats.num_thread_cache_hits, 0);
+}
+
 struct NotificationMock : public synchronize::Notification {
  public:
   NotificationMock(Stream& s) : Notification(s) {}
@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/bump_arena.h"
+#include "core/framework/tensor.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+// A CPU allocator counting the chunks held by the arena.
+class CountingAllocator : public CPUAllocator {
+ public:
+  void* Alloc(size_t size) override {
+    ++num_live_allocs;
+    return CPUAllocator::Alloc(size);
+  }
+
+  void Free(void* p) override {
+    --num_live_allocs;
+    CPUAllocator::Free(p);
+  }
+
+  int num_live_allocs{0};
+};
+
+TEST(BumpArenaTest, AlignedAndContiguous) {
+  auto device_allocator = std::make_shared<CountingAllocator>();
+  {
+    BumpArena arena(device_allocator, 4096);
+    char* p1 = static_cast<char*>(arena.Alloc(1));
+    char* p2 = static_cast<char*>(arena.Alloc(100));
+    char* p3 = static_cast<char*>(arena.Alloc(kAllocAlignment));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p1) % kAllocAlignment, 0u);
+    EXPECT_EQ(p2, p1 + kAllocAlignment);
+    EXPECT_EQ(p3, p2 + 2 * kAllocAlignment);
+    EXPECT_EQ(device_allocator->num_live_allocs, 1);
+
+    AllocatorStats stats;
+    arena.GetStats(&stats);
+    EXPECT_EQ(stats.num_allocs, 3);
+    EXPECT_EQ(stats.num_arena_extensions, 1);
+    EXPECT_EQ(stats.bytes_in_use, static_cast<int64_t>(4 * kAllocAlignment));
+    EXPECT_EQ(stats.max_alloc_size, 100);
+
+    // nothing is released before the arena is destroyed
+    arena.Free(p2);
+    EXPECT_EQ(device_allocator->num_live_allocs, 1);
+  }
+  EXPECT_EQ(device_allocator->num_live_allocs, 0);
+}
+
+TEST(BumpArenaTest, FreeLatestAllocation) {
+  auto device_allocator = std::make_shared<CountingAllocator>();
+  BumpArena arena(device_allocator, 4096);
+  char* p1 = static_cast<char*>(arena.Alloc(10));
+  char* p2 = static_cast<char*>(arena.Alloc(10));
+  arena.Free(p2);
+  // the memory of the latest allocation is reused
+  char* p3 = static_cast<char*>(arena.Alloc(10));
+  EXPECT_EQ(p3, p2);
+  arena.Free(p1);
+  char* p4 = static_cast<char*>(arena.Alloc(10));
+  EXPECT_EQ(p4, p3 + kAllocAlignment);
+  arena.Free(p3);
+  arena.Free(p4);
+}
+
+TEST(BumpArenaTest, GrowAndReset) {
+  auto device_allocator = std::make_shared<CountingAllocator>();
+  BumpArena arena(device_allocator, 1024);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(arena.Alloc(100));
+  }
+  // the chunks double in size: 1024 + 2048 + 4096 + 8192 bytes hold the 64 allocations of 128 bytes
+  EXPECT_EQ(device_allocator->num_live_allocs, 4);
+  EXPECT_EQ(arena.PeakTotalChunkSize(), 1024u + 2048u + 4096u + 8192u);
+  AllocatorStats stats;
+  arena.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 64 * 128);
+
+  // an allocation larger than the next chunk gets a chunk of its own size
+  void* large = arena.Alloc(1024 * 1024);
+  EXPECT_EQ(device_allocator->num_live_allocs, 5);
+  ptrs.push_back(large);
+
+  // once everything is released, only the last chunk is kept and reused from its start
+  for (void* p : ptrs) {
+    arena.Free(p);
+  }
+  EXPECT_EQ(device_allocator->num_live_allocs, 1);
+  arena.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(arena.Alloc(100), large);
+}
+
+TEST(BumpArenaTest, NotReportedAsArena) {
+  // the arena may wrap a BFCArena, but must not be taken for one
+  auto device_allocator = std::make_shared<CPUAllocator>(OrtMemoryInfo(CPU, OrtAllocatorType::OrtArenaAllocator));
+  BumpArena arena(device_allocator, 4096);
+  EXPECT_EQ(arena.Info().alloc_type, OrtAllocatorType::OrtDeviceAllocator);
+  EXPECT_STREQ(arena.Info().name, CPU);
+  EXPECT_EQ(arena.Info().device, device_allocator->Info().device);
+  EXPECT_EQ(arena.Info().mem_type, device_allocator->Info().mem_type);
+}
+
+TEST(BumpArenaTest, TensorKeepsArenaAlive) {
+  auto device_allocator = std::make_shared<CountingAllocator>();
+  std::unique_ptr<Tensor> tensor;
+  {
+    auto arena = std::make_shared<BumpArena>(device_allocator, 4096);
+    tensor = std::make_unique<Tensor>(DataTypeImpl::GetType<float>(), TensorShape({2, 3}), arena);
+  }
+  // the arena was released by its owner but is still referenced by the tensor
+  EXPECT_EQ(device_allocator->num_live_allocs, 1);
+  tensor->MutableData<float>()[5] = 1.0f;
+  tensor.reset();
+  EXPECT_EQ(device_allocator->num_live_allocs, 0);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -8,6 +8,7 @@
 #include "core/graph/model.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test_utils.h"
 #include "test/test_environment.h"
 #include "test/framework/TestAllocatorManager.h"
@@ -330,6 +331,198 @@ TEST_F(ExecutionFrameTest, MemPatternTest) {
   ASSERT_EQ(p->GetBlock(4)->offset_, kAllocAlignment);
 }
 
+TEST_F(ExecutionFrameTest, MemPatternShapeBucketsTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           domain_to_version, {}, DefaultLoggingManager().DefaultLogger());
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  onnxruntime::NodeArg input_def1("X1", &tensor_float),
+      input_def2("X2", &tensor_float),
+      input_def3("X3", &tensor_float),
+      gemm1_out_def("T1", &tensor_float),
+      gemm2_out_def("T2", &tensor_float),
+      clip_out_def("T3", &tensor_float);
+
+  graph.AddNode("node1", "MatMul", "gemm1", ArgMap{&input_def1, &input_def2}, ArgMap{&gemm1_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "MatMul", "gemm2", ArgMap{&gemm1_out_def, &input_def3}, ArgMap{&gemm2_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node3", "Clip", "clip1", ArgMap{&gemm2_out_def}, ArgMap{&clip_out_def})
+      .SetExecutionProviderType(xp_type);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  KernelRegistryManager kernel_registry_manager;
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(xp_type, std::move(cpu_xp)));
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  DataTransferManager dtm;
+  profiling::Profiler profiler;
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  ASSERT_STATUS_OK(sess_options.config_options.AddConfigEntry(kOrtSessionOptionsConfigMemoryPatternShapeBuckets, "1"));
+
+  SessionState state(graph, execution_providers, &tp_, nullptr, dtm,
+                     DefaultLoggingManager().DefaultLogger(), profiler, sess_options);
+
+  ASSERT_STATUS_OK(state.FinalizeSessionState(ORT_TSTR(""), kernel_registry_manager));
+
+  const OrtValueNameIdxMap& mlvalue_name_idx_map(state.GetOrtValueNameIdxMap());
+
+  int x1_idx = -1, x2_idx = -1, x3_idx = -1, t3_idx = -1;
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X1", x1_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X2", x2_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X3", x3_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("T3", t3_idx));
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->GetAllocator(OrtMemTypeDefault);
+
+  OrtValue v2, v3;
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{16, 16}, std::vector<float>(256, 1.0f), &v2);
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{16, 16}, std::vector<float>(256, 1.0f), &v3);
+
+  // runs a frame with X1 of shape {rows, 16}, all the rows from 5 to 8 share a bucket
+  auto run_frame = [&](int64_t rows, bool expect_planner, size_t expected_misses) {
+    OrtValue v1;
+    CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{rows, 16},
+                         std::vector<float>(static_cast<size_t>(rows * 16), 1.0f), &v1);
+    std::vector<OrtValue> feeds{v1, v2, v3};
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(AsSpan({x1_idx, x2_idx, x3_idx}), feeds, AsSpan({t3_idx}), outputs, {}, state, {});
+    ASSERT_EQ(frame.HasMemoryPatternPlanner(), expect_planner);
+
+    for (int idx : {3, 4}) {
+      OrtValue& mlvalue = *frame.GetMutableNodeInputOrOutputMLValue(idx);
+      ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(mlvalue, idx,
+                                                                DataTypeImpl::GetType<float>(),
+                                                                cpu_allocator->Info(),
+                                                                TensorShape(std::vector<int64_t>{rows, 16})));
+    }
+    ASSERT_EQ(frame.GetMemoryPatternMisses().size(), expected_misses);
+
+    if (expect_planner) {
+      MemoryPatternGroup pattern;
+      ASSERT_STATUS_OK(frame.GeneratePatterns(pattern));
+      ASSERT_STATUS_OK(state.UpdateMemoryPatternGroupCache(feeds, std::move(pattern)));
+    } else if (expected_misses != 0) {
+      state.MarkMemoryPatternGroupOutdated(feeds, frame.GetMemoryPatternMisses());
+    }
+  };
+
+  // the first run of the bucket traces its pattern
+  run_frame(7, true, 0);
+  // smaller tensors of the bucket fit in the pattern
+  run_frame(5, false, 0);
+  // larger ones don't and outdate it
+  run_frame(8, false, 2);
+  // the next run of the bucket traces a pattern that fits the larger tensors too
+  run_frame(6, true, 0);
+  run_frame(8, false, 0);
+  run_frame(7, false, 0);
+}
+
+TEST_F(ExecutionFrameTest, PerRunArenaTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           domain_to_version, {}, DefaultLoggingManager().DefaultLogger());
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  onnxruntime::NodeArg input_def1("X1", &tensor_float),
+      input_def2("X2", &tensor_float),
+      input_def3("X3", &tensor_float),
+      gemm1_out_def("T1", &tensor_float),
+      gemm2_out_def("T2", &tensor_float),
+      clip_out_def("T3", &tensor_float);
+
+  graph.AddNode("node1", "MatMul", "gemm1", ArgMap{&input_def1, &input_def2}, ArgMap{&gemm1_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "MatMul", "gemm2", ArgMap{&gemm1_out_def, &input_def3}, ArgMap{&gemm2_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node3", "Clip", "clip1", ArgMap{&gemm2_out_def}, ArgMap{&clip_out_def})
+      .SetExecutionProviderType(xp_type);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  KernelRegistryManager kernel_registry_manager;
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(xp_type, std::move(cpu_xp)));
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  DataTransferManager dtm;
+  profiling::Profiler profiler;
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = false;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  ASSERT_STATUS_OK(sess_options.config_options.AddConfigEntry(kOrtSessionOptionsConfigUsePerRunArena, "1"));
+
+  SessionState state(graph, execution_providers, &tp_, nullptr, dtm,
+                     DefaultLoggingManager().DefaultLogger(), profiler, sess_options);
+
+  ASSERT_STATUS_OK(state.FinalizeSessionState(ORT_TSTR(""), kernel_registry_manager));
+
+  const OrtValueNameIdxMap& mlvalue_name_idx_map(state.GetOrtValueNameIdxMap());
+
+  int x1_idx = -1, x2_idx = -1, x3_idx = -1, t3_idx = -1;
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X1", x1_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X2", x2_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X3", x3_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("T3", t3_idx));
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->GetAllocator(OrtMemTypeDefault);
+
+  OrtValue v1, v2, v3;
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{1, 2}, std::vector<float>{1.0f, 1.0f}, &v1);
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{2, 2}, std::vector<float>(4, 1.0f), &v2);
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{2, 3}, std::vector<float>(6, 1.0f), &v3);
+
+  OrtValue t1;
+  {
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(AsSpan({x1_idx, x2_idx, x3_idx}), AsSpan({v1, v2, v3}), AsSpan({t3_idx}), outputs, {},
+                         state, {});
+
+    OrtValue& mlvalue3 = *frame.GetMutableNodeInputOrOutputMLValue(3);
+    OrtValue& mlvalue4 = *frame.GetMutableNodeInputOrOutputMLValue(4);
+    ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(mlvalue3, 3,
+                                                              DataTypeImpl::GetType<float>(),
+                                                              cpu_allocator->Info(),
+                                                              TensorShape(std::vector<int64_t>{1, 2})));
+    ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(mlvalue4, 4,
+                                                              DataTypeImpl::GetType<float>(),
+                                                              cpu_allocator->Info(),
+                                                              TensorShape(std::vector<int64_t>{1, 3})));
+
+    // the intermediate tensors are bump allocated from the arena of the run
+    const auto* t1_data = static_cast<const char*>(mlvalue3.Get<Tensor>().DataRaw());
+    const auto* t2_data = static_cast<const char*>(mlvalue4.Get<Tensor>().DataRaw());
+    ASSERT_EQ(t2_data, t1_data + kAllocAlignment);
+    t1 = mlvalue3;
+  }
+
+  // a tensor still referenced after the run keeps the arena alive
+  ASSERT_EQ(t1.Get<Tensor>().Shape(), TensorShape({1, 2}));
+  ASSERT_EQ(state.GetPerRunArenaSizeHint(), BumpArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES);
+}
+
 #ifdef ENABLE_TRAINING
 TEST_F(ExecutionFrameTest, MemPatternWithExternalOutputsTest) {
   auto cpu_xp = CreateCPUExecutionProvider();
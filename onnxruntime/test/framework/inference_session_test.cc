@@ -517,6 +517,92 @@ static bool Compare(const InputDefList& f_arg, const InputDefList& s_arg) {
   return true;
 }
 
+// Y = X + W, where W is read from external data at the given offset of its file.
+static void RunWithExternalInitializer(const PathString& name, int64_t offset, bool expect_mapped) {
+  const std::vector<float> w_values = {1.0f, 2.0f, 3.0f, 4.0f};
+  const PathString data_file_name = name + ORT_TSTR(".bin");
+  const PathString model_file_name = name + ORT_TSTR(".onnx");
+  {
+    std::ofstream data_file(data_file_name, std::ios::binary);
+    const std::vector<char> padding(static_cast<size_t>(offset), 0);
+    data_file.write(padding.data(), offset);
+    data_file.write(reinterpret_cast<const char*>(w_values.data()), w_values.size() * sizeof(float));
+    ASSERT_TRUE(data_file.good());
+  }
+
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 13;
+  Model model("test", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version, {},
+              DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(4);
+
+  ONNX_NAMESPACE::TensorProto w;
+  w.set_name("W");
+  w.set_data_type(TensorProto_DataType_FLOAT);
+  w.add_dims(4);
+  w.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  auto* location = w.add_external_data();
+  location->set_key("location");
+  location->set_value(ToUTF8String(data_file_name));
+  auto* data_offset = w.add_external_data();
+  data_offset->set_key("offset");
+  data_offset->set_value(std::to_string(offset));
+  auto* length = w.add_external_data();
+  length->set_key("length");
+  length->set_value(std::to_string(w_values.size() * sizeof(float)));
+  graph.AddInitializedTensor(w);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& w_arg = graph.GetOrCreateNodeArg("W", &tensor_float);
+  auto& y = graph.GetOrCreateNodeArg("Y", &tensor_float);
+  graph.AddNode("add", "Add", "Add", {&x, &w_arg}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+  ASSERT_STATUS_OK(Model::Save(model, model_file_name));
+
+  {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigMapExternalInitializersReadOnly, "1"));
+    InferenceSessionWrapper session{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session.Load(model_file_name));
+    ASSERT_STATUS_OK(session.Initialize());
+
+    // The mapped data is at the offset of the data in its page. Data that is not aligned for float is copied into
+    // an allocated buffer instead.
+    const auto& session_state = session.GetSessionState();
+    int w_idx = -1;
+    ASSERT_STATUS_OK(session_state.GetOrtValueNameIdxMap().GetIdx("W", w_idx));
+    const auto& initializers = session_state.GetInitializedTensors();
+    ASSERT_NE(initializers.find(w_idx), initializers.end());
+    const auto w_address = reinterpret_cast<uintptr_t>(initializers.at(w_idx).Get<Tensor>().DataRaw());
+    EXPECT_EQ(w_address % alignof(float), 0u);
+    if (expect_mapped) {
+      EXPECT_EQ(w_address % 4096, static_cast<uintptr_t>(offset));
+    }
+
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {4}, {10.0f, 20.0f, 30.0f, 40.0f},
+                         &feeds[0]);
+    std::vector<std::string> feed_names{"X"};
+    std::vector<std::string> output_names{"Y"};
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    VerifyOutputs<float>(fetches[0].Get<Tensor>(), {4}, {11.0f, 22.0f, 33.0f, 44.0f});
+  }
+
+  ASSERT_STATUS_OK(Env::Default().RemoveFile(model_file_name));
+  ASSERT_STATUS_OK(Env::Default().RemoveFile(data_file_name));
+}
+
+TEST(InferenceSessionTests, MapExternalInitializersReadOnly) {
+  // the initializer is used in place from the read-only mapping
+  RunWithExternalInitializer(ORT_TSTR("external_initializer_aligned"), 16, true);
+  // the data isn't aligned for float, so it's copied
+  RunWithExternalInitializer(ORT_TSTR("external_initializer_misaligned"), 18, false);
+}
+
 TEST(InferenceSessionTests, ModelMetadata) {
   SessionOptions so;
 
@@ -822,6 +908,280 @@ TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   thread2.join();
 }
 
+TEST(InferenceSessionTests, CpuGraphCaptureAndReplay) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.CpuGraphCaptureAndReplay";
+  so.session_log_severity_level = static_cast<int>(logging::Severity::kINFO);
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigCpuGraphCaptureEnable, "1"));
+
+  auto capturing_sink = new CapturingSink();
+  auto logging_manager = std::make_unique<logging::LoggingManager>(
+      std::unique_ptr<ISink>(capturing_sink), logging::Severity::kVERBOSE, false,
+      LoggingManager::InstanceType::Temporal);
+  std::unique_ptr<Environment> env;
+  ASSERT_STATUS_OK(Environment::Create(std::move(logging_manager), env));
+
+  InferenceSession session_object{so, *env};
+  ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  // Y = X * W with W = {1, 2, 3, 4, 5, 6}
+  std::vector<std::string> feed_names{"X"};
+  std::vector<std::string> output_names{"Y"};
+  std::vector<std::vector<OrtValue>> all_fetches;
+  for (int run = 1; run <= 4; ++run) {
+    const float scale = static_cast<float>(run);
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {3, 2},
+                         {scale, 2 * scale, 3 * scale, 4 * scale, 5 * scale, 6 * scale}, &feeds[0]);
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    all_fetches.push_back(std::move(fetches));
+  }
+
+  // the outputs of a replay are not overwritten by the next one
+  for (int run = 1; run <= 4; ++run) {
+    const float scale = static_cast<float>(run);
+    VerifyOutputs(all_fetches[run - 1], {3, 2},
+                  {scale, 4 * scale, 9 * scale, 16 * scale, 25 * scale, 36 * scale});
+  }
+
+  const auto& msgs = capturing_sink->Messages();
+  EXPECT_EQ(std::count_if(msgs.begin(), msgs.end(),
+                          [](const std::string& msg) { return msg.find("Captured the CPU graph") != string::npos; }),
+            1);
+
+  // other input shapes run as usual, this one fails to broadcast with W
+  std::vector<OrtValue> feeds(1);
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {2, 3},
+                       {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f}, &feeds[0]);
+  std::vector<OrtValue> fetches;
+  EXPECT_FALSE(session_object.Run(RunOptions(), feed_names, feeds, output_names, &fetches).IsOK());
+}
+
+// Runs a model whose values change shape or content from run to run with the CPU graph capture enabled. The graph
+// must not be captured, and every run must compute its own outputs. run(session, i) runs the model with the i-th
+// inputs and checks the outputs.
+static void RunWithoutCpuGraphCapture(const Model& model,
+                                      const std::function<void(InferenceSession&, int)>& run) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunWithoutCpuGraphCapture";
+  so.session_log_severity_level = static_cast<int>(logging::Severity::kINFO);
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigCpuGraphCaptureEnable, "1"));
+
+  auto capturing_sink = new CapturingSink();
+  auto logging_manager = std::make_unique<logging::LoggingManager>(
+      std::unique_ptr<ISink>(capturing_sink), logging::Severity::kVERBOSE, false,
+      LoggingManager::InstanceType::Temporal);
+  std::unique_ptr<Environment> env;
+  ASSERT_STATUS_OK(Environment::Create(std::move(logging_manager), env));
+
+  std::string serialized_model;
+  model.ToProto().SerializeToString(&serialized_model);
+  std::stringstream model_stream(serialized_model);
+  InferenceSession session_object{so, *env};
+  ASSERT_STATUS_OK(session_object.Load(model_stream));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  for (int i = 0; i < 4; ++i) {
+    run(session_object, i);
+  }
+
+  const auto& msgs = capturing_sink->Messages();
+  EXPECT_TRUE(std::none_of(msgs.begin(), msgs.end(), [](const std::string& msg) {
+    return msg.find("Captured the CPU graph") != string::npos;
+  }));
+  EXPECT_TRUE(std::any_of(msgs.begin(), msgs.end(), [](const std::string& msg) {
+    return msg.find("The CPU graph can't be captured") != string::npos;
+  }));
+}
+
+TEST(InferenceSessionTests, CpuGraphCaptureDataDependentShape) {
+  // Y = NonZero(X), whose shape depends on the values of X
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 13;
+  Model model("test", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version, {},
+              DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(4);
+  TypeProto tensor_int64;
+  tensor_int64.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& y = graph.GetOrCreateNodeArg("Y", &tensor_int64);
+  graph.AddNode("nonzero", "NonZero", "NonZero", {&x}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  RunWithoutCpuGraphCapture(model, [](InferenceSession& session, int i) {
+    // the first i + 1 elements are non-zero
+    std::vector<float> x_values(4, 0.0f);
+    std::vector<int64_t> expected;
+    for (int j = 0; j <= i; ++j) {
+      x_values[j] = 1.0f;
+      expected.push_back(j);
+    }
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {4}, x_values, &feeds[0]);
+    std::vector<std::string> feed_names{"X"};
+    std::vector<std::string> output_names{"Y"};
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    VerifyOutputs<int64_t>(fetches[0].Get<Tensor>(), {1, static_cast<int64_t>(expected.size())}, expected);
+  });
+}
+
+TEST(InferenceSessionTests, CpuGraphCaptureSequence) {
+  // Y = ConcatFromSequence(SequenceConstruct(X, X)), through a sequence whose content changes from run to run
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 13;
+  Model model("test", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version, {},
+              DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+  TypeProto sequence_float;
+  sequence_float.mutable_sequence_type()->mutable_elem_type()->mutable_tensor_type()->set_elem_type(
+      TensorProto_DataType_FLOAT);
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& sequence = graph.GetOrCreateNodeArg("S", &sequence_float);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+  graph.AddNode("construct", "SequenceConstruct", "SequenceConstruct", {&x, &x}, {&sequence});
+  auto& concat = graph.AddNode("concat", "ConcatFromSequence", "ConcatFromSequence", {&sequence}, {&y});
+  concat.AddAttribute("axis", int64_t{0});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  RunWithoutCpuGraphCapture(model, [](InferenceSession& session, int i) {
+    const float value = static_cast<float>(i);
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {2}, {value, value + 1},
+                         &feeds[0]);
+    std::vector<std::string> feed_names{"X"};
+    std::vector<std::string> output_names{"Y"};
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    VerifyOutputs<float>(fetches[0].Get<Tensor>(), {4}, {value, value + 1, value, value + 1});
+  });
+}
+
+TEST(InferenceSessionTests, NodeLatencyHistograms) {
+  for (const bool enabled : {true, false}) {
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.NodeLatencyHistograms";
+    if (!enabled) {
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigNodeLatencyHistogramsEnable, "0"));
+    }
+
+    InferenceSession session_object{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+    ASSERT_STATUS_OK(session_object.Initialize());
+
+    std::vector<std::string> feed_names{"X"};
+    std::vector<std::string> output_names{"Y"};
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {3, 2},
+                         {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, &feeds[0]);
+    for (int run = 0; run < 5; ++run) {
+      std::vector<OrtValue> fetches;
+      ASSERT_STATUS_OK(session_object.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    }
+
+    std::vector<std::pair<const Node*, NodeLatencyHistograms::Snapshot>> histograms;
+    ASSERT_STATUS_OK(session_object.GetNodeLatencyHistograms(histograms));
+    if (!enabled) {
+      EXPECT_TRUE(histograms.empty());
+      continue;
+    }
+
+    ASSERT_EQ(histograms.size(), 1u);
+    EXPECT_EQ(histograms[0].first->OpType(), "Mul");
+    const auto& histogram = histograms[0].second;
+    EXPECT_EQ(histogram.count, 5u);
+    EXPECT_GE(histogram.total_ns, histogram.max_ns);
+    EXPECT_LE(histogram.Percentile(0.5), histogram.max_ns);
+  }
+}
+
+TEST(InferenceSessionTests, DynamicBatching) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.DynamicBatching";
+  constexpr int64_t max_batch_size = 4;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize,
+                                                    std::to_string(max_batch_size).c_str()));
+  // long enough for the batches to only close when they are full, which makes the number of batches deterministic
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingMaxDelayUs, "10000000"));
+
+  // Z = X + Y, which computes every output row from the same input rows
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 12;
+  Model model("test", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version, {},
+              DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& y = graph.GetOrCreateNodeArg("Y", &tensor_float);
+  auto& z = graph.GetOrCreateNodeArg("Z", &tensor_float);
+  graph.AddNode("add", "Add", "Add", {&x, &y}, {&z});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string serialized_model;
+  model.ToProto().SerializeToString(&serialized_model);
+  std::stringstream model_stream(serialized_model);
+
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_stream));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  constexpr int num_requests = 2 * max_batch_size;
+  std::vector<std::string> feed_names{"X", "Y"};
+  std::vector<std::string> output_names{"Z"};
+  std::vector<std::vector<OrtValue>> fetches(num_requests);
+  std::vector<Status> statuses(num_requests);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_requests; ++i) {
+    threads.emplace_back([&, i]() {
+      std::vector<OrtValue> feeds(2);
+      auto allocator = TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault);
+      CreateMLValue<float>(allocator, {1, 3}, {float(i), float(i), float(i)}, &feeds[0]);
+      CreateMLValue<float>(allocator, {1, 3}, {1.0f, 2.0f, 3.0f}, &feeds[1]);
+      RunOptions run_options;
+      statuses[i] = session_object.Run(run_options, feed_names, feeds, output_names, &fetches[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    ASSERT_STATUS_OK(statuses[i]);
+    ASSERT_EQ(fetches[i].size(), 1u);
+    const auto& output = fetches[i][0].Get<Tensor>();
+    ASSERT_EQ(output.Shape(), TensorShape({1, 3}));
+    const float* data = output.Data<float>();
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_EQ(data[j], float(i + j + 1));
+    }
+  }
+
+  const auto stats = session_object.GetDynamicBatchingStats();
+  EXPECT_EQ(stats.num_requests, num_requests);
+  EXPECT_EQ(stats.num_batches, num_requests / max_batch_size);
+  EXPECT_EQ(stats.queue_depth, 0);
+  EXPECT_LE(stats.max_queue_depth, num_requests);
+
+  // requests that can't be batched run directly
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), {max_batch_size + 1, 1},
+                       std::vector<float>(max_batch_size + 1, 1.0f), &feeds[0]);
+  feeds[1] = feeds[0];
+  std::vector<OrtValue> large_fetches;
+  ASSERT_STATUS_OK(session_object.Run(RunOptions(), feed_names, feeds, output_names, &large_fetches));
+  EXPECT_EQ(large_fetches[0].Get<Tensor>().Shape(), TensorShape({max_batch_size + 1, 1}));
+  EXPECT_EQ(session_object.GetDynamicBatchingStats().num_requests, num_requests);
+}
+
 TEST(InferenceSessionTests, PreAllocateOutputVector) {
   SessionOptions so;
 
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <thread>
+#include <vector>
+
+#include "core/framework/node_latency_histograms.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(NodeLatencyHistogramsTest, Buckets) {
+  using H = NodeLatencyHistograms;
+  EXPECT_EQ(H::BucketIndex(0), 0u);
+  EXPECT_EQ(H::BucketIndex(255), 0u);
+  EXPECT_EQ(H::BucketIndex(256), 1u);
+  EXPECT_EQ(H::BucketIndex(319), 1u);
+  EXPECT_EQ(H::BucketIndex(320), 2u);
+  EXPECT_EQ(H::BucketIndex(511), 4u);
+  EXPECT_EQ(H::BucketIndex(512), 5u);
+  EXPECT_EQ(H::BucketIndex(uint64_t{1} << 36), H::kNumBuckets - 1);
+
+  // every value is below the upper bound of its bucket and at least the upper bound of the previous one
+  for (uint64_t value : {uint64_t{1}, uint64_t{300}, uint64_t{1000}, uint64_t{123456}, uint64_t{987654321}}) {
+    const size_t index = H::BucketIndex(value);
+    EXPECT_LT(value, H::BucketUpperBound(index));
+    if (index > 0) {
+      EXPECT_GE(value, H::BucketUpperBound(index - 1));
+    }
+  }
+  EXPECT_EQ(H::BucketUpperBound(H::kNumBuckets - 2), uint64_t{1} << 36);
+}
+
+TEST(NodeLatencyHistogramsTest, RecordAndMerge) {
+  NodeLatencyHistograms histograms(3);
+
+  // the threads write to several shards, which are merged on read
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&histograms]() {
+      for (int64_t i = 1; i <= 100; ++i) {
+        histograms.Record(1, i * 1000);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto snapshot = histograms.Get(1);
+  EXPECT_EQ(snapshot.count, 800u);
+  EXPECT_EQ(snapshot.total_ns, 8u * 5050u * 1000u);
+  EXPECT_EQ(snapshot.max_ns, 100000u);
+
+  // within the 25% error of the buckets
+  EXPECT_GE(snapshot.Percentile(0.5), 50000u);
+  EXPECT_LE(snapshot.Percentile(0.5), 62500u);
+  EXPECT_GE(snapshot.Percentile(0.99), 99000u);
+  EXPECT_EQ(snapshot.Percentile(1.0), 100000u);
+
+  EXPECT_EQ(histograms.Get(0).count, 0u);
+  EXPECT_EQ(histograms.Get(0).Percentile(0.5), 0u);
+  // out of range indices are ignored
+  histograms.Record(3, 1000);
+  EXPECT_EQ(histograms.Get(3).count, 0u);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
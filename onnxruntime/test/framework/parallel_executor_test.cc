@@ -1,9 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <sstream>
+
 #include "core/framework/data_types.h"
 #include "core/framework/op_kernel.h"
+#include "core/framework/session_state.h"
+#include "core/graph/model.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
 #include "test_utils.h"
 #include "core/session/inference_session.h"
 
@@ -145,5 +153,108 @@ TEST_P(ParallelExecutorThreadPoolTest, TestNullInterOpThreadPool) {
 
 INSTANTIATE_TEST_SUITE_P(ParallelExecutorThreadPoolTests, ParallelExecutorThreadPoolTest,
                          testing::Values(1, 0));
+
+// test that the status from TestOp is correctly returned when the nodes are executed in dataflow order
+TEST(ParallelExecutor, TestDataflowStatusPropagation) {
+  auto registry = std::make_shared<CustomRegistry>();
+  std::vector<OpSchema> schemas{TestOp::OpSchema()};
+  Status status;
+  ASSERT_TRUE((status = registry->RegisterOpSet(schemas, TestOp::OpDomain, 10, 11)).IsOK()) << status;
+  KernelCreateFn kernel_create_fn = [](FuncManager&, const OpKernelInfo& info, std::unique_ptr<OpKernel>& out) { out = std::make_unique<typename TestOp::OpKernelImpl>(info); return Status::OK(); };
+  auto kernel_def = TestOp::KernelDef();
+  ASSERT_TRUE((status = registry->RegisterCustomKernel(kernel_def, kernel_create_fn)).IsOK()) << status;
+
+  onnxruntime::SessionOptions so;
+  so.session_logid = "TestOp";
+  so.execution_mode = ExecutionMode::ORT_PARALLEL;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigUseDataflowExecutor, "1"));
+
+  for (int64_t action : {0, 1, 2}) {
+    OpTester tester{"TestOp", 10, TestOp::OpDomain};
+    tester.AddCustomOpRegistry(registry);
+
+    tester.AddInput<int64_t>("action", {1}, {action});
+    tester.AddOutput<int64_t>("action_out", {1}, {0});
+    if (action == 0) {
+      tester.Run(so, OpTester::ExpectResult::kExpectSuccess, {}, {kTensorrtExecutionProvider}, nullptr, nullptr);
+    } else {
+      tester.Run(so, OpTester::ExpectResult::kExpectFailure, action == 1 ? "Action was 1" : "Throwing as action was 2",
+                 {kTensorrtExecutionProvider}, nullptr, nullptr);
+    }
+  }
+}
+
+// Y = ((Relu(X) + X) + Relu(X) * X) + -Relu(X) + Relu(X), with several nodes ready at the same time.
+TEST(ParallelExecutor, TestDataflowExecution) {
+  onnxruntime::Model model("dataflow", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& r = graph.GetOrCreateNodeArg("r", &float_tensor);
+  auto& a = graph.GetOrCreateNodeArg("a", &float_tensor);
+  auto& m = graph.GetOrCreateNodeArg("m", &float_tensor);
+  auto& n = graph.GetOrCreateNodeArg("n", &float_tensor);
+  auto& s = graph.GetOrCreateNodeArg("s", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("relu", "Relu", "", {&x}, {&r});
+  graph.AddNode("add", "Add", "", {&r, &x}, {&a});
+  graph.AddNode("mul", "Mul", "", {&r, &x}, {&m});
+  graph.AddNode("neg", "Neg", "", {&r}, {&n});
+  graph.AddNode("add_2", "Add", "", {&a, &m}, {&s});
+  graph.AddNode("sum", "Sum", "", {&s, &n, &r}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  ASSERT_TRUE(model.ToProto().SerializeToString(&model_data));
+
+  SessionOptions so;
+  so.session_logid = "ParallelExecutor.TestDataflowExecution";
+  so.execution_mode = ExecutionMode::ORT_PARALLEL;
+  so.inter_op_param.thread_pool_size = 4;
+  so.graph_optimization_level = TransformerLevel::Default;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigUseDataflowExecutor, "1"));
+  InferenceSessionWrapper session_object{so, GetEnvironment()};
+  std::stringstream model_stream(model_data);
+  ASSERT_STATUS_OK(session_object.Load(model_stream));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  const auto* dataflow_plan = session_object.GetSessionState().GetDataflowPlan();
+  ASSERT_NE(dataflow_plan, nullptr);
+  ASSERT_EQ(dataflow_plan->nodes.size(), size_t(6));
+  ASSERT_EQ(dataflow_plan->entry_tasks.size(), size_t(1));
+  EXPECT_EQ(dataflow_plan->consumers.size(), size_t(8));
+
+  std::vector<int64_t> dims = {2, 3};
+  std::vector<float> values = {-3.0f, -1.5f, 0.0f, 0.5f, 2.0f, 4.0f};
+  std::vector<float> expected_values;
+  for (float v : values) {
+    const float relu = std::max(v, 0.0f);
+    expected_values.push_back(((relu + v) + relu * v) - relu + relu);
+  }
+
+  OrtValue ml_value_x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(OrtMemTypeDefault), dims, values, &ml_value_x);
+  NameMLValMap feeds{{"X", ml_value_x}};
+  std::vector<std::string> output_names{"Y"};
+
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  for (int i = 0; i < 20; ++i) {
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+    ASSERT_EQ(fetches.size(), size_t(1));
+    const auto& output = fetches[0].Get<Tensor>();
+    ASSERT_EQ(output.Shape(), TensorShape(dims));
+    for (size_t j = 0; j < expected_values.size(); ++j) {
+      EXPECT_FLOAT_EQ(output.Data<float>()[j], expected_values[j]);
+    }
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -0,0 +1,209 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    test_q4gemm.cpp
+
+Abstract:
+
+    Tests for MLAS int4 block quantization and GEMM with int4 block
+    quantized B.
+
+--*/
+
+#include "test_util.h"
+#include "mlas_q4.h"
+
+template <MLAS_BLK_QUANT_TYPE QType, bool Threaded>
+class MlasQ4GemmTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferA;
+  MatrixGuardBuffer<float> BufferB;
+  MatrixGuardBuffer<float> BufferUnpackedB;
+  MatrixGuardBuffer<uint8_t> BufferPackedB;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferC;
+  MatrixGuardBuffer<float> BufferCReference;
+  MatrixGuardBuffer<float> BufferCAbsSum;
+  MLAS_THREADPOOL* threadpool_;
+
+  void ReferenceQgemm(size_t M, size_t N, size_t K, size_t BatchSize,
+                      const float* A, const float* B, const float* Bias,
+                      float* C, float* CAbsSum) {
+    for (size_t batch = 0; batch < BatchSize; batch++) {
+      for (size_t m = 0; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
+          const float* a = A + (batch * M + m) * K;
+          double sum = (Bias == nullptr) ? 0.0 : Bias[n];
+          double abs_sum = (Bias == nullptr) ? 0.0 : std::abs(Bias[n]);
+          for (size_t k = 0; k < K; k++) {
+            const double product = double(a[k]) * double(B[k * N + n]);
+            sum += product;
+            abs_sum += std::abs(product);
+          }
+          C[(batch * M + m) * N + n] = float(sum);
+          CAbsSum[(batch * M + m) * N + n] = float(abs_sum);
+        }
+      }
+    }
+  }
+
+ public:
+  MlasQ4GemmTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("Q4Gemm") +
+                                          "QType" + std::to_string(static_cast<int>(QType)) +
+                                          (Threaded ? "_Threaded" : "_SingleThread");
+    return suite_name.c_str();
+  }
+
+  void TestPackUnpack(size_t N, size_t K) {
+    const size_t PackedBSize = MlasQ4GemmPackBSize(QType, N, K);
+    ASSERT_GT(PackedBSize, size_t(0));
+
+    float* B = BufferB.GetBuffer(K * N);
+    float* UnpackedB = BufferUnpackedB.GetBuffer(K * N, true);
+    uint8_t* PackedB = BufferPackedB.GetBuffer(PackedBSize);
+
+    std::default_random_engine generator(static_cast<unsigned>(N * 1009 + K));
+    std::uniform_real_distribution<float> distribution(-5.0f, 3.0f);
+    for (size_t i = 0; i < K * N; i++) {
+      B[i] = distribution(generator);
+    }
+
+    MlasQ4GemmPackB(QType, PackedB, B, N, K, N);
+    MlasQ4GemmUnPackB(QType, UnpackedB, PackedB, N, K, N);
+
+    //
+    // Every dequantized value must be within one quantization step of the
+    // original value, the step being at most 1/8 of the range of the block.
+    //
+
+    const size_t BlkLen = (QType == BlkQ4Sym64) ? 64 : (QType == BlkQ4Sym128) ? 128 : 32;
+    for (size_t n = 0; n < N; n++) {
+      for (size_t k = 0; k < K; k += BlkLen) {
+        const size_t CountK = std::min(K - k, BlkLen);
+        float Min = 0.0f;
+        float Max = 0.0f;
+        for (size_t kk = 0; kk < CountK; kk++) {
+          Min = std::min(Min, B[(k + kk) * N + n]);
+          Max = std::max(Max, B[(k + kk) * N + n]);
+        }
+        const float Tolerance = (Max - Min) / 8.0f + 1e-6f;
+        for (size_t kk = 0; kk < CountK; kk++) {
+          const size_t i = (k + kk) * N + n;
+          ASSERT_LE(std::abs(B[i] - UnpackedB[i]), Tolerance)
+              << "N=" << N << " K=" << K << " n=" << n << " k=" << k + kk;
+        }
+      }
+    }
+
+    //
+    // Dequantized values lie on the quantization grid, so quantizing them
+    // again must round trip, up to the rounding of the recomputed scale.
+    //
+
+    MlasQ4GemmPackB(QType, PackedB, UnpackedB, N, K, N);
+    MlasQ4GemmUnPackB(QType, B, PackedB, N, K, N);
+    for (size_t i = 0; i < K * N; i++) {
+      ASSERT_LE(std::abs(B[i] - UnpackedB[i]), std::abs(UnpackedB[i]) * 1e-5f + 1e-6f)
+          << "N=" << N << " K=" << K << " i=" << i;
+    }
+  }
+
+  void Test(size_t M, size_t N, size_t K, size_t BatchSize, bool withBias) {
+    const float* A = BufferA.GetBuffer(K * M * BatchSize);
+    const float* B = BufferB.GetBuffer(K * N);
+    const float* Bias = withBias ? BufferBias.GetBuffer(N) : nullptr;
+    float* UnpackedB = BufferUnpackedB.GetBuffer(K * N);
+
+    const size_t PackedBSize = MlasQ4GemmPackBSize(QType, N, K);
+    uint8_t* PackedB = BufferPackedB.GetBuffer(PackedBSize);
+    MlasQ4GemmPackB(QType, PackedB, B, N, K, N);
+    MlasQ4GemmUnPackB(QType, UnpackedB, PackedB, N, K, N);
+
+    float* C = BufferC.GetBuffer(N * M * BatchSize, true);
+    float* CReference = BufferCReference.GetBuffer(N * M * BatchSize, true);
+    float* CAbsSum = BufferCAbsSum.GetBuffer(N * M * BatchSize, true);
+
+    std::vector<MLAS_Q4_GEMM_DATA_PARAMS> params(BatchSize);
+    for (size_t i = 0; i < BatchSize; i++) {
+      params[i].A = A + M * K * i;
+      params[i].lda = K;
+      params[i].B = PackedB;
+      params[i].Bias = Bias;
+      params[i].C = C + M * N * i;
+      params[i].ldc = N;
+    }
+    MlasQ4GemmBatch(QType, M, N, K, BatchSize, params.data(), threadpool_);
+
+    ReferenceQgemm(M, N, K, BatchSize, A, UnpackedB, Bias, CReference, CAbsSum);
+
+    for (size_t i = 0; i < M * N * BatchSize; i++) {
+      const float Tolerance = CAbsSum[i] * 1e-5f + 1e-6f;
+      ASSERT_LE(std::abs(C[i] - CReference[i]), Tolerance)
+          << "@[" << i / N << "x" << i % N << "], "
+          << "Batch=" << BatchSize << " M=" << M << ", N=" << N << ", K=" << K;
+    }
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t n : {1, 3, 16, 33, 200}) {
+      for (size_t k : {1, 15, 16, 17, 31, 32, 33, 64, 100, 128, 129, 300}) {
+        TestPackUnpack(n, k);
+      }
+    }
+
+    for (size_t m : {1, 2, 5, 8, 9, 33, 150}) {
+      for (size_t n : {1, 3, 4, 7, 16, 33, 200}) {
+        for (size_t k : {1, 15, 17, 32, 33, 64, 127, 128, 129, 300}) {
+          Test(m, n, k, 1, false);
+          Test(m, n, k, 1, true);
+        }
+      }
+    }
+
+    Test(1, 4096, 4096, 1, true);
+    Test(3, 1000, 2047, 3, false);
+    Test(43, 500, 401, 2, true);
+  }
+};
+
+template <>
+MlasQ4GemmTest<BlkQ4Sym, false>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym, false>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Sym, true>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym, true>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Zp8, false>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Zp8, false>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Zp8, true>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Zp8, true>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Sym64, false>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym64, false>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Sym64, true>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym64, true>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Sym128, false>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym128, false>>::mlas_tester(nullptr);
+template <>
+MlasQ4GemmTest<BlkQ4Sym128, true>* MlasTestFixture<MlasQ4GemmTest<BlkQ4Sym128, true>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Zp8, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym64, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym128, false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym, true>>::RegisterShortExecute();
+      count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Zp8, true>>::RegisterShortExecute();
+      count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym64, true>>::RegisterShortExecute();
+      count += MlasDirectShortExecuteTests<MlasQ4GemmTest<BlkQ4Sym128, true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
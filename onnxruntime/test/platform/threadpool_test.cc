@@ -12,8 +12,12 @@
 
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <future>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -416,6 +420,175 @@ TEST(ThreadPoolTest, TestConcurrentParallelFor_4Thread_4Conc_1MTasks_dynamic_blo
   TestConcurrentParallelFor("TestConcurrentParallelFor_4Thread_4Conc_1MTasks_dynamic_block_base_128", 4, 4, 1000000, 128, true);
 }
 
+TEST(ThreadPoolTest, TestNumaPartitionedParallelFor) {
+  // Threads partitioned between two NUMA nodes, independently of the topology of the test machine.
+  onnxruntime::ThreadOptions thread_options;
+  thread_options.numa_nodes = {0, 0, 1, 1};
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), thread_options, nullptr, 4, true);
+  for (int num_tasks : {1, 2, 3, 50, 1000, 100000}) {
+    auto test_data = CreateTestData(num_tasks);
+    ThreadPool::TrySimpleParallelFor(tp.get(), num_tasks, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+    ThreadPool::TryParallelFor(tp.get(), num_tasks, 100.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+      for (std::ptrdiff_t i = first; i < last; i++) {
+        IncrementElement(*test_data, i);
+      }
+    });
+    ValidateTestData(*test_data, 2);
+  }
+}
+
+TEST(ThreadPoolTest, TestLoopPriorityScope) {
+  ASSERT_EQ(ThreadPool::CurrentLoopPriority(), ThreadPool::LoopPriority::kNormal);
+  {
+    ThreadPool::PriorityScope low(ThreadPool::LoopPriority::kLow);
+    ASSERT_EQ(ThreadPool::CurrentLoopPriority(), ThreadPool::LoopPriority::kLow);
+    {
+      ThreadPool::PriorityScope high(ThreadPool::LoopPriority::kHigh);
+      ASSERT_EQ(ThreadPool::CurrentLoopPriority(), ThreadPool::LoopPriority::kHigh);
+    }
+    ASSERT_EQ(ThreadPool::CurrentLoopPriority(), ThreadPool::LoopPriority::kLow);
+  }
+  ASSERT_EQ(ThreadPool::CurrentLoopPriority(), ThreadPool::LoopPriority::kNormal);
+
+  ThreadPool::LoopPriority priority;
+  ASSERT_TRUE(ThreadPool::ParseLoopPriority("high", priority).IsOK());
+  ASSERT_EQ(priority, ThreadPool::LoopPriority::kHigh);
+  ASSERT_FALSE(ThreadPool::ParseLoopPriority("urgent", priority).IsOK());
+}
+
+TEST(ThreadPoolTest, TestParseCostModel) {
+  ParallelForCostModel cost_model;
+  ASSERT_TRUE(ThreadPool::ParseCostModel("load_cycles_per_byte=0.5;startup_cycles=2000", cost_model).IsOK());
+  ASSERT_EQ(cost_model.load_cycles_per_byte, 0.5);
+  ASSERT_EQ(cost_model.startup_cycles, 2000);
+  ASSERT_EQ(cost_model.per_thread_cycles, ParallelForCostModel{}.per_thread_cycles);
+
+  // the text format round trips
+  ParallelForCostModel parsed;
+  ASSERT_TRUE(ThreadPool::ParseCostModel(ThreadPool::CostModelToString(cost_model), parsed).IsOK());
+  ASSERT_EQ(parsed.load_cycles_per_byte, cost_model.load_cycles_per_byte);
+  ASSERT_EQ(parsed.startup_cycles, cost_model.startup_cycles);
+
+  ASSERT_FALSE(ThreadPool::ParseCostModel("load_cycles_per_byte", cost_model).IsOK());
+  ASSERT_FALSE(ThreadPool::ParseCostModel("cycles=1", cost_model).IsOK());
+  ASSERT_FALSE(ThreadPool::ParseCostModel("per_thread_cycles=0", cost_model).IsOK());
+  ASSERT_FALSE(ThreadPool::ParseCostModel("startup_cycles=-1", cost_model).IsOK());
+  // a failed parse leaves the cost model unchanged
+  ASSERT_EQ(cost_model.load_cycles_per_byte, 0.5);
+}
+
+TEST(ThreadPoolTest, TestCalibratedCostModel) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  const ParallelForCostModel cost_model = ThreadPool::CalibrateCostModel(tp.get());
+  ASSERT_GT(cost_model.load_cycles_per_byte, 0);
+  ASSERT_GT(cost_model.store_cycles_per_byte, 0);
+  ASSERT_GT(cost_model.cycles_per_compute_cycle, 0);
+  ASSERT_GT(cost_model.per_thread_cycles, 0);
+  ASSERT_GT(cost_model.task_size_cycles, 0);
+  ASSERT_GE(cost_model.startup_cycles, 0);
+
+  // the loops still run every iteration exactly once
+  tp->SetCostModel(cost_model);
+  for (int num_tasks : {1, 2, 3, 50, 1000, 100000}) {
+    auto test_data = CreateTestData(num_tasks);
+    ThreadPool::TryParallelFor(tp.get(), num_tasks, TensorOpCost{4, 4, 1},
+                               [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                 for (std::ptrdiff_t i = first; i < last; i++) {
+                                   IncrementElement(*test_data, i);
+                                 }
+                               });
+    ValidateTestData(*test_data);
+  }
+}
+
+TEST(ThreadPoolTest, TestConcurrentParallelForWithPriorities) {
+  // Loops of different priority classes sharing a pool must still run each iteration exactly once,
+  // including when helper threads leave a loop that exceeds its share.
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  constexpr int num_tasks = 100000;
+  constexpr int num_loops = 20;
+  const ThreadPool::LoopPriority priorities[] = {ThreadPool::LoopPriority::kLow,
+                                                 ThreadPool::LoopPriority::kNormal,
+                                                 ThreadPool::LoopPriority::kHigh};
+  std::vector<std::unique_ptr<TestData>> td;
+  std::vector<std::thread> threads;
+  for (auto priority : priorities) {
+    td.push_back(CreateTestData(num_tasks));
+    threads.emplace_back([&tp, priority, &test_data = *td.back()]() {
+      ThreadPool::PriorityScope priority_scope(priority);
+      for (int i = 0; i < num_loops; i++) {
+        ThreadPool::TrySimpleParallelFor(tp.get(), num_tasks, [&](std::ptrdiff_t j) { IncrementElement(test_data, j); });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& test_data : td) {
+    ValidateTestData(*test_data, num_loops);
+  }
+}
+
+TEST(ThreadPoolTest, TestScheduleKeepsLoopPriority) {
+  // e.g. the nodes that an executor runs on the inter-op pool start their loops with the priority of the run
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 2, true);
+  std::promise<ThreadPool::LoopPriority> scheduled_priority;
+  {
+    ThreadPool::PriorityScope priority_scope(ThreadPool::LoopPriority::kLow);
+    ThreadPool::Schedule(tp.get(), [&scheduled_priority]() {
+      scheduled_priority.set_value(ThreadPool::CurrentLoopPriority());
+    });
+  }
+  ASSERT_EQ(scheduled_priority.get_future().get(), ThreadPool::LoopPriority::kLow);
+}
+
+TEST(ThreadPoolTest, TestLowPriorityLoopCappedByHighPriorityLoop) {
+  // 7 threads besides the caller, so a loop may use 8 threads. A low priority loop running at the same time as a
+  // high priority loop gets 8 * 1 / (1 + 16) threads, i.e. only the thread that started it.
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 8, true);
+  constexpr int num_blocks = 64;
+
+  // Runs a low priority loop of blocks that take 1ms each, returning the largest number of blocks running at once.
+  auto run_low_priority_loop = [&tp]() {
+    ThreadPool::PriorityScope priority_scope(ThreadPool::LoopPriority::kLow);
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    ThreadPool::TrySimpleParallelFor(tp.get(), num_blocks, [&](std::ptrdiff_t) {
+      const int now_running = running.fetch_add(1) + 1;
+      int seen = max_running.load();
+      while (now_running > seen && !max_running.compare_exchange_weak(seen, now_running)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      running.fetch_sub(1);
+    });
+    return max_running.load();
+  };
+
+  // a high priority loop of 2 blocks that stays active until the low priority loop completed
+  std::atomic<int> high_blocks_started{0};
+  std::atomic<bool> low_done{false};
+  std::thread high_thread([&]() {
+    ThreadPool::PriorityScope priority_scope(ThreadPool::LoopPriority::kHigh);
+    ThreadPool::TrySimpleParallelFor(tp.get(), 2, [&](std::ptrdiff_t) {
+      high_blocks_started.fetch_add(1);
+      while (!low_done.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  });
+  while (high_blocks_started.load() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  const int max_running_with_high = run_low_priority_loop();
+  low_done = true;
+  high_thread.join();
+  EXPECT_EQ(max_running_with_high, 1);
+
+  // on its own the low priority loop uses the other threads
+  EXPECT_GT(run_low_priority_loop(), 1);
+}
+
 TEST(ThreadPoolTest, TestBurstScheduling_0Tasks) {
   TestBurstScheduling("TestBurstScheduling_0Tasks", 0);
 }
@@ -411,6 +411,26 @@ TEST(MathOpTest, Add_Broadcast_2x1x4_1x3x1) {
 #endif
 }
 
+// Large enough for the output to be split between threads within the short spans of D elements.
+TEST(MathOpTest, Add_Broadcast_Bx1xSx1_1xHx1xD) {
+  constexpr int64_t B = 4, H = 8, S = 64, D = 47;
+  std::vector<float> a(B * S), b(H * D), c;
+  for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<float>(i) * 1000.0f;
+  for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<float>(i);
+  c.reserve(B * H * S * D);
+  for (int64_t bi = 0; bi < B; ++bi)
+    for (int64_t hi = 0; hi < H; ++hi)
+      for (int64_t si = 0; si < S; ++si)
+        for (int64_t di = 0; di < D; ++di)
+          c.push_back(a[bi * S + si] + b[hi * D + di]);
+
+  OpTester test("Add");
+  test.AddInput<float>("A", {B, 1, S, 1}, a);
+  test.AddInput<float>("B", {1, H, 1, D}, b);
+  test.AddOutput<float>("C", {B, H, S, D}, c);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 TEST(MathOpTest, Add_Broadcast_2x1x1_3x4) {
   OpTester test("Add");
 
@@ -1272,6 +1292,30 @@ TEST(MathOpTest, Sum_8_Test1) {
 #endif
 }
 
+// Large enough for the output of each broadcast of the variadic op to be split between the threads.
+TEST(MathOpTest, Sum_8_Broadcast_Parallel) {
+  constexpr int64_t B = 4, H = 8, S = 64, D = 47;
+  std::vector<float> a(B * S), b(H * D), c(H * S), sum;
+  for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<float>(i) * 1000.0f;
+  for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<float>(i);
+  for (size_t i = 0; i < c.size(); ++i) c[i] = static_cast<float>(i) * 0.5f;
+  sum.reserve(B * H * S * D);
+  for (int64_t bi = 0; bi < B; ++bi)
+    for (int64_t hi = 0; hi < H; ++hi)
+      for (int64_t si = 0; si < S; ++si)
+        for (int64_t di = 0; di < D; ++di)
+          sum.push_back(a[bi * S + si] + b[hi * D + di] + c[hi * S + si]);
+
+  OpTester test("Sum", 8);
+  test.AddInput<float>("data_0", {B, 1, S, 1}, a);
+  test.AddInput<float>("data_1", {1, H, 1, D}, b);
+  test.AddInput<float>("data_2", {1, H, S, 1}, c);
+  test.AddOutput<float>("sum", {B, H, S, D}, sum);
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 TEST(MathOpTest, Sum_8_Test1_double) {
   OpTester test("Sum", 8);
   test.AddInput<double>("data_0", {3}, {1.0, 2.0, 3.0});
@@ -1731,6 +1775,30 @@ TEST(MathOpTest, Max_8_2inputbroadcast) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});  //TensorRT: Input batch size is inconsistent
 }
 
+// Large enough for the output of each broadcast of the variadic op to be split between the threads.
+TEST(MathOpTest, Max_8_Broadcast_Parallel) {
+  constexpr int64_t B = 4, H = 8, S = 64, D = 47;
+  std::vector<float> a(B * S), b(H * D), c(H * S), max;
+  for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<float>((i * 7) % 101);
+  for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<float>((i * 13) % 103);
+  for (size_t i = 0; i < c.size(); ++i) c[i] = static_cast<float>((i * 17) % 107);
+  max.reserve(B * H * S * D);
+  for (int64_t bi = 0; bi < B; ++bi)
+    for (int64_t hi = 0; hi < H; ++hi)
+      for (int64_t si = 0; si < S; ++si)
+        for (int64_t di = 0; di < D; ++di)
+          max.push_back(std::max({a[bi * S + si], b[hi * D + di], c[hi * S + si]}));
+
+  OpTester test("Max", 8);
+  test.AddInput<float>("data_0", {B, 1, S, 1}, a);
+  test.AddInput<float>("data_1", {1, H, 1, D}, b);
+  test.AddInput<float>("data_2", {1, H, S, 1}, c);
+  test.AddOutput<float>("max", {B, H, S, D}, max);
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 TEST(MathOpTest, Max_12_Float) {
   OpTester test("Max", 12);
   test.AddInput<float>("data_0", {1, 3},
@@ -292,6 +292,45 @@ TEST(MathOpTest, MatMul_bfloat16) {
 }
 #endif
 
+// The shapes are large enough for every candidate of the CPU MatMul TunableOp to be supported, so tuning runs
+// them all and the fastest one computes the output.
+TEST(MathOpTest, MatMulFloatTypeTunableOp) {
+  constexpr int64_t batch = 3, M = 130, N = 24, K = 20;
+  RandomValueGenerator random{};
+  std::vector<float> a_vals = random.Uniform<float>(std::vector<int64_t>{batch, M, K}, -1.0f, 1.0f);
+  std::vector<float> b_vals = random.Uniform<float>(std::vector<int64_t>{K, N}, -1.0f, 1.0f);
+
+  std::vector<float> expected_vals(batch * M * N);
+  for (int64_t m = 0; m < batch * M; m++) {
+    for (int64_t n = 0; n < N; n++) {
+      double sum = 0.0;
+      for (int64_t k = 0; k < K; k++) {
+        sum += double(a_vals[m * K + k]) * double(b_vals[k * N + n]);
+      }
+      expected_vals[m * N + n] = static_cast<float>(sum);
+    }
+  }
+
+  for (bool is_b_constant : {false, true}) {
+    SCOPED_TRACE(MakeString("is_b_constant: ", is_b_constant));
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    auto* tuning_ctx = execution_providers.back()->GetTuningContext();
+    if (tuning_ctx == nullptr) {
+      GTEST_SKIP() << "TunableOp is not supported by the CPU EP in this build";
+    }
+    tuning_ctx->EnableTunableOp();
+
+    OpTester test("MatMul", 13);
+    test.AddInput<float>("A", {batch, M, K}, a_vals);
+    test.AddInput<float>("B", {K, N}, b_vals, is_b_constant);
+    test.AddOutput<float>("Y", {batch, M, N}, expected_vals);
+    test.SetOutputAbsErr("Y", 0.0001f);
+    test.ConfigEps(std::move(execution_providers))
+        .RunWithConfig();
+  }
+}
+
 #ifndef ENABLE_TRAINING
 // Prepacking is disabled in full training build so no need to test the feature in a training build.
 TEST(MathOpTest, MatMulSharedPrepackedWeights) {
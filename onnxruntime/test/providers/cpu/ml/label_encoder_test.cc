@@ -189,5 +189,29 @@ TEST(LabelEncoder, Int64ToInt64Opset2) {
   test.Run();
 }
 
+TEST(LabelEncoder, StringToInt64Opset2LargeInput) {
+  // enough elements to be looked up in parallel
+  const std::vector<std::string> keys{"AA", "BB", "DD"};
+  const std::vector<std::int64_t> values{9, 1, 4};
+
+  std::vector<std::string> input;
+  std::vector<std::int64_t> output;
+  for (int i = 0; i < 100000; ++i) {
+    input.push_back(i % 4 == 3 ? "CC" : keys[i % 4]);
+    output.push_back(i % 4 == 3 ? 5566 : values[i % 4]);
+  }
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  test.AddAttribute("keys_strings", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute("default_int64", (std::int64_t)5566);
+
+  test.AddInput<std::string>("X", {static_cast<int64_t>(input.size())}, input);
+  test.AddOutput<std::int64_t>("Y", {static_cast<int64_t>(output.size())}, output);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -760,5 +760,97 @@ TEST(MLOpTest, TreeRegressorTrueNodeBeforeNode) {
   test.Run();
 }
 
+
+// Complete trees evaluated on batches of rows, the expected output is computed by walking every tree
+// for every row. The number of rows covers partial blocks and the different parallelization sections.
+static void GenDeepTreesAndRunTest(const std::string& mode, bool missing_tracks, int64_t n_obs) {
+  constexpr int64_t n_trees = 3;
+  constexpr int64_t depth = 6;
+  constexpr int64_t n_features = 4;
+  constexpr int64_t n_nodes_per_tree = (int64_t(1) << (depth + 1)) - 1;
+  constexpr int64_t first_leaf = (int64_t(1) << depth) - 1;
+
+  std::vector<int64_t> nodes_treeids, nodes_nodeids, nodes_featureids, nodes_truenodeids, nodes_falsenodeids;
+  std::vector<int64_t> nodes_missing_value_tracks_true;
+  std::vector<float> nodes_values;
+  std::vector<std::string> nodes_modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_ids;
+  std::vector<float> target_weights;
+  for (int64_t t = 0; t < n_trees; ++t) {
+    for (int64_t k = 0; k < n_nodes_per_tree; ++k) {
+      const bool is_leaf = k >= first_leaf;
+      nodes_treeids.push_back(t);
+      nodes_nodeids.push_back(k);
+      nodes_featureids.push_back(is_leaf ? 0 : (k + t) % n_features);
+      nodes_truenodeids.push_back(is_leaf ? 0 : 2 * k + 1);
+      nodes_falsenodeids.push_back(is_leaf ? 0 : 2 * k + 2);
+      nodes_missing_value_tracks_true.push_back(missing_tracks && !is_leaf ? k % 2 : 0);
+      nodes_values.push_back(is_leaf ? 0.f : static_cast<float>((k * 7 + t * 3) % 11) - 5.f);
+      nodes_modes.push_back(is_leaf ? "LEAF" : mode);
+      if (is_leaf) {
+        target_treeids.push_back(t);
+        target_nodeids.push_back(k);
+        target_ids.push_back(0);
+        target_weights.push_back(static_cast<float>(k - first_leaf) * 0.5f + static_cast<float>(t));
+      }
+    }
+  }
+
+  std::vector<float> X(static_cast<size_t>(n_obs * n_features));
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = (i % 13 == 5) ? std::numeric_limits<float>::quiet_NaN()
+                         : static_cast<float>(static_cast<int64_t>(i * 37 % 23) - 11) * 0.5f;
+  }
+
+  auto compare = [&mode](float val, float threshold) {
+    if (mode == "BRANCH_LEQ") return val <= threshold;
+    if (mode == "BRANCH_LT") return val < threshold;
+    if (mode == "BRANCH_GTE") return val >= threshold;
+    if (mode == "BRANCH_GT") return val > threshold;
+    if (mode == "BRANCH_EQ") return val == threshold;
+    return val != threshold;
+  };
+  std::vector<float> Y(static_cast<size_t>(n_obs), 0.f);
+  for (int64_t i = 0; i < n_obs; ++i) {
+    for (int64_t t = 0; t < n_trees; ++t) {
+      int64_t k = 0;
+      while (k < first_leaf) {
+        const size_t n = static_cast<size_t>(t * n_nodes_per_tree + k);
+        const float val = X[static_cast<size_t>(i * n_features + nodes_featureids[n])];
+        const bool cond = compare(val, nodes_values[n]) || (nodes_missing_value_tracks_true[n] && std::isnan(val));
+        k = cond ? nodes_truenodeids[n] : nodes_falsenodeids[n];
+      }
+      Y[static_cast<size_t>(i)] += static_cast<float>(k - first_leaf) * 0.5f + static_cast<float>(t);
+    }
+  }
+
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("nodes_missing_value_tracks_true", nodes_missing_value_tracks_true);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", (int64_t)1);
+  test.AddInput<float>("X", {n_obs, n_features}, X);
+  test.AddOutput<float>("Y", {n_obs, 1}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorDeepTreesBatch) {
+  for (int64_t n_obs : {2, 17, 45, 130}) {
+    GenDeepTreesAndRunTest("BRANCH_LEQ", false, n_obs);
+    GenDeepTreesAndRunTest("BRANCH_LT", true, n_obs);
+    GenDeepTreesAndRunTest("BRANCH_GT", true, n_obs);
+    GenDeepTreesAndRunTest("BRANCH_NEQ", false, n_obs);
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -690,6 +690,36 @@ TEST(TfIdfVectorizerTest, String_TFIDFWeights_onlyBigrams_Skip5_2rows) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+TEST(TfIdfVectorizerTest, Int64_TF_UniAndBigrams_Skip1_LongRow) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  // s=1, Min=1, Max=2, weights empty, int64
+  InitTestAttr(test, "TF", 1, 2, 1,
+               {0, 2},
+               {0, 1, 2, 3},  // 4 output indexes
+               {},
+               {1, 2,        // 1-grams
+                1, 2, 2, 1},  // bi-grams
+               {});
+
+  // A single row long enough to be counted in 4 blocks by a thread pool of 4 threads
+  constexpr int64_t repeats = 2000;
+  std::vector<int64_t> input;
+  for (int64_t i = 0; i < repeats; ++i) {
+    input.insert(input.end(), {1, 2, 3});
+  }
+  test.AddInput<int64_t>("T", {static_cast<int64_t>(input.size())}, input);
+
+  // (1, 2) is found without skips, (2, 1) only with a skip over 3 and not at the end of the row
+  std::vector<float> output = {static_cast<float>(repeats), static_cast<float>(repeats),
+                               static_cast<float>(repeats), static_cast<float>(repeats - 1)};
+  test.AddOutput<float>("Y", {4}, output);
+
+  // the number of blocks depends on the degree of parallelism, which must not be the one of a single core machine
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess);
+}
+
 // This test runs the inference 100 times to test the improvement
 // It enables profiling while running inference multiple times.
 // So we can manually inspect the profiling output
@@ -383,5 +383,46 @@ TEST(NonMaxSuppressionOpTest, WithIOUThresholdOpset11) {
   test.Run();
 }
 
+TEST(NonMaxSuppressionOpTest, ManyClassesWithSuppressedTopScores) {
+  // The 70 boxes with the top scores overlap each other, so the classes must look past the first sorted candidates.
+  constexpr int64_t num_batches = 2;
+  constexpr int64_t num_classes = 8;
+  constexpr int64_t num_boxes = 100;
+  std::vector<float> boxes;
+  std::vector<float> box_scores;
+  for (int64_t i = 0; i < num_boxes; ++i) {
+    if (i < 70) {
+      boxes.insert(boxes.end(), {0.0f, 0.0f, 1.0f, 1.0f});
+      box_scores.push_back(0.9f - static_cast<float>(i) * 0.001f);
+    } else {
+      const float y = 10.0f * static_cast<float>(i);
+      boxes.insert(boxes.end(), {y, 0.0f, y + 1.0f, 1.0f});
+      box_scores.push_back(0.5f - static_cast<float>(i - 70) * 0.001f);
+    }
+  }
+
+  std::vector<float> all_boxes;
+  std::vector<float> scores;
+  std::vector<int64_t> selected_indices;
+  for (int64_t batch_index = 0; batch_index < num_batches; ++batch_index) {
+    all_boxes.insert(all_boxes.end(), boxes.begin(), boxes.end());
+    for (int64_t class_index = 0; class_index < num_classes; ++class_index) {
+      scores.insert(scores.end(), box_scores.begin(), box_scores.end());
+      for (int64_t box_index : {0, 70, 71}) {
+        selected_indices.insert(selected_indices.end(), {batch_index, class_index, box_index});
+      }
+    }
+  }
+
+  OpTester test("NonMaxSuppression", 11, kOnnxDomain);
+  test.AddInput<float>("boxes", {num_batches, num_boxes, 4}, all_boxes);
+  test.AddInput<float>("scores", {num_batches, num_classes, num_boxes}, scores);
+  test.AddInput<int64_t>("max_output_boxes_per_class", {}, {3L});
+  test.AddInput<float>("iou_threshold", {}, {0.5f});
+  test.AddInput<float>("score_threshold", {}, {0.0f});
+  test.AddOutput<int64_t>("selected_indices", {num_batches * num_classes * 3, 3}, selected_indices);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
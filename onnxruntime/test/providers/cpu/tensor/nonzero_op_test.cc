@@ -99,5 +99,24 @@ TEST(NonZeroOpTest, EmptyInput) {
   test.Run();
 }
 
+TEST(NonZeroOpTest, LargeInput) {
+  // enough elements to be scanned in several blocks
+  constexpr int64_t rows = 3, cols = 10000;
+  std::vector<int32_t> X(rows * cols, 0);
+  std::vector<int64_t> Y_rows, Y_cols;
+  for (int64_t i = 0; i < rows * cols; i += 7) {
+    X[static_cast<size_t>(i)] = 1;
+    Y_rows.push_back(i / cols);
+    Y_cols.push_back(i % cols);
+  }
+  std::vector<int64_t> Y = Y_rows;
+  Y.insert(Y.end(), Y_cols.begin(), Y_cols.end());
+
+  OpTester test{kOpName, kOpVersion};
+  test.AddInput<int32_t>("X", {rows, cols}, X);
+  test.AddOutput<int64_t>("Y", {2, static_cast<int64_t>(Y_rows.size())}, Y);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
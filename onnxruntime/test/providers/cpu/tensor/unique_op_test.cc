@@ -118,6 +118,36 @@ TEST(Unique, Flatten_Sorted_String) {
                              inverse_indices_dims, inverse_indices, counts_dims, counts);
 }
 
+TEST(Unique, Flatten_LargeInput) {
+  // enough elements to be deduplicated in several partitions
+  constexpr int64_t num_unique = 1000;
+  constexpr int64_t repeats = 50;
+  const std::vector<int64_t> X_dims{repeats, num_unique};
+  std::vector<int64_t> X;
+  for (int64_t i = 0; i < repeats * num_unique; ++i) {
+    X.push_back(num_unique - 1 - i % num_unique);
+  }
+  const int64_t* axis = nullptr;
+  const std::vector<int64_t> Y_dims{num_unique};
+  const std::vector<int64_t> counts(num_unique, repeats);
+
+  for (bool sorted : {false, true}) {
+    std::vector<int64_t> Y;
+    std::vector<int64_t> indices;
+    for (int64_t i = 0; i < num_unique; ++i) {
+      Y.push_back(sorted ? i : num_unique - 1 - i);
+      indices.push_back(sorted ? num_unique - 1 - i : i);
+    }
+    std::vector<int64_t> inverse_indices;
+    for (int64_t i = 0; i < repeats * num_unique; ++i) {
+      inverse_indices.push_back(sorted ? num_unique - 1 - i % num_unique : i % num_unique);
+    }
+
+    RunUniqueTest<int64_t>(X_dims, X, axis, sorted, Y_dims, Y, Y_dims, indices,
+                           {repeats * num_unique}, inverse_indices, Y_dims, counts);
+  }
+}
+
 TEST(Unique, NoOptionalOutput) {
   const std::vector<int64_t> X_dims{2, 4};
   const std::vector<int8_t> X{1, 4, -1, 2, 2, 0, -1, 4};
@@ -121,6 +121,32 @@ TEST(WhereOpTest, Broadcast) {
   WhereBroadcastTest<std::string>("true", "false");
 }
 
+// Large enough for the selections and the merge to be split between the threads.
+TEST(WhereOpTest, BroadcastParallel) {
+  constexpr int64_t B = 4, H = 8, S = 64, D = 47;
+  // std::vector<bool> doesn't store bools
+  auto condition = std::make_unique<bool[]>(B * S);
+  std::vector<float> X(H * D), output;
+  for (int64_t i = 0; i < B * S; ++i) condition[i] = i % 3 != 0;
+  for (size_t i = 0; i < X.size(); ++i) X[i] = static_cast<float>(i);
+  const float y = -1.0f;
+  output.reserve(B * H * S * D);
+  for (int64_t bi = 0; bi < B; ++bi)
+    for (int64_t hi = 0; hi < H; ++hi)
+      for (int64_t si = 0; si < S; ++si)
+        for (int64_t di = 0; di < D; ++di)
+          output.push_back(condition[bi * S + si] ? X[hi * D + di] : y);
+
+  OpTester test{kOpName, kOpVersion};
+  test.AddInput<bool>("condition", {B, 1, S, 1}, condition.get(), B * S);
+  test.AddInput<float>("X", {1, H, 1, D}, X);
+  test.AddInput<float>("Y", {1}, {y});
+  test.AddOutput<float>("output", {B, H, S, D}, output);
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so);
+}
+
 TEST(WhereOpTest, BroadcastDimWithZero) {
   // test where broadcast is possible, and dim of 0 should be selected
   OpTester test{kOpName, kOpVersion};
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <algorithm>
 #include <thread>
 
@@ -1563,6 +1564,140 @@ TEST(CApiTest, get_allocator_cuda) {
 }
 #endif
 
+namespace {
+struct RunAsyncState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int num_completed = 0;
+  int num_failed = 0;
+};
+
+void ORT_API_CALL RunAsyncCallback(void* user_data, OrtValue** outputs, size_t num_outputs, OrtStatus* status) {
+  auto* state = static_cast<RunAsyncState*>(user_data);
+  const bool failed = status != nullptr || num_outputs != 1 || outputs[0] == nullptr;
+  Ort::GetApi().ReleaseStatus(status);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  ++state->num_completed;
+  state->num_failed += failed ? 1 : 0;
+  state->cv.notify_all();
+}
+}  // namespace
+
+TEST(CApiTest, run_async) {
+  Ort::SessionOptions session_options;
+  session_options.SetIntraOpNumThreads(2);
+  Ort::Session session(*ort_env, MODEL_URI, session_options);
+
+  Ort::MemoryInfo info_cpu = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemTypeDefault);
+  const std::array<int64_t, 2> x_shape = {3, 2};
+  std::array<float, 3 * 2> x_values = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  const std::array<float, 3 * 2> expected_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Y"};
+
+  constexpr int num_runs = 16;
+  RunAsyncState state;
+  Ort::RunOptions run_options;
+  std::vector<Ort::Value> outputs;
+  for (int i = 0; i < num_runs; ++i) {
+    outputs.emplace_back(nullptr);
+  }
+  for (int i = 0; i < num_runs; ++i) {
+    // the input can be released as soon as RunAsync returns
+    Ort::Value x = Ort::Value::CreateTensor(info_cpu, x_values.data(), x_values.size(), x_shape.data(), x_shape.size());
+    session.RunAsync(run_options, input_names, &x, 1, output_names, &outputs[i], 1, RunAsyncCallback, &state);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&state]() { return state.num_completed == num_runs; });
+  }
+  ASSERT_EQ(state.num_failed, 0);
+  for (const auto& y : outputs) {
+    ASSERT_TRUE(y.IsTensor());
+    const float* values = y.GetTensorData<float>();
+    ASSERT_TRUE(std::equal(values, values + expected_y.size(), std::begin(expected_y)));
+  }
+
+  // without a thread pool the run would block the caller
+  Ort::SessionOptions single_thread_options;
+  single_thread_options.SetIntraOpNumThreads(1);
+  Ort::Session single_thread_session(*ort_env, MODEL_URI, single_thread_options);
+  Ort::Value x = Ort::Value::CreateTensor(info_cpu, x_values.data(), x_values.size(), x_shape.data(), x_shape.size());
+  Ort::Value y{nullptr};
+  EXPECT_THROW(single_thread_session.RunAsync(run_options, input_names, &x, 1, output_names, &y, 1, RunAsyncCallback,
+                                              &state),
+               Ort::Exception);
+}
+
+namespace {
+struct ReleaseSessionState {
+  std::unique_ptr<Ort::Session> session;
+  std::vector<Ort::Value> outputs;
+  RunAsyncState run_state;
+};
+
+void ORT_API_CALL ReleaseSessionCallback(void* user_data, OrtValue** outputs, size_t num_outputs,
+                                         OrtStatus* status) {
+  auto* state = static_cast<ReleaseSessionState*>(user_data);
+  // runs on a worker of the session's thread pool, which the session owns
+  state->session.reset();
+  RunAsyncCallback(&state->run_state, outputs, num_outputs, status);
+}
+}  // namespace
+
+TEST(CApiTest, run_async_release_session_in_callback) {
+  Ort::SessionOptions session_options;
+  session_options.SetIntraOpNumThreads(2);
+  ReleaseSessionState state;
+  state.session = std::make_unique<Ort::Session>(*ort_env, MODEL_URI, session_options);
+  state.outputs.emplace_back(nullptr);
+
+  Ort::MemoryInfo info_cpu = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemTypeDefault);
+  const std::array<int64_t, 2> x_shape = {3, 2};
+  std::array<float, 3 * 2> x_values = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Y"};
+  Ort::RunOptions run_options;
+  Ort::Value x = Ort::Value::CreateTensor(info_cpu, x_values.data(), x_values.size(), x_shape.data(), x_shape.size());
+  state.session->RunAsync(run_options, input_names, &x, 1, output_names, state.outputs.data(), 1,
+                          ReleaseSessionCallback, &state);
+
+  {
+    std::unique_lock<std::mutex> lock(state.run_state.mutex);
+    state.run_state.cv.wait(lock, [&state]() { return state.run_state.num_completed == 1; });
+  }
+  ASSERT_EQ(state.run_state.num_failed, 0);
+  ASSERT_EQ(state.session, nullptr);
+  // the outputs outlive the session
+  ASSERT_TRUE(state.outputs[0].IsTensor());
+  const float* values = state.outputs[0].GetTensorData<float>();
+  EXPECT_EQ(values[5], 36.0f);
+}
+
+TEST(CApiTest, node_latency_stats) {
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, MODEL_URI, session_options);
+  EXPECT_TRUE(session.GetNodeLatencyStats().empty());
+
+  Ort::MemoryInfo info_cpu = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemTypeDefault);
+  const std::array<int64_t, 2> x_shape = {3, 2};
+  std::array<float, 3 * 2> x_values = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  Ort::Value x = Ort::Value::CreateTensor(info_cpu, x_values.data(), x_values.size(), x_shape.data(), x_shape.size());
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Y"};
+  for (int i = 0; i < 3; ++i) {
+    session.Run(Ort::RunOptions{}, input_names, &x, 1, output_names, 1);
+  }
+
+  const auto stats = session.GetNodeLatencyStats();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_STREQ(stats[0].op_type, "Mul");
+  EXPECT_EQ(stats[0].count, 3u);
+  EXPECT_LE(stats[0].p50_ns, stats[0].p99_ns);
+  EXPECT_LE(stats[0].p99_ns, stats[0].max_ns);
+}
+
 TEST(CApiTest, io_binding) {
   Ort::SessionOptions session_options;
   Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CPU(session_options, 1));